@@ -11,6 +11,7 @@
 #include <mbgl/annotation/annotation.hpp>
 #include <mbgl/style/types.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <functional>
@@ -25,6 +26,7 @@ class MapData;
 class MapContext;
 class SpriteImage;
 class Transform;
+class TransformState;
 class PointAnnotation;
 class ShapeAnnotation;
 struct CameraOptions;
@@ -38,10 +40,13 @@ class Map : private util::noncopyable {
     friend class View;
 
 public:
+    // Tiles are parsed on `workerThreadCount` threads per map; zero uses one thread per hardware
+    // thread.
     explicit Map(View&, FileSource&,
                  MapMode mapMode = MapMode::Continuous,
                  GLContextMode contextMode = GLContextMode::Unique,
-                 ConstrainMode constrainMode = ConstrainMode::HeightOnly);
+                 ConstrainMode constrainMode = ConstrainMode::HeightOnly,
+                 std::size_t workerThreadCount = 0);
     ~Map();
 
     // Pauses the render thread. The render thread will stop running but will not be terminated and will not lose state until resumed.
@@ -192,6 +197,9 @@ private:
     const std::unique_ptr<util::Thread<MapContext>> context;
     MapData* data;
 
+    // The camera path of the animation the map context currently prefetches tiles for.
+    std::shared_ptr<const std::vector<TransformState>> prefetchPath;
+
     enum class RenderState {
         never,
         partial,
@@ -2,6 +2,7 @@
 #define MBGL_STORAGE_DEFAULT_FILE_SOURCE
 
 #include <mbgl/storage/file_source.hpp>
+#include <mbgl/storage/offline.hpp>
 
 namespace mbgl {
 
@@ -15,9 +16,18 @@ public:
 
     void setMaximumCacheSize(uint64_t size);
     void setMaximumCacheEntrySize(uint64_t size);
+    void setMaximumMemoryCacheSize(uint64_t size);
+
+    void setMaximumConcurrentRequests(uint32_t);
+    void setMaximumConcurrentRequestsPerHost(uint32_t);
 
     std::unique_ptr<FileRequest> request(const Resource&, Callback) override;
 
+    // Downloads all resources needed to display the region into the cache and keeps them from
+    // being pruned. The download runs until it completes or the returned object is released.
+    std::unique_ptr<OfflineDownload> downloadOfflineRegion(const OfflineRegionDefinition&,
+                                                           std::unique_ptr<OfflineRegionObserver>);
+
 private:
     class Impl;
     const std::unique_ptr<Impl> impl;
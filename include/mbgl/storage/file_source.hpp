@@ -14,6 +14,11 @@ namespace mbgl {
 class FileRequest : private util::noncopyable {
 public:
     virtual ~FileRequest() = default;
+
+    // Hints how urgently this request is needed compared to other requests of the same kind;
+    // lower values are more urgent. File sources that queue requests may use this to reorder
+    // requests that haven't started yet.
+    virtual void setPriority(double) {}
 };
 
 class FileSource : private util::noncopyable {
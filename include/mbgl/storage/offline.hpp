@@ -0,0 +1,93 @@
+#ifndef MBGL_STORAGE_OFFLINE
+#define MBGL_STORAGE_OFFLINE
+
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/geo.hpp>
+#include <mbgl/util/noncopyable.hpp>
+
+#include <memory>
+#include <string>
+
+namespace mbgl {
+
+class FileSource;
+class SQLiteCache;
+
+// The area, zoom range and pixel ratio for which all resources of a style are downloaded.
+class OfflineRegionDefinition {
+public:
+    OfflineRegionDefinition(const std::string& styleURL_,
+                            const LatLngBounds& bounds_,
+                            double minZoom_,
+                            double maxZoom_,
+                            float pixelRatio_)
+        : styleURL(styleURL_),
+          bounds(bounds_),
+          minZoom(minZoom_),
+          maxZoom(maxZoom_),
+          pixelRatio(pixelRatio_) {
+    }
+
+    std::string styleURL;
+    LatLngBounds bounds;
+    double minZoom;
+    double maxZoom;
+    float pixelRatio;
+};
+
+class OfflineRegionStatus {
+public:
+    // The number and total size of the resources that have been downloaded so far.
+    uint64_t completedResourceCount = 0;
+    uint64_t completedResourceSize = 0;
+
+    // The number of resources that failed with an error that is not retried, like a 403. They are
+    // skipped so that the rest of the region still downloads.
+    uint64_t failedResourceCount = 0;
+
+    // The number of resources known to be required so far. This is only an estimate until all
+    // sources of the style have been resolved, since it may grow as more resources are found.
+    uint64_t requiredResourceCount = 0;
+    bool requiredResourceCountIsPrecise = false;
+
+    bool complete() const {
+        return requiredResourceCountIsPrecise &&
+            completedResourceCount + failedResourceCount == requiredResourceCount;
+    }
+};
+
+class OfflineRegionObserver {
+public:
+    virtual ~OfflineRegionObserver() = default;
+
+    // Called whenever a resource has been downloaded or has failed for good.
+    virtual void statusChanged(OfflineRegionStatus) {}
+
+    // Called when a resource failed to download. Server and connection errors are retried
+    // automatically; resources with other errors are counted as failed.
+    virtual void responseError(Response::Error) {}
+};
+
+// Downloads all resources of an offline region into the cache and pins them there, so that they
+// are not pruned. Resources that are already in the cache are not downloaded again, so starting a
+// new download for the same region resumes an interrupted one. Destroying this object stops the
+// download. The access token is needed to find the cache entries of mapbox:// resources.
+class OfflineDownload : private util::noncopyable {
+public:
+    OfflineDownload(const OfflineRegionDefinition&,
+                    FileSource&,
+                    SQLiteCache*,
+                    const std::string& accessToken,
+                    std::unique_ptr<OfflineRegionObserver>);
+    ~OfflineDownload();
+
+    OfflineRegionStatus getStatus() const;
+
+private:
+    class Impl;
+    const std::unique_ptr<Impl> impl;
+};
+
+} // namespace mbgl
+
+#endif
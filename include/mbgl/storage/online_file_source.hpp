@@ -19,6 +19,12 @@ public:
     void setAccessToken(const std::string& t) { accessToken = t; }
     std::string getAccessToken() const { return accessToken; }
 
+    // Limits the number of network transfers that run at the same time, in total and per host.
+    // Requests beyond these limits are queued and started in order of priority: style and
+    // source first, then sprites and glyphs, then tiles. A limit of 0 means unlimited.
+    void setMaximumConcurrentRequests(uint32_t);
+    void setMaximumConcurrentRequestsPerHost(uint32_t);
+
     std::unique_ptr<FileRequest> request(const Resource&, Callback) override;
 
 private:
@@ -26,6 +32,7 @@ private:
     friend class OnlineFileRequestImpl;
 
     void cancel(FileRequest*);
+    void setPriority(FileRequest*, double);
 
     class Impl;
     const std::unique_ptr<util::Thread<Impl>> thread;
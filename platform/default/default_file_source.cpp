@@ -1,5 +1,6 @@
 #include <mbgl/storage/default_file_source.hpp>
 #include <mbgl/storage/asset_file_source.hpp>
+#include <mbgl/storage/mbtiles_file_source.hpp>
 #include <mbgl/storage/online_file_source.hpp>
 #include <mbgl/storage/sqlite_cache.hpp>
 
@@ -10,10 +11,16 @@ namespace {
 
 const std::string assetProtocol = "asset://";
 
+const std::string mbtilesProtocol = "mbtiles://";
+
 bool isAssetURL(const std::string& url) {
     return std::equal(assetProtocol.begin(), assetProtocol.end(), url.begin());
 }
 
+bool isMBTilesURL(const std::string& url) {
+    return url.compare(0, mbtilesProtocol.size(), mbtilesProtocol) == 0;
+}
+
 } // namespace
 
 namespace mbgl {
@@ -27,6 +34,7 @@ public:
     }
 
     AssetFileSource assetFileSource;
+    MBTilesFileSource mbtilesFileSource;
     std::shared_ptr<SQLiteCache> cache;
     OnlineFileSource onlineFileSource;
 };
@@ -53,12 +61,31 @@ void DefaultFileSource::setMaximumCacheEntrySize(uint64_t size) {
     impl->cache->setMaximumCacheEntrySize(size);
 }
 
+void DefaultFileSource::setMaximumMemoryCacheSize(uint64_t size) {
+    impl->cache->setMaximumMemoryCacheSize(size);
+}
+
+void DefaultFileSource::setMaximumConcurrentRequests(uint32_t count) {
+    impl->onlineFileSource.setMaximumConcurrentRequests(count);
+}
+
+void DefaultFileSource::setMaximumConcurrentRequestsPerHost(uint32_t count) {
+    impl->onlineFileSource.setMaximumConcurrentRequestsPerHost(count);
+}
+
 std::unique_ptr<FileRequest> DefaultFileSource::request(const Resource& resource, Callback callback) {
     if (isAssetURL(resource.url)) {
         return impl->assetFileSource.request(resource, callback);
+    } else if (isMBTilesURL(resource.url)) {
+        return impl->mbtilesFileSource.request(resource, callback);
     } else {
         return impl->onlineFileSource.request(resource, callback);
     }
 }
 
+std::unique_ptr<OfflineDownload> DefaultFileSource::downloadOfflineRegion(const OfflineRegionDefinition& definition,
+                                                                          std::unique_ptr<OfflineRegionObserver> observer) {
+    return std::make_unique<OfflineDownload>(definition, *this, impl->cache.get(), getAccessToken(), std::move(observer));
+}
+
 } // namespace mbgl
@@ -0,0 +1,237 @@
+#include <mbgl/storage/mbtiles_file_source.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/compression.hpp>
+#include <mbgl/util/string.hpp>
+#include <mbgl/util/thread.hpp>
+#include <mbgl/util/url.hpp>
+
+#include "sqlite3.hpp"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+const std::string mbtilesProtocol = "mbtiles://";
+
+// Appended to the URL of an MBTiles file to form the tile URL template.
+const std::string tileURLSuffix = "/{z}/{x}/{y}";
+
+// Lets SQLite read the file through a memory map instead of read() calls, on platforms where
+// SQLite supports it. Larger files are partially mapped.
+const uint64_t kMaximumMemoryMapSize = 256 * 1024 * 1024; // 256 MB
+
+std::string jsonString(const std::string& value) {
+    std::string result = "\"";
+    for (const char c : value) {
+        switch (c) {
+        case '"': result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\r': result += "\\r"; break;
+        case '\t': result += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                result += mbgl::util::sprintf<8>("\\u%04x", c);
+            } else {
+                result += c;
+            }
+        }
+    }
+    return result + "\"";
+}
+
+// Parses comma-separated numbers like the `bounds` and `center` metadata values. Returns an
+// empty string if the value is malformed.
+std::string jsonNumberArray(const std::string& value, size_t count) {
+    std::vector<double> numbers;
+    std::istringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        try {
+            numbers.push_back(std::stod(item));
+        } catch (...) {
+            return "";
+        }
+    }
+
+    if (numbers.size() != count) {
+        return "";
+    }
+
+    std::string result = "[";
+    for (size_t i = 0; i < numbers.size(); i++) {
+        result += (i ? "," : "") + mbgl::util::toString(numbers[i]);
+    }
+    return result + "]";
+}
+
+} // namespace
+
+namespace mbgl {
+
+using namespace mapbox::sqlite;
+
+class MBTilesFileRequest : public FileRequest {
+public:
+    MBTilesFileRequest(std::unique_ptr<WorkRequest> workRequest_)
+        : workRequest(std::move(workRequest_)) {
+    }
+
+    std::unique_ptr<WorkRequest> workRequest;
+};
+
+class MBTilesFileSource::Impl {
+public:
+    void request(const Resource& resource, FileSource::Callback callback) {
+        Response response;
+
+        try {
+            if (resource.kind == Resource::Kind::Tile && resource.tileData) {
+                const auto& tileData = *resource.tileData;
+                const auto& urlTemplate = tileData.urlTemplate;
+                const auto path = urlTemplate.substr(mbtilesProtocol.size(),
+                    urlTemplate.rfind(tileURLSuffix) - mbtilesProtocol.size());
+                readTile(util::percentDecode(path), tileData.z, tileData.x, tileData.y, response);
+            } else {
+                const auto path = util::percentDecode(resource.url.substr(mbtilesProtocol.size()));
+                readTileJSON(path, resource.url, response);
+            }
+        } catch (const std::exception& ex) {
+            response.error = std::make_unique<Response::Error>(Response::Error::Reason::Other, ex.what());
+        }
+
+        callback(response);
+    }
+
+private:
+    struct Connection {
+        std::unique_ptr<Database> db;
+        std::unique_ptr<Statement> tileStmt;
+    };
+
+    Connection* open(const std::string& path, Response& response) {
+        auto it = connections.find(path);
+        if (it != connections.end()) {
+            return &it->second;
+        }
+
+        struct stat buf;
+        if (stat(path.c_str(), &buf) != 0 || S_ISDIR(buf.st_mode)) {
+            response.error = std::make_unique<Response::Error>(Response::Error::Reason::NotFound);
+            return nullptr;
+        }
+
+        Connection connection;
+        connection.db = std::make_unique<Database>(path.c_str(), ReadOnly);
+        connection.db->exec("PRAGMA mmap_size = " + util::toString(kMaximumMemoryMapSize));
+        return &connections.emplace(path, std::move(connection)).first->second;
+    }
+
+    void readTile(const std::string& path, int8_t z, int32_t x, int32_t y, Response& response) {
+        auto connection = open(path, response);
+        if (!connection) {
+            return;
+        }
+
+        if (!connection->tileStmt) {
+            connection->tileStmt = std::make_unique<Statement>(connection->db->prepare(
+                //                                                                1
+                "SELECT `tile_data` FROM `tiles` WHERE `zoom_level` = ? AND `tile_column` = ? "
+                //                   3
+                "AND `tile_row` = ?"));
+        } else {
+            connection->tileStmt->reset();
+        }
+
+        // MBTiles uses the TMS scheme, which counts rows from the bottom.
+        connection->tileStmt->bind(1, int(z));
+        connection->tileStmt->bind(2, x);
+        connection->tileStmt->bind(3, (1 << z) - 1 - y);
+
+        if (!connection->tileStmt->run()) {
+            response.error = std::make_unique<Response::Error>(Response::Error::Reason::NotFound);
+            return;
+        }
+
+        const auto blob = connection->tileStmt->getBlob(0);
+        if (blob.second >= 2 && uint8_t(blob.first[0]) == 0x1f && uint8_t(blob.first[1]) == 0x8b) {
+            // Vector tiles are usually stored gzipped; inflate them straight from the mapped file.
+            response.data = std::make_shared<std::string>(util::decompress(blob.first, blob.second));
+        } else {
+            response.data = std::make_shared<std::string>(blob.first, blob.second);
+        }
+    }
+
+    void readTileJSON(const std::string& path, const std::string& url, Response& response) {
+        auto connection = open(path, response);
+        if (!connection) {
+            return;
+        }
+
+        std::unordered_map<std::string, std::string> metadata;
+        Statement stmt = connection->db->prepare("SELECT `name`, `value` FROM `metadata`");
+        while (stmt.run()) {
+            metadata.emplace(stmt.get<std::string>(0), stmt.get<std::string>(1));
+        }
+
+        std::string json = "{\"tilejson\":\"2.0.0\",\"tiles\":[" + jsonString(url + tileURLSuffix) + "]";
+
+        for (const auto& name : { "minzoom", "maxzoom" }) {
+            auto it = metadata.find(name);
+            if (it != metadata.end() && !it->second.empty() &&
+                std::all_of(it->second.begin(), it->second.end(), ::isdigit)) {
+                json += std::string(",\"") + name + "\":" + it->second;
+            }
+        }
+
+        for (const auto& member : { std::make_pair("bounds", 4), std::make_pair("center", 3) }) {
+            auto it = metadata.find(member.first);
+            if (it != metadata.end()) {
+                const auto value = jsonNumberArray(it->second, member.second);
+                if (!value.empty()) {
+                    json += std::string(",\"") + member.first + "\":" + value;
+                }
+            }
+        }
+
+        for (const auto& name : { "name", "attribution", "format" }) {
+            auto it = metadata.find(name);
+            if (it != metadata.end()) {
+                json += std::string(",\"") + name + "\":" + jsonString(it->second);
+            }
+        }
+
+        response.data = std::make_shared<std::string>(json + "}");
+    }
+
+    std::unordered_map<std::string, Connection> connections;
+};
+
+MBTilesFileSource::MBTilesFileSource() = default;
+
+MBTilesFileSource::~MBTilesFileSource() = default;
+
+std::unique_ptr<FileRequest> MBTilesFileSource::request(const Resource& resource, Callback callback) {
+    // Most file sources never see an mbtiles:// URL, so they don't pay for idle threads.
+    std::call_once(threadsStarted, [this] {
+        // Every reader thread has its own read-only connections, so they don't block each other.
+        const size_t count = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+        for (size_t i = 0; i < count; i++) {
+            threads.emplace_back(std::make_unique<util::Thread<Impl>>(
+                util::ThreadContext{"MBTilesFileSource", util::ThreadType::Worker, util::ThreadPriority::Regular}));
+        }
+    });
+
+    auto& thread = threads[nextThread++ % threads.size()];
+    return std::make_unique<MBTilesFileRequest>(thread->invokeWithCallback(&Impl::request, callback, resource));
+}
+
+} // namespace mbgl
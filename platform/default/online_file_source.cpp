@@ -16,9 +16,25 @@
 
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <set>
+#include <tuple>
 #include <unordered_map>
 
+namespace {
+
+const uint32_t kDefaultMaximumConcurrentRequests = 20;
+const uint32_t kDefaultMaximumConcurrentRequestsPerHost = 6;
+
+// Returns the host part of the URL, which is what the per-host concurrency limit is applied to.
+std::string urlHost(const std::string& url) {
+    const auto schemeEnd = url.find("://");
+    const auto hostStart = schemeEnd == std::string::npos ? 0 : schemeEnd + 3;
+    return url.substr(hostStart, url.find('/', hostStart) - hostStart);
+}
+
+} // namespace
+
 namespace mbgl {
 
 class OnlineFileRequest : public FileRequest {
@@ -31,28 +47,68 @@ public:
         fileSource.cancel(this);
     }
 
+    void setPriority(double priority_) override {
+        // Source::update reports priorities every frame; only forward actual changes.
+        if (priority_ != priority) {
+            priority = priority_;
+            fileSource.setPriority(this, priority);
+        }
+    }
+
     OnlineFileSource& fileSource;
+    double priority = 0;
     std::unique_ptr<WorkRequest> workRequest;
 };
 
+// Performs the cache lookup and the network transfer for one canonical URL, and fans the results
+// out to every FileRequest that asked for that URL while it is alive.
 class OnlineFileRequestImpl : public util::noncopyable {
 public:
     using Callback = std::function<void (Response)>;
 
-    OnlineFileRequestImpl(const Resource&, Callback, OnlineFileSource::Impl&);
+    OnlineFileRequestImpl(const Resource&, OnlineFileSource::Impl&);
     ~OnlineFileRequestImpl();
 
+    void addSubscriber(FileRequest*, Callback, OnlineFileSource::Impl&);
+    void removeSubscriber(FileRequest*);
+    bool hasSubscribers() const;
+
+    void setPriority(FileRequest*, double);
+
     void networkIsReachableAgain(OnlineFileSource::Impl&);
 
+    // Invoked by the scheduler once a transfer slot is available for this request.
+    void startRealRequest(OnlineFileSource::Impl&);
+
+    // Requests of a lower class are always started before requests of a higher class. Within a
+    // class, requests are ordered by the lowest priority value any of their subscribers asked for.
+    uint8_t priorityClass() const;
+    double priority() const;
+
+    const std::string host;
+
+    // Set while this request is waiting in the scheduler queue for a transfer slot.
+    bool queued = false;
+    uint64_t sequence = 0;
+
 private:
     void scheduleCacheRequest(OnlineFileSource::Impl&);
     void scheduleRealRequest(OnlineFileSource::Impl&, bool forceImmediate = false);
+    void respond(const Response&);
 
     Resource resource;
     std::unique_ptr<WorkRequest> cacheRequest;
     HTTPRequestBase* realRequest = nullptr;
     util::Timer realRequestTimer;
-    Callback callback;
+    bool realRequestScheduled = false;
+    std::unordered_map<FileRequest*, Callback> subscribers;
+    std::unordered_map<FileRequest*, double> priorities;
+
+    // The most recent response that would have been served from the cache, and the error of the
+    // most recent failed attempt, if any. Subscribers that join while the request is in flight get
+    // these immediately, just like a fresh request would get the cached data followed by the error.
+    optional<Response> lastResponse;
+    optional<Response> lastFailure;
 
     // Counts the number of subsequent failed requests. We're using this value for exponential
     // backoff when retrying requests.
@@ -71,11 +127,56 @@ public:
 
     void add(Resource, FileRequest*, Callback);
     void cancel(FileRequest*);
+    void setPriority(FileRequest*, double);
+
+    void setMaximumConcurrentRequests(uint32_t);
+    void setMaximumConcurrentRequestsPerHost(uint32_t);
 
 private:
     friend OnlineFileRequestImpl;
 
-    std::unordered_map<FileRequest*, std::unique_ptr<OnlineFileRequestImpl>> pending;
+    struct PriorityOrder {
+        bool operator()(const OnlineFileRequestImpl* a, const OnlineFileRequestImpl* b) const {
+            return std::make_tuple(a->priorityClass(), a->priority(), a->sequence) <
+                   std::make_tuple(b->priorityClass(), b->priority(), b->sequence);
+        }
+    };
+
+    // Scheduling of network transfers. Requests whose timer fired are queued and started in
+    // priority order as long as neither the global nor the per-host limit is reached.
+    void queueRequest(OnlineFileRequestImpl*);
+    void finishRequest(OnlineFileRequestImpl*);
+    void removeRequest(OnlineFileRequestImpl*);
+    void activatePendingRequests();
+
+    // Applies a change that may affect the ordering of the request while keeping the queue sorted.
+    template <typename Fn>
+    void reorder(OnlineFileRequestImpl* request, Fn&& fn) {
+        const bool wasQueued = request->queued;
+        if (wasQueued) {
+            queue.erase(request);
+        }
+        fn();
+        if (wasQueued) {
+            queue.insert(request);
+        }
+    }
+
+    std::set<OnlineFileRequestImpl*, PriorityOrder> queue;
+    std::set<OnlineFileRequestImpl*> running;
+    std::unordered_map<std::string, uint32_t> runningPerHost;
+    uint64_t sequence = 0;
+
+    uint32_t maximumConcurrentRequests = kDefaultMaximumConcurrentRequests;
+    uint32_t maximumConcurrentRequestsPerHost = kDefaultMaximumConcurrentRequestsPerHost;
+
+    // Maps each FileRequest to the URL of the shared request it subscribed to.
+    std::unordered_map<FileRequest*, std::string> pending;
+
+    // In-flight requests, keyed by normalized URL. The access token is part of the key, so that
+    // every transfer is made with the token of the requests that share it.
+    std::unordered_map<std::string, std::unique_ptr<OnlineFileRequestImpl>> active;
+
     SQLiteCache* const cache;
     const std::unique_ptr<HTTPContextBase> httpContext;
     util::AsyncTask reachability;
@@ -94,31 +195,7 @@ std::unique_ptr<FileRequest> OnlineFileSource::request(const Resource& resource,
         throw util::MisuseException("FileSource callback can't be empty");
     }
 
-    std::string url;
-
-    switch (resource.kind) {
-    case Resource::Kind::Style:
-        url = mbgl::util::mapbox::normalizeStyleURL(resource.url, accessToken);
-        break;
-
-    case Resource::Kind::Source:
-        url = util::mapbox::normalizeSourceURL(resource.url, accessToken);
-        break;
-
-    case Resource::Kind::Glyphs:
-        url = util::mapbox::normalizeGlyphsURL(resource.url, accessToken);
-        break;
-
-    case Resource::Kind::SpriteImage:
-    case Resource::Kind::SpriteJSON:
-        url = util::mapbox::normalizeSpriteURL(resource.url, accessToken);
-        break;
-
-    default:
-        url = resource.url;
-    }
-
-    Resource res { resource.kind, url };
+    Resource res { resource.kind, util::mapbox::normalizeURL(resource.kind, resource.url, accessToken) };
     auto req = std::make_unique<OnlineFileRequest>(*this);
     req->workRequest = thread->invokeWithCallback(&Impl::add, callback, res, req.get());
     return std::move(req);
@@ -128,6 +205,18 @@ void OnlineFileSource::cancel(FileRequest* req) {
     thread->invoke(&Impl::cancel, req);
 }
 
+void OnlineFileSource::setPriority(FileRequest* req, double priority) {
+    thread->invoke(&Impl::setPriority, req, priority);
+}
+
+void OnlineFileSource::setMaximumConcurrentRequests(uint32_t count) {
+    thread->invoke(&Impl::setMaximumConcurrentRequests, count);
+}
+
+void OnlineFileSource::setMaximumConcurrentRequestsPerHost(uint32_t count) {
+    thread->invoke(&Impl::setMaximumConcurrentRequestsPerHost, count);
+}
+
 // ----- Impl -----
 
 OnlineFileSource::Impl::Impl(SQLiteCache* cache_)
@@ -145,24 +234,123 @@ OnlineFileSource::Impl::~Impl() {
 }
 
 void OnlineFileSource::Impl::networkIsReachableAgain() {
-    for (auto& req : pending) {
+    for (auto& req : active) {
         req.second->networkIsReachableAgain(*this);
     }
 }
 
 void OnlineFileSource::Impl::add(Resource resource, FileRequest* req, Callback callback) {
-    pending[req] = std::make_unique<OnlineFileRequestImpl>(resource, callback, *this);
+    auto key = resource.url;
+
+    auto it = active.find(key);
+    if (it == active.end()) {
+        it = active.emplace(key, std::make_unique<OnlineFileRequestImpl>(resource, *this)).first;
+    }
+
+    OnlineFileRequestImpl* request = it->second.get();
+    reorder(request, [&] { request->addSubscriber(req, callback, *this); });
+    pending.emplace(req, std::move(key));
 }
 
 void OnlineFileSource::Impl::cancel(FileRequest* req) {
-    pending.erase(req);
+    auto it = pending.find(req);
+    if (it == pending.end()) {
+        return;
+    }
+
+    auto activeIt = active.find(it->second);
+    assert(activeIt != active.end());
+
+    // The shared request is only torn down (and its transfer canceled) once the last
+    // subscriber went away.
+    OnlineFileRequestImpl* request = activeIt->second.get();
+    reorder(request, [&] { request->removeSubscriber(req); });
+    if (!request->hasSubscribers()) {
+        removeRequest(request);
+        active.erase(activeIt);
+        activatePendingRequests();
+    }
+
+    pending.erase(it);
+}
+
+void OnlineFileSource::Impl::setPriority(FileRequest* req, double priority) {
+    auto it = pending.find(req);
+    if (it == pending.end()) {
+        return;
+    }
+
+    OnlineFileRequestImpl* request = active.at(it->second).get();
+    reorder(request, [&] { request->setPriority(req, priority); });
+}
+
+void OnlineFileSource::Impl::setMaximumConcurrentRequests(uint32_t count) {
+    maximumConcurrentRequests = count;
+    activatePendingRequests();
+}
+
+void OnlineFileSource::Impl::setMaximumConcurrentRequestsPerHost(uint32_t count) {
+    maximumConcurrentRequestsPerHost = count;
+    activatePendingRequests();
+}
+
+void OnlineFileSource::Impl::queueRequest(OnlineFileRequestImpl* request) {
+    assert(!request->queued);
+    request->queued = true;
+    request->sequence = sequence++;
+    queue.insert(request);
+    activatePendingRequests();
+}
+
+void OnlineFileSource::Impl::finishRequest(OnlineFileRequestImpl* request) {
+    removeRequest(request);
+    activatePendingRequests();
+}
+
+void OnlineFileSource::Impl::removeRequest(OnlineFileRequestImpl* request) {
+    if (request->queued) {
+        queue.erase(request);
+        request->queued = false;
+    } else if (running.erase(request)) {
+        auto it = runningPerHost.find(request->host);
+        assert(it != runningPerHost.end());
+        if (--it->second == 0) {
+            runningPerHost.erase(it);
+        }
+    }
+}
+
+void OnlineFileSource::Impl::activatePendingRequests() {
+    // A limit of zero means unlimited.
+    auto it = queue.begin();
+    while (it != queue.end() &&
+           (!maximumConcurrentRequests || running.size() < maximumConcurrentRequests)) {
+        OnlineFileRequestImpl* request = *it;
+
+        auto& hostCount = runningPerHost[request->host];
+        if (maximumConcurrentRequestsPerHost && hostCount >= maximumConcurrentRequestsPerHost) {
+            // This host is saturated; look for the next request that goes elsewhere.
+            ++it;
+            continue;
+        }
+
+        it = queue.erase(it);
+        request->queued = false;
+        running.insert(request);
+        hostCount++;
+
+        request->startRealRequest(*this);
+
+        // Starting a request may have modified the queue, so begin the search from the front.
+        it = queue.begin();
+    }
 }
 
 // ----- OnlineFileRequest -----
 
-OnlineFileRequestImpl::OnlineFileRequestImpl(const Resource& resource_, Callback callback_, OnlineFileSource::Impl& impl)
-    : resource(resource_),
-      callback(callback_) {
+OnlineFileRequestImpl::OnlineFileRequestImpl(const Resource& resource_, OnlineFileSource::Impl& impl)
+    : host(urlHost(resource_.url)),
+      resource(resource_) {
     if (impl.cache) {
         scheduleCacheRequest(impl);
     } else {
@@ -178,6 +366,82 @@ OnlineFileRequestImpl::~OnlineFileRequestImpl() {
     // realRequestTimer and cacheRequest are automatically canceled upon destruction.
 }
 
+void OnlineFileRequestImpl::addSubscriber(FileRequest* req, Callback callback, OnlineFileSource::Impl& impl) {
+    if (lastResponse) {
+        callback(*lastResponse);
+    }
+    if (lastFailure) {
+        callback(*lastFailure);
+    }
+
+    subscribers.emplace(req, std::move(callback));
+
+    // A fresh request would revalidate data that has no expiration time right away. When nothing is
+    // in progress and no refresh is scheduled, do the same, so that this subscriber doesn't get the
+    // replayed response only.
+    if (!cacheRequest && !realRequest && !queued && !realRequestScheduled) {
+        scheduleRealRequest(impl, true);
+    }
+}
+
+void OnlineFileRequestImpl::removeSubscriber(FileRequest* req) {
+    subscribers.erase(req);
+    priorities.erase(req);
+}
+
+bool OnlineFileRequestImpl::hasSubscribers() const {
+    return !subscribers.empty();
+}
+
+void OnlineFileRequestImpl::setPriority(FileRequest* req, double priority_) {
+    priorities[req] = priority_;
+}
+
+uint8_t OnlineFileRequestImpl::priorityClass() const {
+    switch (resource.kind) {
+    case Resource::Kind::Style:
+    case Resource::Kind::Source:
+        return 0;
+    case Resource::Kind::SpriteJSON:
+    case Resource::Kind::SpriteImage:
+    case Resource::Kind::Glyphs:
+        return 1;
+    case Resource::Kind::Tile:
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+double OnlineFileRequestImpl::priority() const {
+    // Subscribers that never set a priority count as the most urgent one.
+    double result = priorities.size() < subscribers.size() ? 0 : std::numeric_limits<double>::max();
+    for (const auto& entry : priorities) {
+        result = std::min(result, entry.second);
+    }
+    return result;
+}
+
+void OnlineFileRequestImpl::respond(const Response& response) {
+    if (response.error && response.error->reason != Response::Error::Reason::NotFound) {
+        lastFailure = response;
+    } else if (!response.notModified || !lastResponse) {
+        lastResponse = response;
+        lastFailure = {};
+    } else {
+        // A 304 doesn't carry data; keep handing the previous data to late subscribers, but with
+        // the updated caching headers.
+        lastResponse->modified = response.modified;
+        lastResponse->expires = response.expires;
+        lastResponse->etag = response.etag;
+        lastFailure = {};
+    }
+
+    for (auto& subscriber : subscribers) {
+        subscriber.second(response);
+    }
+}
+
 void OnlineFileRequestImpl::scheduleCacheRequest(OnlineFileSource::Impl& impl) {
     // Check the cache for existing data so that we can potentially
     // revalidate the information without having to redownload everything.
@@ -188,7 +452,7 @@ void OnlineFileRequestImpl::scheduleCacheRequest(OnlineFileSource::Impl& impl) {
             resource.priorModified = response->modified;
             resource.priorExpires = response->expires;
             resource.priorEtag = response->etag;
-            callback(*response);
+            respond(*response);
         }
 
         // Force immediate revalidation if we don't have a cached response, or the cached
@@ -221,8 +485,8 @@ static Duration expirationTimeout(optional<SystemTimePoint> expires) {
 }
 
 void OnlineFileRequestImpl::scheduleRealRequest(OnlineFileSource::Impl& impl, bool forceImmediate) {
-    if (realRequest) {
-        // There's already a request in progress; don't start another one.
+    if (realRequest || queued) {
+        // There's already a request in progress or waiting for a slot; don't start another one.
         return;
     }
 
@@ -237,47 +501,54 @@ void OnlineFileRequestImpl::scheduleRealRequest(OnlineFileSource::Impl& impl, bo
         return;
     }
 
+    realRequestScheduled = true;
     realRequestTimer.start(timeout, Duration::zero(), [this, &impl] {
-        assert(!realRequest);
-        realRequest = impl.httpContext->createRequest(resource, [this, &impl](Response response) {
-            realRequest = nullptr;
-
-            // If we didn't get various caching headers in the response, continue using the
-            // previous values. Otherwise, update the previous values to the new values.
-
-            if (!response.modified) {
-                response.modified = resource.priorModified;
-            } else {
-                resource.priorModified = response.modified;
-            }
-
-            if (!response.expires) {
-                response.expires = resource.priorExpires;
-            } else {
-                resource.priorExpires = response.expires;
-            }
-
-            if (!response.etag) {
-                response.etag = resource.priorEtag;
-            } else {
-                resource.priorEtag = response.etag;
-            }
-
-            if (impl.cache) {
-                impl.cache->put(resource, response);
-            }
-
-            if (response.error) {
-                failedRequests++;
-                failedRequestReason = response.error->reason;
-            } else {
-                failedRequests = 0;
-                failedRequestReason = Response::Error::Reason::Success;
-            }
-
-            callback(response);
-            scheduleRealRequest(impl);
-        });
+        realRequestScheduled = false;
+        impl.queueRequest(this);
+    });
+}
+
+void OnlineFileRequestImpl::startRealRequest(OnlineFileSource::Impl& impl) {
+    assert(!realRequest);
+    realRequest = impl.httpContext->createRequest(resource, [this, &impl](Response response) {
+        realRequest = nullptr;
+        impl.finishRequest(this);
+
+        // If we didn't get various caching headers in the response, continue using the
+        // previous values. Otherwise, update the previous values to the new values.
+
+        if (!response.modified) {
+            response.modified = resource.priorModified;
+        } else {
+            resource.priorModified = response.modified;
+        }
+
+        if (!response.expires) {
+            response.expires = resource.priorExpires;
+        } else {
+            resource.priorExpires = response.expires;
+        }
+
+        if (!response.etag) {
+            response.etag = resource.priorEtag;
+        } else {
+            resource.priorEtag = response.etag;
+        }
+
+        if (impl.cache) {
+            impl.cache->put(resource, response);
+        }
+
+        if (response.error) {
+            failedRequests++;
+            failedRequestReason = response.error->reason;
+        } else {
+            failedRequests = 0;
+            failedRequestReason = Response::Error::Reason::Success;
+        }
+
+        respond(response);
+        scheduleRealRequest(impl);
     });
 }
 
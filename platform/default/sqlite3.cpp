@@ -77,6 +77,11 @@ Statement Database::prepare(const char *query) {
     return Statement(db, query);
 }
 
+int64_t Database::lastInsertRowId() const {
+    assert(db);
+    return sqlite3_last_insert_rowid(db);
+}
+
 Statement::Statement(sqlite3 *db, const char *sql) {
     const int err = sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
     if (err != SQLITE_OK) {
@@ -197,6 +202,11 @@ template <> double Statement::get(int offset) {
 }
 
 template <> std::string Statement::get(int offset) {
+    const auto blob = getBlob(offset);
+    return { blob.first, blob.second };
+}
+
+std::pair<const char *, size_t> Statement::getBlob(int offset) {
     assert(stmt);
     return {
         reinterpret_cast<const char *>(sqlite3_column_blob(stmt, offset)),
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <utility>
 #include <stdexcept>
 
 typedef struct sqlite3 sqlite3;
@@ -42,6 +43,7 @@ public:
 
     void exec(const std::string &sql);
     Statement prepare(const char *query);
+    int64_t lastInsertRowId() const;
 
 private:
     sqlite3 *db = nullptr;
@@ -66,6 +68,10 @@ public:
     void bind(int offset, const std::string &value, bool retain = true);
     template <typename T> T get(int offset);
 
+    // Returns the blob or text value without copying it. The memory is owned by SQLite and is only
+    // valid until the statement is stepped, reset or destroyed.
+    std::pair<const char *, size_t> getBlob(int offset);
+
     bool run();
     void reset();
 
@@ -4,16 +4,20 @@
 
 #include <mbgl/util/compression.hpp>
 #include <mbgl/util/io.hpp>
+#include <mbgl/util/run_loop.hpp>
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/thread.hpp>
+#include <mbgl/util/timer.hpp>
 #include <mbgl/util/mapbox.hpp>
 #include <mbgl/platform/log.hpp>
 
 #include "sqlite3.hpp"
 #include <sqlite3.h>
 
+#include <algorithm>
 #include <unordered_map>
 #include <mutex>
+#include <vector>
 
 namespace {
 
@@ -23,10 +27,22 @@ namespace {
 // never shrink again.
 const uint64_t kMaximumCacheEntrySize = 5 * 1024 * 1024; // 5 MB
 
-// Number of records we delete when we are close to the maximum
-// database size, if set. The current criteria is to prune
-// the least used entries based on `accessed` time.
-const int kPrunedEntriesLimit = 100;
+// Number of free pages that are returned to the file system after pruning at a time. Writes
+// continue returning pages until the file doesn't contain any free pages anymore.
+const int kVacuumPageBudget = 256;
+
+// Writes are buffered and committed in a single transaction once this many are pending, or
+// after the interval elapsed, whichever comes first.
+const uint32_t kWriteBatchSize = 100;
+const mbgl::Duration kWriteBatchInterval = mbgl::Milliseconds(250);
+
+// Tiles are compressed with a dictionary built from this many tiles once they've been cached.
+// Deflate can't refer back further than 32 KB, so a larger dictionary wouldn't help.
+const size_t kDictionarySampleCount = 50;
+const size_t kMaximumDictionarySize = 32 * 1024;
+
+// Size of the in-memory tier of caches obtained with SQLiteCache::getShared().
+const uint64_t kDefaultMemoryCacheSize = 8 * 1024 * 1024; // 8 MB
 
 } // namespace
 
@@ -35,28 +51,42 @@ namespace mbgl {
 using namespace mapbox::sqlite;
 
 SQLiteCache::SQLiteCache(const std::string& path_)
-    : thread(std::make_unique<util::Thread<Impl>>(util::ThreadContext{"SQLiteCache", util::ThreadType::Unknown, util::ThreadPriority::Low}, path_)) {
+    : memory(std::make_shared<MemoryCache>()),
+      thread(std::make_unique<util::Thread<Impl>>(util::ThreadContext{"SQLiteCache", util::ThreadType::Unknown, util::ThreadPriority::Low}, path_, kWriteBatchInterval, kWriteBatchSize)) {
+    thread->invoke(&Impl::setSynchronous, Synchronous::Normal);
+    thread->invoke(&Impl::setDictionaryCompression, true);
+    memory->setMaximumEntrySize(kMaximumCacheEntrySize);
 }
 
 SQLiteCache::~SQLiteCache() = default;
 
-SQLiteCache::Impl::Impl(const std::string& path_)
+SQLiteCache::Impl::Impl(const std::string& path_, Duration writeBatchInterval_, uint32_t writeBatchSize_)
     : maximumCacheSize(0), // Unlimited
       maximumCacheEntrySize(kMaximumCacheEntrySize),
-      path(path_) {
+      path(path_),
+      writeBatchInterval(writeBatchInterval_),
+      writeBatchSize(writeBatchSize_) {
 }
 
 SQLiteCache::Impl::~Impl() {
+    // Commit whatever is still queued before closing the database.
+    flush();
+
     // Deleting these SQLite objects may result in exceptions, but we're in a destructor, so we
     // can't throw anything.
     try {
         getStmt.reset();
         putStmt.reset();
         refreshStmt.reset();
-        countStmt.reset();
-        freeStmt.reset();
+        sizeStmt.reset();
+        pruneScanStmt.reset();
         pruneStmt.reset();
+        deleteStmt.reset();
+        entrySizeStmt.reset();
         accessedStmt.reset();
+        pinStmt.reset();
+        unpinStmt.reset();
+        dictionaryStmt.reset();
         db.reset();
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
@@ -70,11 +100,13 @@ void SQLiteCache::Impl::createDatabase() {
 int SQLiteCache::Impl::schemaVersion() const {
     // WARNING: Bump the version when changing the cache
     // scheme to force the table to be recreated.
-    return 1;
+    return 3;
 }
 
 void SQLiteCache::Impl::createSchema() {
+    // Incremental vacuuming can only be enabled before the first table is created.
     constexpr const char *const sql = ""
+        "PRAGMA auto_vacuum = INCREMENTAL;"
         "CREATE TABLE IF NOT EXISTS `http_cache` ("
         "    `url` TEXT PRIMARY KEY NOT NULL,"
         "    `status` INTEGER NOT NULL," // The response status (Successful or Error).
@@ -84,10 +116,35 @@ void SQLiteCache::Impl::createSchema() {
         "    `expires` INTEGER," // Timestamp when the server says the file expires.
         "    `accessed` INTEGER," // Timestamp when the database record was last accessed.
         "    `data` BLOB,"
-        "    `compressed` INTEGER NOT NULL DEFAULT 0" // Whether the data is compressed.
+        "    `compressed` INTEGER NOT NULL DEFAULT 0," // Whether the data is compressed.
+        "    `dictionary` INTEGER NOT NULL DEFAULT 0" // The dictionary used for compressing, if any.
         ");"
         "CREATE INDEX IF NOT EXISTS `http_cache_kind_idx` ON `http_cache` (`kind`);"
-        "CREATE INDEX IF NOT EXISTS `http_cache_accessed_idx` ON `http_cache` (`accessed`);";
+        "CREATE INDEX IF NOT EXISTS `http_cache_accessed_idx` ON `http_cache` (`accessed`);"
+        "CREATE TABLE IF NOT EXISTS `http_cache_pinned` (" // Entries that are never pruned.
+        "    `url` TEXT PRIMARY KEY NOT NULL"
+        ");"
+        "CREATE TABLE IF NOT EXISTS `http_cache_dictionaries` ("
+        "    `id` INTEGER PRIMARY KEY NOT NULL,"
+        "    `data` BLOB NOT NULL"
+        ");"
+        "CREATE TABLE IF NOT EXISTS `http_cache_size` (" // The total size of all entries.
+        "    `size` INTEGER NOT NULL"
+        ");"
+        "INSERT INTO `http_cache_size` SELECT 0 WHERE NOT EXISTS (SELECT * FROM `http_cache_size`);"
+        // Keep the total up to date in the same transaction as the change. Note that REPLACE
+        // doesn't run the delete trigger, so entries are deleted before they are rewritten.
+        "CREATE TRIGGER IF NOT EXISTS `http_cache_size_insert` AFTER INSERT ON `http_cache` BEGIN"
+        "    UPDATE `http_cache_size` SET `size` = `size` + LENGTH(NEW.`url`) + IFNULL(LENGTH(NEW.`data`), 0);"
+        "END;"
+        "CREATE TRIGGER IF NOT EXISTS `http_cache_size_update` AFTER UPDATE OF `url`, `data` ON `http_cache` BEGIN"
+        "    UPDATE `http_cache_size` SET `size` = `size`"
+        "        + LENGTH(NEW.`url`) + IFNULL(LENGTH(NEW.`data`), 0)"
+        "        - LENGTH(OLD.`url`) - IFNULL(LENGTH(OLD.`data`), 0);"
+        "END;"
+        "CREATE TRIGGER IF NOT EXISTS `http_cache_size_delete` AFTER DELETE ON `http_cache` BEGIN"
+        "    UPDATE `http_cache_size` SET `size` = `size` - LENGTH(OLD.`url`) - IFNULL(LENGTH(OLD.`data`), 0);"
+        "END;";
 
     ensureSchemaVersion();
 
@@ -112,6 +169,7 @@ void SQLiteCache::Impl::createSchema() {
         // Creating the database table + index failed. That means there may already be one, likely
         // with different columns. Drop it and try to create a new one.
         db->exec("DROP TABLE IF EXISTS `http_cache`");
+        db->exec("DROP TABLE IF EXISTS `http_cache_size`");
         db->exec(sql);
         db->exec("PRAGMA user_version = " + util::toString(schemaVersion()));
     }
@@ -135,6 +193,14 @@ void SQLiteCache::Impl::ensureSchemaVersion() {
     // get recreated by `createSchema()`.
     try {
         db->exec("DROP TABLE IF EXISTS `http_cache`");
+        db->exec("DROP TABLE IF EXISTS `http_cache_pinned`");
+        db->exec("DROP TABLE IF EXISTS `http_cache_dictionaries`");
+        db->exec("DROP TABLE IF EXISTS `http_cache_size`");
+
+        // Switching an existing database to incremental vacuuming requires a full VACUUM, which
+        // is cheap now that the tables are gone.
+        db->exec("PRAGMA auto_vacuum = INCREMENTAL");
+        db->exec("VACUUM");
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
     }
@@ -152,28 +218,17 @@ void SQLiteCache::Impl::setMaximumCacheSize(uint64_t size) {
         return;
     }
 
-    uint64_t lastSoftSize = cacheSoftSize();
-
-    // Keep pruning until we fit in the new
-    // size limit.
-    while (lastSoftSize > maximumCacheSize) {
-        pruneEntries();
+    // Make sure queued writes are accounted for before deciding what to prune.
+    flush();
 
-        if (lastSoftSize != cacheSoftSize()) {
-            lastSoftSize = cacheSoftSize();
-        } else {
-            break;
-        }
-    }
-
-    if (cacheHardSize() > size) {
-        Log::Warning(mbgl::Event::Database,
-            "Current cache hard size is bigger than the defined "
-            "maximum size. Database won't get truncated.");
+    pruneEntries();
+    if (vacuumPending) {
+        vacuumStep();
     }
 }
 
 void SQLiteCache::setMaximumCacheEntrySize(uint64_t size) {
+    memory->setMaximumEntrySize(size);
     thread->invoke(&Impl::setMaximumCacheEntrySize, size);
 }
 
@@ -181,6 +236,47 @@ void SQLiteCache::Impl::setMaximumCacheEntrySize(uint64_t size) {
     maximumCacheEntrySize = size;
 }
 
+void SQLiteCache::setMaximumMemoryCacheSize(uint64_t size) {
+    memory->setMaximumSize(size);
+}
+
+MemoryCache::Stats SQLiteCache::getMemoryCacheStats() const {
+    return memory->getStats();
+}
+
+void SQLiteCache::setSynchronous(Synchronous mode) {
+    thread->invoke(&Impl::setSynchronous, mode);
+}
+
+void SQLiteCache::Impl::setSynchronous(Synchronous mode) {
+    synchronous = mode;
+
+    if (db && schema) {
+        configureDatabase();
+    }
+}
+
+void SQLiteCache::setWriteBatching(Duration interval, uint32_t size) {
+    thread->invoke(&Impl::setWriteBatching, interval, size);
+}
+
+void SQLiteCache::Impl::setWriteBatching(Duration interval, uint32_t size) {
+    writeBatchInterval = interval;
+    writeBatchSize = size;
+
+    if (pendingWrites.size() >= writeBatchSize) {
+        flush();
+    }
+}
+
+void SQLiteCache::setDictionaryCompression(bool enabled) {
+    thread->invoke(&Impl::setDictionaryCompression, enabled);
+}
+
+void SQLiteCache::Impl::setDictionaryCompression(bool enabled) {
+    dictionaryCompression = enabled;
+}
+
 void SQLiteCache::Impl::initializeDatabase() {
     if (!db) {
         createDatabase();
@@ -188,116 +284,121 @@ void SQLiteCache::Impl::initializeDatabase() {
 
     if (!schema) {
         createSchema();
+        configureDatabase();
     }
 }
 
-int SQLiteCache::Impl::cachePageSize() {
-    try {
-        if (!pageSize) {
-            Statement pageSizeStmt(db->prepare("PRAGMA page_size"));
-            if (pageSizeStmt.run()) {
-                pageSize = pageSizeStmt.get<int>(0);
-            }
-        }
-    } catch (mapbox::sqlite::Exception& ex) {
-        Log::Error(Event::Database, ex.code, ex.what());
+void SQLiteCache::Impl::configureDatabase() {
+    // With write-ahead logging, a commit appends to the log instead of rewriting the database
+    // pages, and readers don't block on writers. Together with batched writes, this turns one
+    // fsync per cached response into one per batch.
+    if (!synchronous) {
+        return;
     }
 
-    return pageSize;
-}
-
-uint64_t SQLiteCache::Impl::cacheHardSize() {
     try {
-        initializeDatabase();
-
-        if (!countStmt) {
-            countStmt = std::make_unique<Statement>(db->prepare("PRAGMA page_count"));
-        } else {
-            countStmt->reset();
-        }
-
-        if (countStmt->run()) {
-            return cachePageSize() * countStmt->get<int>(0);
-        }
+        db->exec("PRAGMA journal_mode = WAL");
+        db->exec("PRAGMA synchronous = " + util::toString(int(*synchronous)));
     } catch (mapbox::sqlite::Exception& ex) {
-        Log::Error(Event::Database, ex.code, ex.what());
+        Log::Warning(Event::Database, "Unable to configure database: %s", ex.what());
     }
-
-    return 0;
 }
 
-uint64_t SQLiteCache::Impl::cacheSoftSize() {
-    if (!softSizeDirty) {
-        return softSize;
+uint64_t SQLiteCache::Impl::cacheSize() {
+    if (!sizeDirty) {
+        return totalSize;
     }
 
     try {
         initializeDatabase();
 
-        if (!freeStmt) {
-            freeStmt = std::make_unique<Statement>(db->prepare("PRAGMA freelist_count"));
+        if (!sizeStmt) {
+            sizeStmt = std::make_unique<Statement>(db->prepare("SELECT `size` FROM `http_cache_size`"));
         } else {
-            freeStmt->reset();
-        }
-
-        uint64_t hardSize = cacheHardSize();
-        if (!hardSize) {
-            return 0;
+            sizeStmt->reset();
         }
 
-        if (freeStmt->run()) {
-            return hardSize - cachePageSize() * freeStmt->get<int>(0);
+        if (sizeStmt->run()) {
+            totalSize = sizeStmt->get<int64_t>(0);
+            sizeDirty = false;
         }
-
-        softSizeDirty = false;
+        sizeStmt->reset();
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
     }
 
-    return 0;
+    return totalSize;
 }
 
-bool SQLiteCache::Impl::needsPruning() {
-    // SQLite database never shrinks in size unless we call VACCUM. We here
-    // are monitoring the soft limit (i.e. number of free pages in the file)
-    // and as it approaches to the hard limit (i.e. the actual file size) we
-    // delete an arbitrary number of old cache entries.
-    //
-    // The free pages approach saves us from calling VACCUM or keeping a
-    // running total, which can be costly. We need a buffer because pages can
-    // get fragmented on the database.
-    if (cacheSoftSize() + maximumCacheEntrySize * 2 < maximumCacheSize) {
-        return false;
-    } else {
-        return true;
-    }
-}
-
-void SQLiteCache::Impl::pruneEntries() {
+void SQLiteCache::Impl::pruneEntries(uint64_t incomingSize) {
     if (!maximumCacheSize) {
         return;
     }
 
-    if (!needsPruning()) {
+    const uint64_t currentSize = cacheSize();
+    if (currentSize + incomingSize <= maximumCacheSize) {
         return;
     }
 
+    const uint64_t excess = currentSize + incomingSize - maximumCacheSize;
+
     try {
+        // Walk the least recently accessed entries until they add up to the excess, then delete
+        // all of them in a single statement. The `accessed` index also orders by `rowid`.
+        if (!pruneScanStmt) {
+            pruneScanStmt = std::make_unique<Statement>(db->prepare(
+                "SELECT `accessed`, `rowid`, LENGTH(`url`) + IFNULL(LENGTH(`data`), 0) "
+                "FROM `http_cache` WHERE `url` NOT IN (SELECT `url` FROM `http_cache_pinned`) "
+                "ORDER BY `accessed` ASC, `rowid` ASC"));
+        } else {
+            pruneScanStmt->reset();
+        }
+
+        uint64_t freed = 0;
+        int64_t accessed = 0;
+        int64_t rowid = 0;
+        while (freed < excess && pruneScanStmt->run()) {
+            accessed = pruneScanStmt->get<int64_t>(0);
+            rowid = pruneScanStmt->get<int64_t>(1);
+            freed += pruneScanStmt->get<int64_t>(2);
+        }
+        pruneScanStmt->reset();
+
+        if (!freed) {
+            return;
+        }
+
         if (!pruneStmt) {
             pruneStmt = std::make_unique<Statement>(db->prepare(
-                "DELETE FROM `http_cache` WHERE `rowid` IN (SELECT `rowid` FROM "
-                //                                          1
-                "`http_cache` ORDER BY `accessed` ASC LIMIT ?)"));
+                "DELETE FROM `http_cache` WHERE `url` NOT IN (SELECT `url` FROM `http_cache_pinned`) "
+                //                   1                  1                2
+                "AND (`accessed` < ?1 OR (`accessed` = ?1 AND `rowid` <= ?2))"));
         } else {
             pruneStmt->reset();
         }
 
-        pruneStmt->bind(1, kPrunedEntriesLimit);
-
+        pruneStmt->bind(1, accessed);
+        pruneStmt->bind(2, rowid);
         pruneStmt->run();
-        softSizeDirty = true;
+
+        sizeDirty = true;
+        vacuumPending = true;
+    } catch (mapbox::sqlite::Exception& ex) {
+        Log::Error(Event::Database, ex.code, ex.what());
+    }
+}
+
+void SQLiteCache::Impl::vacuumStep() {
+    // Returns a bounded number of free pages to the file system, so that the file shrinks after
+    // pruning without stalling the cache thread like a full VACUUM would.
+    try {
+        db->exec("PRAGMA incremental_vacuum(" + util::toString(kVacuumPageBudget) + ")");
+
+        Statement freeStmt(db->prepare("PRAGMA freelist_count"));
+        vacuumPending = freeStmt.run() && freeStmt.get<int>(0) > 0;
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
+        vacuumPending = false;
     }
 }
 
@@ -306,23 +407,54 @@ std::unique_ptr<WorkRequest> SQLiteCache::get(const Resource &resource, Callback
     // Will try to load the URL from the SQLite database and call the callback when done.
     // Note that the callback is probably going to invoked from another thread, so the caller
     // must make sure that it can run in that thread.
-    return thread->invokeWithCallback(&Impl::get, callback, resource);
+    const auto canonicalURL = util::mapbox::canonicalURL(resource.url);
+    if (auto response = memory->get(canonicalURL)) {
+        // The database entry is still used, so it must not look stale to pruning.
+        thread->invoke(&Impl::touch, resource);
+
+        // Still reply asynchronously, just like a database hit would.
+        return util::RunLoop::Get()->invokeCancellable(
+            [callback] (std::unique_ptr<Response> res) { callback(std::move(res)); },
+            std::move(response));
+    }
+
+    return thread->invokeWithCallback(&Impl::get,
+        [callback, canonicalURL, memory_ = memory] (std::unique_ptr<Response> res) {
+            if (res) {
+                memory_->add(canonicalURL, *res);
+            }
+            callback(std::move(res));
+        }, resource);
 }
 
 void SQLiteCache::Impl::get(const Resource &resource, Callback callback) {
+    const auto canonicalURL = util::mapbox::canonicalURL(resource.url);
+
+    // Queued writes take precedence over the database, since they are newer.
+    auto pending = pendingWrites.find(canonicalURL);
+    if (pending != pendingWrites.end() && pending->second.response) {
+        auto response = std::make_unique<Response>(*pending->second.response);
+        if (!response->data) {
+            response->data = std::make_shared<std::string>();
+        }
+        callback(std::move(response));
+        return;
+    }
+
     try {
         initializeDatabase();
 
         if (!getStmt) {
             // Initialize the statement                                  0         1
             getStmt = std::make_unique<Statement>(db->prepare("SELECT `status`, `modified`, "
-            //     2         3        4          5                                       1
-                "`etag`, `expires`, `data`, `compressed` FROM `http_cache` WHERE `url` = ?"));
+            //     2         3        4          5              6
+                "`etag`, `expires`, `data`, `compressed`, `dictionary` FROM `http_cache` "
+            //                 1
+                "WHERE `url` = ?"));
         } else {
             getStmt->reset();
         }
 
-        const auto canonicalURL = util::mapbox::canonicalURL(resource.url);
         getStmt->bind(1, canonicalURL.c_str());
         if (getStmt->run()) {
             // There is data.
@@ -335,9 +467,17 @@ void SQLiteCache::Impl::get(const Resource &resource, Callback callback) {
             response->modified = getStmt->get<optional<SystemTimePoint>>(1);
             response->etag = getStmt->get<optional<std::string>>(2);
             response->expires = getStmt->get<optional<SystemTimePoint>>(3);
-            response->data = std::make_shared<std::string>(getStmt->get<std::string>(4));
             if (getStmt->get<int>(5)) { // == compressed
-                response->data = std::make_shared<std::string>(util::decompress(*response->data));
+                const std::string& preset = dictionary(getStmt->get<int64_t>(6));
+
+                // Inflate straight from SQLite's copy of the blob.
+                const auto blob = getStmt->getBlob(4);
+                response->data = std::make_shared<std::string>(util::decompress(blob.first, blob.second, preset));
+            } else {
+                response->data = std::make_shared<std::string>(getStmt->get<std::string>(4));
+            }
+            if (pending != pendingWrites.end() && pending->second.refresh) {
+                response->expires = pending->second.expires;
             }
             callback(std::move(response));
         } else {
@@ -345,22 +485,7 @@ void SQLiteCache::Impl::get(const Resource &resource, Callback callback) {
             callback(nullptr);
         }
 
-        // We do an extra query for refreshing the last time
-        // the record was accessed that can be costly and is only
-        // worth doing if we are monitoring the database size.
-        if (maximumCacheSize) {
-            if (!accessedStmt) {
-                accessedStmt = std::make_unique<Statement>(
-                    //                                                1               2
-                    db->prepare("UPDATE `http_cache` SET `accessed` = ? WHERE `url` = ?"));
-            } else {
-                accessedStmt->reset();
-            }
-
-            accessedStmt->bind(1, SystemClock::now());
-            accessedStmt->bind(2, canonicalURL.c_str());
-            accessedStmt->run();
-        }
+        touch(resource);
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
         callback(nullptr);
@@ -370,48 +495,274 @@ void SQLiteCache::Impl::get(const Resource &resource, Callback callback) {
     }
 }
 
+void SQLiteCache::Impl::touch(const Resource& resource) {
+    // We do an extra write for refreshing the last time
+    // the record was accessed that can be costly and is only
+    // worth doing if we are monitoring the database size.
+    if (maximumCacheSize) {
+        pendingWrite(resource, util::mapbox::canonicalURL(resource.url)).accessed = true;
+        scheduleFlush();
+    }
+}
+
 void SQLiteCache::put(const Resource& resource, const Response& response) {
     // Except for 404s, don't store errors in the cache.
     if (response.error && response.error->reason != Response::Error::Reason::NotFound) {
         return;
     }
 
+    const auto canonicalURL = util::mapbox::canonicalURL(resource.url);
     if (response.notModified) {
+        memory->refresh(canonicalURL, response.expires);
         thread->invoke(&Impl::refresh, resource, response.expires);
     } else {
+        memory->put(canonicalURL, response);
         thread->invoke(&Impl::put, resource, response);
     }
 }
 
 void SQLiteCache::Impl::put(const Resource& resource, const Response& response) {
-    try {
-        initializeDatabase();
-        pruneEntries();
+    if (response.data) {
+        auto entrySize = response.data->size();
+
+        if (entrySize > maximumCacheEntrySize) {
+            Log::Warning(Event::Database, "Entry too big for caching.");
+            return;
+        }
+
+        if (maximumCacheSize && entrySize > maximumCacheSize) {
+            Log::Warning(Event::Database, "Unable to make space for new entries.");
+            return;
+        }
+    }
+
+    auto& write = pendingWrite(resource, util::mapbox::canonicalURL(resource.url));
+    write.response = response;
+    write.refresh = false;
+    scheduleFlush();
+}
+
+void SQLiteCache::pin(const Resource& resource) {
+    thread->invoke(&Impl::setPinned, resource, true);
+}
+
+void SQLiteCache::unpin(const Resource& resource) {
+    thread->invoke(&Impl::setPinned, resource, false);
+}
+
+void SQLiteCache::Impl::setPinned(const Resource& resource, bool pinned) {
+    pendingWrite(resource, util::mapbox::canonicalURL(resource.url)).pinned = pinned;
+    scheduleFlush();
+}
+
+void SQLiteCache::Impl::refresh(const Resource& resource, optional<SystemTimePoint> expires) {
+    auto& write = pendingWrite(resource, util::mapbox::canonicalURL(resource.url));
+    if (write.response) {
+        // The entry hasn't been written yet; just update what will be written.
+        write.response->expires = expires;
+    } else {
+        write.refresh = true;
+        write.expires = expires;
+    }
+    scheduleFlush();
+}
+
+SQLiteCache::Impl::PendingWrite& SQLiteCache::Impl::pendingWrite(const Resource& resource, const std::string& canonicalURL) {
+    auto it = pendingWrites.find(canonicalURL);
+    if (it == pendingWrites.end()) {
+        it = pendingWrites.emplace(canonicalURL, PendingWrite { resource, pendingWriteSequence++ }).first;
+    }
+    return it->second;
+}
 
-        if (response.data) {
-            auto entrySize = response.data->size();
+void SQLiteCache::Impl::scheduleFlush() {
+    if (pendingWrites.size() >= writeBatchSize) {
+        flush();
+    } else if (!flushScheduled) {
+        if (!flushTimer) {
+            flushTimer = std::make_unique<util::Timer>();
+        }
+        flushTimer->start(writeBatchInterval, Duration::zero(), [this] { flush(); });
+        flushScheduled = true;
+    }
+}
+
+void SQLiteCache::Impl::flush() {
+    if (flushTimer) {
+        flushTimer->stop();
+    }
+    flushScheduled = false;
+
+    if (pendingWrites.empty()) {
+        return;
+    }
+
+    std::unordered_map<std::string, PendingWrite> batch;
+    batch.swap(pendingWrites);
+
+    // Apply the writes in the order they were queued, so that the `rowid`s of new entries keep
+    // the order in which pruning evicts entries that were accessed within the same second.
+    std::vector<std::pair<const std::string, PendingWrite>*> writes;
+    writes.reserve(batch.size());
+    for (auto& write : batch) {
+        writes.push_back(&write);
+    }
+    std::sort(writes.begin(), writes.end(), [](const auto* a, const auto* b) {
+        return a->second.sequence < b->second.sequence;
+    });
+
+    // A batch is committed in a single transaction. A single write doesn't need one.
+    bool transaction = false;
+    if (writes.size() > 1) {
+        try {
+            initializeDatabase();
+            db->exec("BEGIN");
+            transaction = true;
+        } catch (mapbox::sqlite::Exception& ex) {
+            Log::Error(Event::Database, ex.code, ex.what());
+        }
+    }
+
+    // Apply refreshes and pins first so that these entries don't get pruned.
+    for (const auto* write : writes) {
+        if (!write->second.response && (write->second.refresh || write->second.accessed)) {
+            refreshEntry(write->first, write->second);
+        }
 
-            if (entrySize > maximumCacheEntrySize) {
-                Log::Warning(Event::Database, "Entry too big for caching.");
-                return;
+        if (write->second.pinned) {
+            pinEntry(write->first, *write->second.pinned);
+        }
+    }
+
+    // Make room for the whole batch at once. The incoming entries are counted the way the
+    // `http_cache_size` triggers count them, less the entries they replace.
+    std::vector<std::pair<const std::pair<const std::string, PendingWrite>*, StoredData>> entries;
+    uint64_t incomingSize = 0;
+    uint64_t replacedSize = 0;
+    for (const auto* write : writes) {
+        if (write->second.response) {
+            try {
+                auto data = storedData(write->second.resource, *write->second.response);
+                incomingSize += write->first.size() + data.size;
+                replacedSize += storedEntrySize(write->first);
+                entries.emplace_back(write, std::move(data));
+            } catch (std::runtime_error& ex) {
+                Log::Error(Event::Database, "%s", ex.what());
             }
+        }
+    }
 
-            if (maximumCacheSize && entrySize + cacheSoftSize() > maximumCacheSize) {
-                Log::Warning(Event::Database, "Unable to make space for new entries.");
-                return;
+    if (!entries.empty()) {
+        pruneEntries(incomingSize > replacedSize ? incomingSize - replacedSize : 0);
+
+        for (const auto& entry : entries) {
+            const auto& write = *entry.first;
+            writeEntry(write.first, write.second.resource, *write.second.response, entry.second);
+        }
+    }
+
+    if (transaction) {
+        try {
+            db->exec("COMMIT");
+        } catch (mapbox::sqlite::Exception& ex) {
+            Log::Error(Event::Database, ex.code, ex.what());
+            try {
+                db->exec("ROLLBACK");
+            } catch (mapbox::sqlite::Exception&) {
+                // The transaction may already have been rolled back automatically.
             }
         }
+    }
+    if (vacuumPending) {
+        vacuumStep();
+    }
+}
+
+SQLiteCache::Impl::StoredData SQLiteCache::Impl::storedData(const Resource& resource, const Response& response) {
+    StoredData stored;
+    if (!response.data) {
+        return stored;
+    }
+
+    // Do not compress images, since they are typically compressed already.
+    if (resource.kind != Resource::SpriteImage) {
+        if (dictionaryCompression && resource.kind == Resource::Tile) {
+            stored.dictionaryID = tileDictionary(response);
+        }
+
+        auto data = util::compress(*response.data, dictionary(stored.dictionaryID));
+
+        // Store the compressed data when it is smaller than the original uncompressed data.
+        if (!data.empty() && data.size() < response.data->size()) {
+            stored.size = data.size();
+            stored.compressed = std::move(data);
+            return stored;
+        }
+    }
+
+    stored.dictionaryID = 0;
+    stored.size = response.data->size();
+    return stored;
+}
+
+uint64_t SQLiteCache::Impl::storedEntrySize(const std::string& canonicalURL) {
+    uint64_t entrySize = 0;
+
+    try {
+        initializeDatabase();
+
+        if (!entrySizeStmt) {
+            entrySizeStmt = std::make_unique<Statement>(db->prepare(
+                //                                                                               1
+                "SELECT LENGTH(`url`) + IFNULL(LENGTH(`data`), 0) FROM `http_cache` WHERE `url` = ?"));
+        } else {
+            entrySizeStmt->reset();
+        }
+
+        entrySizeStmt->bind(1, canonicalURL.c_str());
+        if (entrySizeStmt->run()) {
+            entrySize = entrySizeStmt->get<int64_t>(0);
+        }
+        entrySizeStmt->reset();
+    } catch (mapbox::sqlite::Exception& ex) {
+        Log::Error(Event::Database, ex.code, ex.what());
+    }
+
+    return entrySize;
+}
+
+void SQLiteCache::Impl::writeEntry(const std::string& canonicalURL, const Resource& resource, const Response& response, const StoredData& stored) {
+    try {
+        initializeDatabase();
+
+        // Delete the old entry first; REPLACE wouldn't update the total size.
+        if (!deleteStmt) {
+            //                                                                              1
+            deleteStmt = std::make_unique<Statement>(db->prepare("DELETE FROM `http_cache` WHERE `url` = ?"));
+        } else {
+            deleteStmt->reset();
+        }
+
+        deleteStmt->bind(1, canonicalURL.c_str());
+        deleteStmt->run();
+        sizeDirty = true;
+
+        // The replaced entry no longer counts towards the total size.
+        if (maximumCacheSize && canonicalURL.size() + stored.size + cacheSize() > maximumCacheSize) {
+            Log::Warning(Event::Database, "Unable to make space for new entries.");
+            return;
+        }
 
         if (!putStmt) {
-            putStmt = std::make_unique<Statement>(db->prepare("REPLACE INTO `http_cache` ("
+            putStmt = std::make_unique<Statement>(db->prepare("INSERT INTO `http_cache` ("
                 // 1        2       3         4         5         6          7         8          9
-                "`url`, `status`, `kind`, `modified`, `etag`, `expires`, `accessed`, `data`, `compressed`"
-                ") VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)"));
+                "`url`, `status`, `kind`, `modified`, `etag`, `expires`, `accessed`, `data`, `compressed`, "
+                //   10
+                "`dictionary`) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
         } else {
             putStmt->reset();
         }
 
-        const auto canonicalURL = util::mapbox::canonicalURL(resource.url);
         putStmt->bind(1 /* url */, canonicalURL.c_str());
         if (response.error) {
             putStmt->bind(2 /* status */, int(response.error->reason));
@@ -424,57 +775,150 @@ void SQLiteCache::Impl::put(const Resource& resource, const Response& response)
         putStmt->bind(6 /* expires */, response.expires);
         putStmt->bind(7 /* accessed */, SystemClock::now());
 
-        std::string data;
-        if (resource.kind != Resource::SpriteImage && response.data) {
-            // Do not compress images, since they are typically compressed already.
-            data = util::compress(*response.data);
-        }
-
-        if (!data.empty() && data.size() < response.data->size()) {
-            // Store the compressed data when it is smaller than the original
-            // uncompressed data.
-            putStmt->bind(8 /* data */, data, false); // do not retain the string internally.
+        if (stored.compressed) {
+            putStmt->bind(8 /* data */, *stored.compressed, false); // do not retain the string internally.
             putStmt->bind(9 /* compressed */, true);
+            putStmt->bind(10 /* dictionary */, stored.dictionaryID);
         } else if (response.data) {
             putStmt->bind(8 /* data */, *response.data, false); // do not retain the string internally.
             putStmt->bind(9 /* compressed */, false);
+            putStmt->bind(10 /* dictionary */, 0);
         } else {
             putStmt->bind(8 /* data */, "", false);
             putStmt->bind(9 /* compressed */, false);
+            putStmt->bind(10 /* dictionary */, 0);
         }
 
         putStmt->run();
-        softSizeDirty = true;
+        sizeDirty = true;
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
-    } catch (std::runtime_error& ex) {
-        Log::Error(Event::Database, "%s", ex.what());
     }
 }
 
-void SQLiteCache::Impl::refresh(const Resource& resource, optional<SystemTimePoint> expires) {
+void SQLiteCache::Impl::refreshEntry(const std::string& canonicalURL, const PendingWrite& write) {
+    try {
+        initializeDatabase();
+
+        if (write.refresh) {
+            if (!refreshStmt) {
+                refreshStmt = std::make_unique<Statement>(
+                    db->prepare("UPDATE `http_cache` SET "
+                        //            1              2               3
+                        "`accessed` = ?, `expires` = ? WHERE `url` = ?"));
+            } else {
+                refreshStmt->reset();
+            }
+
+            refreshStmt->bind(1, SystemClock::now());
+            refreshStmt->bind(2, write.expires);
+            refreshStmt->bind(3, canonicalURL.c_str());
+            refreshStmt->run();
+        } else {
+            if (!accessedStmt) {
+                accessedStmt = std::make_unique<Statement>(
+                    //                                                1               2
+                    db->prepare("UPDATE `http_cache` SET `accessed` = ? WHERE `url` = ?"));
+            } else {
+                accessedStmt->reset();
+            }
+
+            accessedStmt->bind(1, SystemClock::now());
+            accessedStmt->bind(2, canonicalURL.c_str());
+            accessedStmt->run();
+        }
+    } catch (mapbox::sqlite::Exception& ex) {
+        Log::Error(Event::Database, ex.code, ex.what());
+    }
+}
+
+void SQLiteCache::Impl::pinEntry(const std::string& canonicalURL, bool pinned) {
     try {
         initializeDatabase();
 
-        if (!refreshStmt) {
-            refreshStmt = std::make_unique<Statement>(
-                db->prepare("UPDATE `http_cache` SET "
-                    //            1              2               3
-                    "`accessed` = ?, `expires` = ? WHERE `url` = ?"));
+        auto& stmt = pinned ? pinStmt : unpinStmt;
+        if (!stmt) {
+            stmt = std::make_unique<Statement>(db->prepare(pinned
+                //                                                   1
+                ? "INSERT OR IGNORE INTO `http_cache_pinned` (`url`) VALUES(?)"
+                //                                                 1
+                : "DELETE FROM `http_cache_pinned` WHERE `url` = ?"));
         } else {
-            refreshStmt->reset();
+            stmt->reset();
         }
 
-        const auto canonicalURL = util::mapbox::canonicalURL(resource.url);
-        refreshStmt->bind(1, SystemClock::now());
-        refreshStmt->bind(2, expires);
-        refreshStmt->bind(3, canonicalURL.c_str());
-        refreshStmt->run();
+        stmt->bind(1, canonicalURL.c_str());
+        stmt->run();
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
     }
 }
 
+int64_t SQLiteCache::Impl::tileDictionary(const Response& response) {
+    try {
+        if (!currentDictionary) {
+            // Continue using the newest dictionary of the database, if there is one.
+            Statement stmt(db->prepare(
+                "SELECT `id`, `data` FROM `http_cache_dictionaries` ORDER BY `id` DESC LIMIT 1"));
+            if (stmt.run()) {
+                currentDictionary = stmt.get<int64_t>(0);
+                dictionaries.emplace(*currentDictionary, stmt.get<std::string>(1));
+            } else {
+                currentDictionary = 0;
+            }
+        }
+
+        if (*currentDictionary) {
+            return *currentDictionary;
+        }
+
+        dictionarySamples.push_back(response.data);
+        if (dictionarySamples.size() < kDictionarySampleCount) {
+            return 0;
+        }
+
+        std::string data = util::trainDictionary(dictionarySamples, kMaximumDictionarySize);
+        dictionarySamples.clear();
+        if (data.empty()) {
+            // The tiles have nothing in common; try again with the next ones.
+            return 0;
+        }
+
+        Statement stmt(db->prepare("INSERT INTO `http_cache_dictionaries` (`data`) VALUES(?)"));
+        stmt.bind(1, data, false);
+        stmt.run();
+
+        currentDictionary = db->lastInsertRowId();
+        dictionaries.emplace(*currentDictionary, std::move(data));
+        return *currentDictionary;
+    } catch (mapbox::sqlite::Exception& ex) {
+        Log::Error(Event::Database, ex.code, ex.what());
+        return 0;
+    }
+}
+
+const std::string& SQLiteCache::Impl::dictionary(int64_t id) {
+    auto it = dictionaries.find(id);
+    if (it != dictionaries.end()) {
+        return it->second;
+    }
+
+    if (!dictionaryStmt) {
+        dictionaryStmt = std::make_unique<Statement>(
+            //                                                                               1
+            db->prepare("SELECT `data` FROM `http_cache_dictionaries` WHERE `id` = ?"));
+    } else {
+        dictionaryStmt->reset();
+    }
+
+    dictionaryStmt->bind(1, id);
+    if (!dictionaryStmt->run()) {
+        throw std::runtime_error("missing compression dictionary");
+    }
+
+    return dictionaries.emplace(id, dictionaryStmt->get<std::string>(0)).first->second;
+}
+
 namespace {
 
 static std::mutex sharedMutex;
@@ -492,10 +936,12 @@ std::shared_ptr<SQLiteCache> SQLiteCache::getShared(const std::string &path) {
         cache = it->second.lock();
         if (!cache) {
             cache = std::make_shared<SQLiteCache>(path);
+            cache->setMaximumMemoryCacheSize(kDefaultMemoryCacheSize);
             it->second = cache;
         }
     } else {
         cache = std::make_shared<SQLiteCache>(path);
+        cache->setMaximumMemoryCacheSize(kDefaultMemoryCacheSize);
         shared.emplace(path, cache);
     }
 
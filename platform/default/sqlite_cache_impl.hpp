@@ -4,6 +4,11 @@
 #include <mbgl/storage/sqlite_cache.hpp>
 #include <mbgl/util/chrono.hpp>
 #include <mbgl/util/optional.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+
+#include <unordered_map>
+#include <vector>
 
 namespace mapbox {
 namespace sqlite {
@@ -14,31 +19,86 @@ class Statement;
 
 namespace mbgl {
 
+namespace util {
+class Timer;
+} // namespace util
+
 class SQLiteCache::Impl {
 public:
-    explicit Impl(const std::string &path = ":memory:");
+    // The default batch size of 1 writes every entry through immediately.
+    explicit Impl(const std::string &path = ":memory:",
+                  Duration writeBatchInterval = Duration::zero(),
+                  uint32_t writeBatchSize = 1);
     ~Impl();
 
     void setMaximumCacheSize(uint64_t size);
     void setMaximumCacheEntrySize(uint64_t size);
+    void setSynchronous(Synchronous);
+    void setWriteBatching(Duration interval, uint32_t size);
+    void setDictionaryCompression(bool);
 
     void get(const Resource&, Callback);
+    // Marks the entry as accessed, so that it isn't pruned before entries that weren't used since.
+    void touch(const Resource&);
     void put(const Resource&, const Response&);
     void refresh(const Resource&, optional<SystemTimePoint> expires);
+    void setPinned(const Resource&, bool pinned);
+
+    // Commits all queued writes.
+    void flush();
 
 private:
+    // A queued write. Without a response, this either refreshes the expiration
+    // date of an existing entry or only marks it as accessed.
+    struct PendingWrite {
+        PendingWrite(const Resource& resource_, uint64_t sequence_)
+            : resource(resource_), sequence(sequence_) {}
+
+        Resource resource;
+        uint64_t sequence;
+        optional<Response> response;
+        bool refresh = false;
+        optional<SystemTimePoint> expires;
+        bool accessed = false;
+        optional<bool> pinned;
+    };
+
+    PendingWrite& pendingWrite(const Resource&, const std::string& canonicalURL);
+    void scheduleFlush();
+    // The data of an entry the way it is stored in the database.
+    struct StoredData {
+        // Only set when compressing the data made it smaller.
+        optional<std::string> compressed;
+        int64_t dictionaryID = 0;
+        uint64_t size = 0;
+    };
+
+    StoredData storedData(const Resource&, const Response&);
+    // The size of an existing entry as the `http_cache_size` triggers count it, or 0.
+    uint64_t storedEntrySize(const std::string& canonicalURL);
+    void writeEntry(const std::string& canonicalURL, const Resource&, const Response&, const StoredData&);
+    void refreshEntry(const std::string& canonicalURL, const PendingWrite&);
+    void pinEntry(const std::string& canonicalURL, bool pinned);
+
+    // Returns the ID of the dictionary for compressing tiles, or 0 while none has been built yet.
+    int64_t tileDictionary(const Response&);
+    const std::string& dictionary(int64_t id);
+
     void initializeDatabase();
+    void configureDatabase();
 
-    int cachePageSize();
+    // The total size of all entries, which the database keeps up to date with triggers.
+    uint64_t cacheSize();
 
-    uint64_t cacheHardSize();
-    uint64_t cacheSoftSize();
+    uint64_t totalSize = 0;
+    bool sizeDirty = true;
 
-    uint64_t softSize = 0;
-    bool softSizeDirty = true;
+    // Deletes the least recently accessed entries that aren't pinned until the incoming
+    // entries fit.
+    void pruneEntries(uint64_t incomingSize = 0);
 
-    bool needsPruning();
-    void pruneEntries();
+    void vacuumStep();
+    bool vacuumPending = false;
 
     void createDatabase();
     void createSchema();
@@ -46,8 +106,6 @@ private:
     int schemaVersion() const;
     void ensureSchemaVersion();
 
-    int pageSize = 0;
-
     uint64_t maximumCacheSize;
     uint64_t maximumCacheEntrySize;
 
@@ -56,11 +114,31 @@ private:
     std::unique_ptr<::mapbox::sqlite::Statement> getStmt;
     std::unique_ptr<::mapbox::sqlite::Statement> putStmt;
     std::unique_ptr<::mapbox::sqlite::Statement> refreshStmt;
-    std::unique_ptr<::mapbox::sqlite::Statement> countStmt;
-    std::unique_ptr<::mapbox::sqlite::Statement> freeStmt;
+    std::unique_ptr<::mapbox::sqlite::Statement> sizeStmt;
+    std::unique_ptr<::mapbox::sqlite::Statement> pruneScanStmt;
     std::unique_ptr<::mapbox::sqlite::Statement> pruneStmt;
+    std::unique_ptr<::mapbox::sqlite::Statement> deleteStmt;
+    std::unique_ptr<::mapbox::sqlite::Statement> entrySizeStmt;
     std::unique_ptr<::mapbox::sqlite::Statement> accessedStmt;
+    std::unique_ptr<::mapbox::sqlite::Statement> pinStmt;
+    std::unique_ptr<::mapbox::sqlite::Statement> unpinStmt;
+    std::unique_ptr<::mapbox::sqlite::Statement> dictionaryStmt;
     bool schema = false;
+
+    std::unordered_map<std::string, PendingWrite> pendingWrites;
+    uint64_t pendingWriteSequence = 0;
+    std::unique_ptr<util::Timer> flushTimer;
+    bool flushScheduled = false;
+    Duration writeBatchInterval;
+    uint32_t writeBatchSize;
+
+    // Unless set, the database keeps SQLite's default rollback journal.
+    optional<Synchronous> synchronous;
+
+    bool dictionaryCompression = false;
+    optional<int64_t> currentDictionary;
+    std::unordered_map<int64_t, std::string> dictionaries { { 0, "" } }; // 0 is no dictionary.
+    std::vector<std::shared_ptr<const std::string>> dictionarySamples;
 };
 
 } // namespace mbgl
@@ -7,6 +7,7 @@
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/thread_context.hpp>
 
+#include <algorithm>
 #include <cstdlib>
 #include <cassert>
 #include <stdexcept>
@@ -68,6 +69,11 @@ public:
         return buffer;
     }
 
+    // Makes room for at least /count/ more elements, so that adding them doesn't reallocate.
+    void reserve(size_t count) {
+        grow(pos + count * itemSize);
+    }
+
     // Uploads the buffer to the GPU to be available when we need it.
     inline void upload() {
         if (!buffer) {
@@ -78,16 +84,7 @@ public:
 protected:
     // increase the buffer size by at least /required/ bytes.
     inline void *addElement() {
-        if (buffer != 0) {
-            throw std::runtime_error("Can't add elements after buffer was bound to GPU");
-        }
-        if (length < pos + itemSize) {
-            while (length < pos + itemSize) length += defaultLength;
-            array = realloc(array, length);
-            if (array == nullptr) {
-                throw std::runtime_error("Buffer reallocation failed");
-            }
-        }
+        grow(pos + itemSize);
         pos += itemSize;
         return reinterpret_cast<char *>(array) + (pos - itemSize);
     }
@@ -109,6 +106,22 @@ public:
     static const size_t itemSize = item_size;
 
 private:
+    // Grows the CPU buffer to hold at least /required/ bytes. The size at least doubles, so that
+    // filling a buffer element by element takes a logarithmic number of reallocations.
+    void grow(size_t required) {
+        if (buffer != 0) {
+            throw std::runtime_error("Can't add elements after buffer was bound to GPU");
+        }
+        if (length < required) {
+            length = std::max({ required, length * 2, size_t(defaultLength) });
+            GLvoid* grown = realloc(array, length);
+            if (grown == nullptr) {
+                throw std::runtime_error("Buffer reallocation failed");
+            }
+            array = grown;
+        }
+    }
+
     // CPU buffer
     GLvoid *array = nullptr;
 
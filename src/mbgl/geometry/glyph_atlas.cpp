@@ -14,66 +14,148 @@
 
 using namespace mbgl;
 
-GlyphAtlas::GlyphAtlas(uint16_t width_, uint16_t height_)
-    : width(width_),
-      height(height_),
-      bin(width_, height_),
+GlyphAtlas::Page::Page(uint16_t width_, uint16_t height_)
+    : bin(std::make_unique<BinPack<uint16_t>>(width_, height_)),
       data(std::make_unique<uint8_t[]>(width_ * height_)),
       dirty(true) {
 }
 
+GlyphAtlas::GlyphAtlas(uint16_t width_, uint16_t height_, std::size_t maxPages_)
+    : width(width_),
+      height(height_),
+      maxPages(maxPages_) {
+    assert(maxPages > 0);
+}
+
 GlyphAtlas::~GlyphAtlas() {
     assert(util::ThreadContext::currentlyOn(util::ThreadType::Map));
 
-    if (texture) {
-        mbgl::util::ThreadContext::getGLObjectStore()->abandonTexture(texture);
-        texture = 0;
+    for (auto& page : pages) {
+        if (page->texture) {
+            mbgl::util::ThreadContext::getGLObjectStore()->abandonTexture(page->texture);
+            page->texture = 0;
+        }
+    }
+}
+
+std::size_t GlyphAtlas::addGlyphs(uintptr_t tileUID,
+                                  const std::u32string& text,
+                                  const std::string& stackName,
+                                  const FontStack& fontStack,
+                                  GlyphPositions& face)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    // Use free space of the existing pages first, then a new page, and only then the space of
+    // glyphs that no tile uses anymore.
+    for (std::size_t i = 0; i < pages.size(); i++) {
+        if (addGlyphs(*pages[i], tileUID, text, stackName, fontStack, face, false, false)) {
+            return i;
+        }
+    }
+
+    if (pages.size() < maxPages) {
+        pages.push_back(std::make_unique<Page>(width, height));
+        if (addGlyphs(*pages.back(), tileUID, text, stackName, fontStack, face, false, false)) {
+            return pages.size() - 1;
+        }
     }
+
+    for (std::size_t i = 0; i < pages.size(); i++) {
+        if (addGlyphs(*pages[i], tileUID, text, stackName, fontStack, face, true, false)) {
+            return i;
+        }
+    }
+
+    // The glyphs don't fit into a single page, even without the glyphs that no tile uses.
+    Log::Error(Event::OpenGL, "glyph bitmap overflow");
+    addGlyphs(*pages.back(), tileUID, text, stackName, fontStack, face, true, true);
+    return pages.size() - 1;
 }
 
-void GlyphAtlas::addGlyphs(uintptr_t tileUID,
+bool GlyphAtlas::addGlyphs(Page& page,
+                           uintptr_t tileUID,
                            const std::u32string& text,
                            const std::string& stackName,
                            const FontStack& fontStack,
-                           GlyphPositions& face)
+                           GlyphPositions& face,
+                           bool evict,
+                           bool partial)
 {
-    std::lock_guard<std::mutex> lock(mtx);
-
     const std::map<uint32_t, SDFGlyph>& sdfs = fontStack.getSDFs();
+    Face& stackFace = page.index[stackName];
+
+    // The glyphs that were added to the page, and the glyphs in the page that this tile started
+    // to use, with the time they were released at. They are given back when not all glyphs fit.
+    std::vector<uint32_t> added;
+    std::vector<std::pair<uint32_t, uint64_t>> used;
 
     for (uint32_t chr : text)
     {
+        if (face.find(chr) != face.end()) {
+            // Labels repeat letters, and buckets pass the glyphs of all their labels at once.
+            continue;
+        }
+
         auto sdf_it = sdfs.find(chr);
         if (sdf_it == sdfs.end()) {
             continue;
         }
 
         const SDFGlyph& sdf = sdf_it->second;
-        Rect<uint16_t> rect = addGlyph(tileUID, stackName, sdf);
+        auto it = stackFace.find(sdf.id);
+
+        // The glyph is already in this page.
+        if (it != stackFace.end()) {
+            GlyphValue& value = it->second;
+            if (value.ids.insert(tileUID).second) {
+                used.emplace_back(sdf.id, value.releasedAt);
+            }
+            face.emplace(chr, Glyph{value.rect, sdf.metrics});
+            continue;
+        }
+
+        Rect<uint16_t> rect;
+        if (!addGlyph(page, sdf, evict, rect)) {
+            if (partial) {
+                continue;
+            }
+
+            for (uint32_t id : added) {
+                removeGlyph(page, stackFace, stackFace.find(id));
+            }
+            for (const auto& glyph : used) {
+                GlyphValue& value = stackFace.find(glyph.first)->second;
+                value.ids.erase(tileUID);
+                value.releasedAt = glyph.second;
+            }
+            face.clear();
+            return false;
+        }
+
+        // Glyphs without a bitmap don't take up space.
+        if (rect.hasArea()) {
+            stackFace.emplace(sdf.id, GlyphValue { rect, tileUID });
+            added.push_back(sdf.id);
+        }
         face.emplace(chr, Glyph{rect, sdf.metrics});
     }
+
+    return true;
 }
 
-Rect<uint16_t> GlyphAtlas::addGlyph(uintptr_t tileUID,
-                                    const std::string& stackName,
-                                    const SDFGlyph& glyph)
+bool GlyphAtlas::addGlyph(Page& page,
+                          const SDFGlyph& glyph,
+                          bool evict,
+                          Rect<uint16_t>& rect)
 {
     // Use constant value for now.
     const uint8_t buffer = 3;
 
-    std::map<uint32_t, GlyphValue>& face = index[stackName];
-    std::map<uint32_t, GlyphValue>::iterator it = face.find(glyph.id);
-
-    // The glyph is already in this texture.
-    if (it != face.end()) {
-        GlyphValue& value = it->second;
-        value.ids.insert(tileUID);
-        return value.rect;
-    }
-
     // The glyph bitmap has zero width.
     if (glyph.bitmap.empty()) {
-        return Rect<uint16_t>{ 0, 0, 0, 0 };
+        rect = Rect<uint16_t>{ 0, 0, 0, 0 };
+        return true;
     }
 
     uint16_t buffered_width = glyph.metrics.width + buffer * 2;
@@ -90,73 +172,140 @@ Rect<uint16_t> GlyphAtlas::addGlyph(uintptr_t tileUID,
     pack_width += (4 - pack_width % 4);
     pack_height += (4 - pack_height % 4);
 
-    Rect<uint16_t> rect = bin.allocate(pack_width, pack_height);
-    if (rect.w == 0) {
-        Log::Error(Event::OpenGL, "glyph bitmap overflow");
-        return rect;
+    rect = page.bin->allocate(pack_width, pack_height);
+    while (rect.w == 0) {
+        if (!evict || !evictGlyph(page)) {
+            return false;
+        }
+        rect = page.bin->allocate(pack_width, pack_height);
     }
 
     assert(rect.x + rect.w <= width);
     assert(rect.y + rect.h <= height);
 
-    face.emplace(glyph.id, GlyphValue { rect, tileUID });
-
     // Copy the bitmap
     const uint8_t* source = reinterpret_cast<const uint8_t*>(glyph.bitmap.data());
     for (uint32_t y = 0; y < buffered_height; y++) {
         uint32_t y1 = width * (rect.y + y + padding) + rect.x + padding;
         uint32_t y2 = buffered_width * y;
         for (uint32_t x = 0; x < buffered_width; x++) {
-            data[y1 + x] = source[y2 + x];
+            page.data[y1 + x] = source[y2 + x];
         }
     }
 
-    dirty = true;
+    page.dirty = true;
+
+    return true;
+}
+
+bool GlyphAtlas::evictGlyph(Page& page) {
+    Face* oldestFace = nullptr;
+    Face::iterator oldest;
+
+    for (auto& faces : page.index) {
+        Face& face = faces.second;
+        for (auto it = face.begin(); it != face.end(); ++it) {
+            const GlyphValue& value = it->second;
+            if (value.ids.empty() && (!oldestFace || value.releasedAt < oldest->second.releasedAt)) {
+                oldestFace = &face;
+                oldest = it;
+            }
+        }
+    }
+
+    if (!oldestFace) {
+        return false;
+    }
 
-    return rect;
+    removeGlyph(page, *oldestFace, oldest);
+    return true;
+}
+
+void GlyphAtlas::removeGlyph(Page& page, Face& face, Face::iterator it) {
+    const Rect<uint16_t>& rect = it->second.rect;
+
+    // Clear out the bitmap.
+    uint8_t *target = page.data.get();
+    for (uint32_t y = 0; y < rect.h; y++) {
+        uint32_t y1 = width * (rect.y + y) + rect.x;
+        for (uint32_t x = 0; x < rect.w; x++) {
+            target[y1 + x] = 0;
+        }
+    }
+
+    page.bin->release(rect);
+    face.erase(it);
+    page.dirty = true;
+
+    // The bin packer can't merge all free space again, so an empty page starts over.
+    const bool empty = std::all_of(page.index.begin(), page.index.end(), [](const auto& faces) {
+        return faces.second.empty();
+    });
+    if (empty) {
+        page.bin = std::make_unique<BinPack<uint16_t>>(width, height);
+    }
 }
 
 void GlyphAtlas::removeGlyphs(uintptr_t tileUID) {
     std::lock_guard<std::mutex> lock(mtx);
 
-    for (auto& faces : index) {
-        std::map<uint32_t, GlyphValue>& face = faces.second;
-        for (auto it = face.begin(); it != face.end(); /* we advance in the body */) {
-            GlyphValue& value = it->second;
-            value.ids.erase(tileUID);
-
-            if (value.ids.empty()) {
-                const Rect<uint16_t>& rect = value.rect;
-
-                // Clear out the bitmap.
-                uint8_t *target = data.get();
-                for (uint32_t y = 0; y < rect.h; y++) {
-                    uint32_t y1 = width * (rect.y + y) + rect.x;
-                    for (uint32_t x = 0; x < rect.w; x++) {
-                        target[y1 + x] = 0;
-                    }
+    // Glyphs that no tile uses anymore stay until their space is needed.
+    for (auto& page : pages) {
+        for (auto& faces : page->index) {
+            for (auto& glyph : faces.second) {
+                GlyphValue& value = glyph.second;
+                if (value.ids.erase(tileUID) && value.ids.empty()) {
+                    value.releasedAt = ++releases;
                 }
+            }
+        }
+    }
+}
 
-                bin.release(rect);
+std::vector<GlyphAtlas::PageUsage> GlyphAtlas::getPageUsage() {
+    std::lock_guard<std::mutex> lock(mtx);
 
-                // Make sure to post-increment the iterator: This will return the
-                // current iterator, but will go to the next position before we
-                // erase the element from the map. That way, the iterator stays
-                // valid.
-                face.erase(it++);
-            } else {
-                ++it;
+    const float area = float(width) * height;
+    std::vector<PageUsage> usage;
+    for (const auto& page : pages) {
+        PageUsage pageUsage { 0, 0, 0, 0 };
+        for (const auto& faces : page->index) {
+            for (const auto& glyph : faces.second) {
+                const GlyphValue& value = glyph.second;
+                const float glyphArea = float(value.rect.w) * value.rect.h / area;
+                if (value.ids.empty()) {
+                    pageUsage.released++;
+                    pageUsage.releasedOccupancy += glyphArea;
+                } else {
+                    pageUsage.glyphs++;
+                    pageUsage.occupancy += glyphArea;
+                }
             }
         }
+        usage.push_back(pageUsage);
+    }
+    return usage;
+}
+
+void GlyphAtlas::dumpDebugLogs() {
+    const auto usage = getPageUsage();
+    for (std::size_t i = 0; i < usage.size(); i++) {
+        Log::Info(Event::General, "GlyphAtlas::page %u: %u glyphs (%.0f%%), %u released (%.0f%%)",
+                  unsigned(i), unsigned(usage[i].glyphs), usage[i].occupancy * 100,
+                  unsigned(usage[i].released), usage[i].releasedOccupancy * 100);
     }
 }
 
 void GlyphAtlas::upload() {
-    if (dirty) {
-        const bool first = !texture;
-        bind();
+    std::lock_guard<std::mutex> lock(mtx);
 
-        std::lock_guard<std::mutex> lock(mtx);
+    for (auto& page : pages) {
+        if (!page->dirty) {
+            continue;
+        }
+
+        const bool first = !page->texture;
+        bind(*page);
 
         if (first) {
             MBGL_CHECK_ERROR(glTexImage2D(
@@ -168,7 +317,7 @@ void GlyphAtlas::upload() {
                 0, // GLint border
                 GL_ALPHA, // GLenum format
                 GL_UNSIGNED_BYTE, // GLenum type
-                data.get() // const GLvoid* data
+                page->data.get() // const GLvoid* data
             ));
         } else {
             MBGL_CHECK_ERROR(glTexSubImage2D(
@@ -180,22 +329,37 @@ void GlyphAtlas::upload() {
                 height, // GLsizei height
                 GL_ALPHA, // GLenum format
                 GL_UNSIGNED_BYTE, // GLenum type
-                data.get() // const GLvoid* data
+                page->data.get() // const GLvoid* data
             ));
         }
 
-        dirty = false;
+        page->dirty = false;
 
 #if defined(DEBUG)
-        // platform::showDebugImage("Glyph Atlas", reinterpret_cast<char*>(data.get()), width, height);
+        // platform::showDebugImage("Glyph Atlas", reinterpret_cast<char*>(page->data.get()), width, height);
 #endif
     }
 }
 
-void GlyphAtlas::bind() {
-    if (!texture) {
-        MBGL_CHECK_ERROR(glGenTextures(1, &texture));
-        MBGL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, texture));
+void GlyphAtlas::bind(std::size_t index) {
+    Page* page = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (index < pages.size()) {
+            page = pages[index].get();
+        }
+    }
+
+    // Pages live as long as the atlas; there is none yet when no glyphs were added.
+    if (page) {
+        bind(*page);
+    }
+}
+
+void GlyphAtlas::bind(Page& page) {
+    if (!page.texture) {
+        MBGL_CHECK_ERROR(glGenTextures(1, &page.texture));
+        MBGL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, page.texture));
 #ifndef GL_ES_VERSION_2_0
         MBGL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
 #endif
@@ -204,6 +368,6 @@ void GlyphAtlas::bind() {
         MBGL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
         MBGL_CHECK_ERROR(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
     } else {
-        MBGL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, texture));
+        MBGL_CHECK_ERROR(glBindTexture(GL_TEXTURE_2D, page.texture));
     }
 };
@@ -9,32 +9,56 @@
 #include <string>
 #include <set>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <atomic>
+#include <vector>
 
 namespace mbgl {
 
+// Glyphs are stored in pages of the same size, each with a texture of its own. A new page is added
+// when the glyphs of a bucket don't fit into the existing pages, up to `maxPages`.
+//
+// Glyphs that no tile uses anymore stay in their page, so that tiles that come back don't have to
+// add them again, until their space is needed. Then the glyphs that were released first go first.
 class GlyphAtlas : public util::noncopyable {
 public:
-    GlyphAtlas(uint16_t width, uint16_t height);
+    GlyphAtlas(uint16_t width, uint16_t height, std::size_t maxPages = 4);
     ~GlyphAtlas();
 
-    void addGlyphs(uintptr_t tileUID,
-                   const std::u32string& text,
-                   const std::string& stackName,
-                   const FontStack&,
-                   GlyphPositions&);
+    // Adds the glyphs of `text` to a page under a single lock, and their positions to `face`, which
+    // starts out empty. All glyphs of a face are on the page that is returned.
+    std::size_t addGlyphs(uintptr_t tileUID,
+                          const std::u32string& text,
+                          const std::string& stackName,
+                          const FontStack&,
+                          GlyphPositions&);
     void removeGlyphs(uintptr_t tileUID);
 
-    // Binds the atlas texture to the GPU, and uploads data if it is out of date.
-    void bind();
+    // Binds the texture of the page to the GPU.
+    void bind(std::size_t page);
 
-    // Uploads the texture to the GPU to be available when we need it. This is a lazy operation;
-    // the texture is only bound when the data is out of date (=dirty).
+    // Uploads the textures to the GPU to be available when we need it. This is a lazy operation;
+    // a texture is only bound when its data is out of date (=dirty).
     void upload();
 
+    struct PageUsage {
+        // The number of glyphs in the page that tiles use, and that no tile uses anymore.
+        std::size_t glyphs;
+        std::size_t released;
+
+        // The part of the page that these glyphs cover, from 0 to 1.
+        float occupancy;
+        float releasedOccupancy;
+    };
+
+    std::vector<PageUsage> getPageUsage();
+
+    void dumpDebugLogs();
+
     const GLsizei width;
     const GLsizei height;
+    const std::size_t maxPages;
 
 private:
     struct GlyphValue {
@@ -42,18 +66,41 @@ private:
             : rect(rect_), ids({ id }) {}
         Rect<uint16_t> rect;
         std::set<uintptr_t> ids;
+
+        // When the last tile that used this glyph released it; only valid when `ids` is empty.
+        uint64_t releasedAt = 0;
+    };
+
+    using Face = std::map<uint32_t, GlyphValue>;
+
+    struct Page {
+        Page(uint16_t width, uint16_t height);
+
+        std::unique_ptr<BinPack<uint16_t>> bin;
+        std::map<std::string, Face> index;
+        const std::unique_ptr<uint8_t[]> data;
+        std::atomic<bool> dirty;
+        GLuint texture = 0;
     };
 
-    Rect<uint16_t> addGlyph(uintptr_t tileID,
-                            const std::string& stackName,
-                            const SDFGlyph&);
+    // Adds all glyphs to the page, or none unless `partial` is set. Released glyphs are evicted to
+    // make room if `evict` is set.
+    bool addGlyphs(Page&, uintptr_t tileUID, const std::u32string& text, const std::string& stackName,
+                   const FontStack&, GlyphPositions&, bool evict, bool partial);
+
+    // Finds room for the glyph in the page and copies its bitmap there.
+    bool addGlyph(Page&, const SDFGlyph&, bool evict, Rect<uint16_t>&);
+
+    // Evicts the glyph of the page that was released first. Returns false when there is none.
+    bool evictGlyph(Page&);
+
+    void removeGlyph(Page&, Face&, Face::iterator);
+
+    void bind(Page&);
 
     std::mutex mtx;
-    BinPack<uint16_t> bin;
-    std::map<std::string, std::map<uint32_t, GlyphValue>> index;
-    const std::unique_ptr<uint8_t[]> data;
-    std::atomic<bool> dirty;
-    GLuint texture = 0;
+    std::vector<std::unique_ptr<Page>> pages;
+    uint64_t releases = 0;
 };
 
 } // namespace mbgl
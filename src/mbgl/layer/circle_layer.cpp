@@ -1,7 +1,6 @@
 #include <mbgl/layer/circle_layer.hpp>
 #include <mbgl/style/style_bucket_parameters.hpp>
 #include <mbgl/renderer/circle_bucket.hpp>
-#include <mbgl/util/get_geometries.hpp>
 
 namespace mbgl {
 
@@ -42,14 +41,8 @@ bool CircleLayer::recalculate(const StyleCalculationParameters& parameters) {
     return hasTransitions;
 }
 
-std::unique_ptr<Bucket> CircleLayer::createBucket(StyleBucketParameters& parameters) const {
-    auto bucket = std::make_unique<CircleBucket>();
-
-    parameters.eachFilteredFeature(filter, [&] (const auto& feature) {
-        bucket->addGeometry(getGeometries(feature));
-    });
-
-    return std::move(bucket);
+std::unique_ptr<Bucket> CircleLayer::createBucket(StyleBucketParameters&) const {
+    return std::make_unique<CircleBucket>();
 }
 
 } // namespace mbgl
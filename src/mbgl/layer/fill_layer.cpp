@@ -1,7 +1,6 @@
 #include <mbgl/layer/fill_layer.hpp>
 #include <mbgl/style/style_bucket_parameters.hpp>
 #include <mbgl/renderer/fill_bucket.hpp>
-#include <mbgl/util/get_geometries.hpp>
 
 namespace mbgl {
 
@@ -55,14 +54,8 @@ bool FillLayer::recalculate(const StyleCalculationParameters& parameters) {
     return hasTransitions;
 }
 
-std::unique_ptr<Bucket> FillLayer::createBucket(StyleBucketParameters& parameters) const {
-    auto bucket = std::make_unique<FillBucket>();
-
-    parameters.eachFilteredFeature(filter, [&] (const auto& feature) {
-        bucket->addGeometry(getGeometries(feature));
-    });
-
-    return std::move(bucket);
+std::unique_ptr<Bucket> FillLayer::createBucket(StyleBucketParameters&) const {
+    return std::make_unique<FillBucket>();
 }
 
 } // namespace mbgl
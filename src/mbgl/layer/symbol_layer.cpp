@@ -163,7 +163,12 @@ std::unique_ptr<Bucket> SymbolLayer::createBucket(StyleBucketParameters& paramet
     bucket->layout.icon.size.calculate(StyleCalculationParameters(p.z + 1));
     bucket->layout.text.size.calculate(StyleCalculationParameters(p.z + 1));
 
-    bucket->parseFeatures(parameters.layer, filter);
+    return std::move(bucket);
+}
+
+void SymbolLayer::finishBucket(Bucket& bucket_, StyleBucketParameters& parameters) const {
+    auto bucket = static_cast<SymbolBucket*>(&bucket_);
+    bucket->finishFeatures();
 
     if (bucket->needsDependencies(parameters.glyphStore, parameters.spriteStore)) {
         parameters.partialParse = true;
@@ -179,8 +184,6 @@ std::unique_ptr<Bucket> SymbolLayer::createBucket(StyleBucketParameters& paramet
                             parameters.glyphAtlas,
                             parameters.glyphStore);
     }
-
-    return std::move(bucket);
 }
 
 } // namespace mbgl
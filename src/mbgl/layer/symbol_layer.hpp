@@ -93,6 +93,7 @@ public:
     bool recalculate(const StyleCalculationParameters&) override;
 
     std::unique_ptr<Bucket> createBucket(StyleBucketParameters&) const override;
+    void finishBucket(Bucket&, StyleBucketParameters&) const override;
 
     SymbolLayoutProperties layout;
     SymbolPaintProperties paint;
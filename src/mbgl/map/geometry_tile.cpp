@@ -4,6 +4,43 @@
 
 namespace mbgl {
 
+namespace {
+
+class ExpressionFilter : public GeometryTileFilter {
+public:
+    ExpressionFilter(const FilterExpression& expression_)
+        : expression(expression_) {}
+
+    bool operator()(const GeometryTileFeature& feature) override {
+        return evaluate(expression, GeometryTileFeatureExtractor(feature));
+    }
+
+private:
+    const FilterExpression& expression;
+};
+
+} // namespace
+
+void GeometryTileLayer::eachFeature(const std::function<bool (const GeometryTileFeature&)>& function) const {
+    for (std::size_t i = 0; i < featureCount(); i++) {
+        if (!function(*getFeature(i))) {
+            return;
+        }
+    }
+}
+
+std::unique_ptr<GeometryTileFilter> GeometryTileLayer::compileFilter(const FilterExpression& expression) const {
+    return std::make_unique<ExpressionFilter>(expression);
+}
+
+void GeometryTileLayer::eachFilteredFeature(const FilterExpression& expression,
+                                            const std::function<bool (const GeometryTileFeature&)>& function) const {
+    auto filter = compileFilter(expression);
+    eachFeature([&](const GeometryTileFeature& feature) {
+        return !(*filter)(feature) || function(feature);
+    });
+}
+
 optional<Value> GeometryTileFeatureExtractor::getValue(const std::string& key) const {
     if (key == "$type") {
         return Value(uint64_t(feature.getType()));
@@ -4,6 +4,7 @@
 #include <mapbox/variant.hpp>
 
 #include <mbgl/style/value.hpp>
+#include <mbgl/style/filter_expression.hpp>
 #include <mbgl/util/chrono.hpp>
 #include <mbgl/util/ptr.hpp>
 #include <mbgl/util/vec.hpp>
@@ -33,6 +34,20 @@ public:
     virtual optional<Value> getValue(const std::string& key) const = 0;
     virtual GeometryCollection getGeometries() const = 0;
     virtual uint32_t getExtent() const = 0;
+
+    // Like getGeometries(), but decodes into `geometries`. Implementations may reuse the storage
+    // of the rings that are already there.
+    virtual void readGeometries(GeometryCollection& geometries) const {
+        geometries = getGeometries();
+    }
+};
+
+// A filter expression that has been prepared for the features of one layer. It must only be
+// called with features of that layer.
+class GeometryTileFilter : private util::noncopyable {
+public:
+    virtual ~GeometryTileFilter() = default;
+    virtual bool operator()(const GeometryTileFeature&) = 0;
 };
 
 class GeometryTileLayer : private util::noncopyable {
@@ -40,6 +55,17 @@ public:
     virtual ~GeometryTileLayer() = default;
     virtual std::size_t featureCount() const = 0;
     virtual util::ptr<const GeometryTileFeature> getFeature(std::size_t) const = 0;
+
+    // Calls the function with every feature until it returns false. The feature is only valid
+    // during the call, which lets implementations decode features without allocating them.
+    virtual void eachFeature(const std::function<bool (const GeometryTileFeature&)>&) const;
+
+    // Prepares a filter for the features of this layer.
+    virtual std::unique_ptr<GeometryTileFilter> compileFilter(const FilterExpression&) const;
+
+    // Like eachFeature(), but skips the features that don't match the filter.
+    void eachFilteredFeature(const FilterExpression&,
+                             const std::function<bool (const GeometryTileFeature&)>&) const;
 };
 
 class GeometryTile : private util::noncopyable {
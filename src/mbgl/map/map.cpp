@@ -16,12 +16,13 @@
 
 namespace mbgl {
 
-Map::Map(View& view_, FileSource& fileSource, MapMode mapMode, GLContextMode contextMode, ConstrainMode constrainMode)
+Map::Map(View& view_, FileSource& fileSource, MapMode mapMode, GLContextMode contextMode, ConstrainMode constrainMode,
+         std::size_t workerThreadCount)
     : view(view_),
       transform(std::make_unique<Transform>(view, constrainMode)),
       context(std::make_unique<util::Thread<MapContext>>(
         util::ThreadContext{"Map", util::ThreadType::Map, util::ThreadPriority::Regular},
-        view, fileSource, mapMode, contextMode, view.getPixelRatio())),
+        view, fileSource, mapMode, contextMode, view.getPixelRatio(), workerThreadCount)),
       data(&context->invokeSync<MapData&>(&MapContext::getData))
 {
     view.initialize(this);
@@ -95,6 +96,13 @@ void Map::update(Update flags) {
     if (flags & Update::Dimensions) {
         transform->resize(view.getSize());
     }
+
+    auto path = transform->getTransitionPath();
+    if (path != prefetchPath) {
+        prefetchPath = path;
+        context->invoke(&MapContext::setPrefetchPath, path);
+    }
+
     context->invoke(&MapContext::triggerUpdate, transform->getState(), flags);
 }
 
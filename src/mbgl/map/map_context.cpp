@@ -27,9 +27,10 @@
 
 namespace mbgl {
 
-MapContext::MapContext(View& view_, FileSource& fileSource, MapMode mode_, GLContextMode contextMode_, const float pixelRatio_)
+MapContext::MapContext(View& view_, FileSource& fileSource, MapMode mode_, GLContextMode contextMode_, const float pixelRatio_,
+                       std::size_t workerThreadCount_)
     : view(view_),
-      dataPtr(std::make_unique<MapData>(mode_, contextMode_, pixelRatio_)),
+      dataPtr(std::make_unique<MapData>(mode_, contextMode_, pixelRatio_, workerThreadCount_)),
       data(*dataPtr),
       asyncUpdate([this] { update(); }),
       asyncInvalidate([&view_] { view_.invalidate(); }),
@@ -86,6 +87,11 @@ void MapContext::triggerUpdate(const TransformState& state, const Update flags)
     asyncUpdate.send();
 }
 
+void MapContext::setPrefetchPath(std::shared_ptr<const std::vector<TransformState>> path) {
+    prefetchPath = path;
+    prefetchPathChanged = true;
+}
+
 void MapContext::setStyleURL(const std::string& url) {
     if (styleURL == url) {
         return;
@@ -183,6 +189,13 @@ void MapContext::update() {
 
     style->update(transformState, *texturePool);
 
+    // Replace the prefetch requests only after the sources requested the tiles they need now,
+    // so that requests for tiles that the camera has arrived at aren't interrupted.
+    if (prefetchPathChanged && data.mode == MapMode::Continuous) {
+        style->prefetch(prefetchPath ? *prefetchPath : std::vector<TransformState>());
+        prefetchPathChanged = false;
+    }
+
     if (data.mode == MapMode::Continuous) {
         asyncInvalidate.send();
     } else if (callback && style->isLoaded()) {
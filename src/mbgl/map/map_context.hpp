@@ -29,7 +29,8 @@ struct FrameData {
 
 class MapContext : public Style::Observer {
 public:
-    MapContext(View&, FileSource&, MapMode, GLContextMode, const float pixelRatio);
+    MapContext(View&, FileSource&, MapMode, GLContextMode, const float pixelRatio,
+               std::size_t workerThreadCount = 0);
     ~MapContext();
 
     MapData& getData() { return data; }
@@ -37,6 +38,10 @@ public:
     void pause();
 
     void triggerUpdate(const TransformState&, Update = Update::Nothing);
+
+    // Loads the tiles along an animated camera path with low priority, replacing the previous
+    // path. nullptr cancels prefetching.
+    void setPrefetchPath(std::shared_ptr<const std::vector<TransformState>>);
     void renderStill(const TransformState&, const FrameData&, Map::StillImageCallback callback);
 
     // Triggers a synchronous render. Returns true if style has been fully loaded.
@@ -99,6 +104,9 @@ private:
     size_t sourceCacheSize;
     TransformState transformState;
     FrameData frameData;
+
+    std::shared_ptr<const std::vector<TransformState>> prefetchPath;
+    bool prefetchPathChanged = false;
 };
 
 } // namespace mbgl
@@ -20,10 +20,12 @@ class MapData {
     using Lock = std::lock_guard<std::mutex>;
 
 public:
-    inline MapData(MapMode mode_, GLContextMode contextMode_, const float pixelRatio_)
+    inline MapData(MapMode mode_, GLContextMode contextMode_, const float pixelRatio_,
+                   std::size_t workerThreadCount_ = 0)
         : mode(mode_)
         , contextMode(contextMode_)
         , pixelRatio(pixelRatio_)
+        , workerThreadCount(workerThreadCount_)
         , annotationManager(pixelRatio)
         , animationTime(Duration::zero())
         , defaultFadeDuration(mode_ == MapMode::Continuous ? Milliseconds(300) : Duration::zero())
@@ -131,6 +133,9 @@ public:
     const GLContextMode contextMode;
     const float pixelRatio;
 
+    // The number of threads the style parses tiles on; zero uses one per hardware thread.
+    const std::size_t workerThreadCount;
+
 private:
     mutable std::mutex annotationManagerMutex;
     AnnotationManager annotationManager;
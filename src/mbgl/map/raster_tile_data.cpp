@@ -50,7 +50,7 @@ RasterTileData::RasterTileData(const TileID& id_,
         }
 
         workRequest.reset();
-        workRequest = worker.parseRasterTile(std::make_unique<RasterBucket>(texturePool), res.data, [this, callback] (RasterTileParseResult result) {
+        workRequest = worker.parseRasterTile(priority, std::make_unique<RasterBucket>(texturePool), res.data, [this, callback] (RasterTileParseResult result) {
             workRequest.reset();
             if (state != State::loaded) {
                 return;
@@ -86,3 +86,10 @@ void RasterTileData::cancel() {
     req = nullptr;
     workRequest.reset();
 }
+
+void RasterTileData::setRequestPriority(double priority_) {
+    priority = priority_;
+    if (req) {
+        req->setPriority(priority);
+    }
+}
@@ -22,6 +22,7 @@ public:
     ~RasterTileData();
 
     void cancel() override;
+    void setRequestPriority(double) override;
     Bucket* getBucket(StyleLayer const &layer_desc) override;
 
 private:
@@ -30,6 +31,7 @@ private:
     std::unique_ptr<FileRequest> req;
     std::unique_ptr<Bucket> bucket;
     std::unique_ptr<WorkRequest> workRequest;
+    double priority = 0;
 };
 
 } // namespace mbgl
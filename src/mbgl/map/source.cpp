@@ -21,6 +21,7 @@
 #include <mbgl/util/token.hpp>
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/tile_cover.hpp>
+#include <mbgl/util/worker.hpp>
 
 #include <mbgl/map/vector_tile_data.hpp>
 #include <mbgl/map/raster_tile_data.hpp>
@@ -36,6 +37,20 @@
 #include <algorithm>
 #include <sstream>
 
+namespace {
+
+// Prefetched tiles are requested after all tiles that are currently needed.
+const double kPrefetchPriority = 1000;
+
+// Limits the number of tiles along a long camera path; the first ones are the most important.
+const size_t kMaximumPrefetchedTiles = 100;
+
+// Labels are placed again when the angle or the pitch of the map changes by this much, so that
+// rotating the map doesn't place every tile on every frame.
+const float kPlacementStep = M_PI / 90;
+
+} // namespace
+
 namespace mbgl {
 
 Source::Source(SourceType type_,
@@ -158,6 +173,7 @@ void Source::load() {
             tileDataMap.clear();
             tiles.clear();
             cache.clear();
+            decodedTiles.clear();
         }
 
         loaded = true;
@@ -276,7 +292,10 @@ TileData::State Source::addTile(const TileID& tileID, const StyleUpdateParameter
             std::unique_ptr<GeometryTileMonitor> monitor;
 
             if (type == SourceType::Vector) {
-                monitor = std::make_unique<VectorTileMonitor>(normalizedID, parameters.pixelRatio, info->tiles.at(0));
+                // Tiles at the maximum zoom level share their decoded data with the overscaled
+                // tiles above them.
+                monitor = std::make_unique<VectorTileMonitor>(normalizedID, parameters.pixelRatio, info->tiles.at(0),
+                                                              normalizedID.sourceZ == info->maxZoom ? &decodedTiles : nullptr);
             } else if (type == SourceType::Annotations) {
                 monitor = std::make_unique<AnnotationTileMonitor>(normalizedID, parameters.data);
             } else if (type == SourceType::GeoJSON) {
@@ -343,6 +362,48 @@ std::forward_list<TileID> Source::coveringTiles(const TransformState& state) con
     return covering_tiles;
 }
 
+void Source::prefetch(const std::vector<TransformState>& path, float pixelRatio) {
+    std::map<TileID, std::unique_ptr<FileRequest>> requests;
+
+    if (loaded && (type == SourceType::Vector || type == SourceType::Raster) && !info->tiles.empty()) {
+        FileSource* fs = util::ThreadContext::getFileSource();
+        double priority = kPrefetchPriority;
+
+        for (const auto& state : path) {
+            for (const auto& tileID : coveringTiles(state)) {
+                if (requests.size() >= kMaximumPrefetchedTiles) {
+                    break;
+                }
+
+                // Skip tiles that are already loaded or loading, and the placeholder that
+                // coveringTiles() returns below the minimum zoom level.
+                const TileID normalizedID = tileID.normalized();
+                if (normalizedID.sourceZ < info->minZoom || requests.count(normalizedID) || tileDataMap.count(normalizedID) ||
+                    cache.has(normalizedID.to_uint64())) {
+                    continue;
+                }
+
+                std::unique_ptr<FileRequest> request;
+                auto it = prefetchRequests.find(normalizedID);
+                if (it != prefetchRequests.end()) {
+                    request = std::move(it->second);
+                } else {
+                    // The response only needs to end up in the cache.
+                    request = fs->request(Resource::tile(info->tiles.at(0), pixelRatio, normalizedID.x,
+                                                         normalizedID.y, normalizedID.sourceZ),
+                                          [](Response) {});
+                }
+
+                request->setPriority(priority++);
+                requests.emplace(normalizedID, std::move(request));
+            }
+        }
+    }
+
+    // Releasing the remaining requests cancels them.
+    prefetchRequests.swap(requests);
+}
+
 /**
  * Recursively find children of the given tile that are already loaded.
  *
@@ -413,10 +474,20 @@ bool Source::update(const StyleUpdateParameters& parameters) {
     // parent or child tiles that are *already* loaded.
     std::forward_list<TileID> retain(required);
 
+    // The required tiles are sorted by distance from the viewport center. Their position in that
+    // order is their priority, both for pending downloads and for parsing, so that the center of
+    // the viewport loads first.
+    double priority = 0;
+
     // Add existing child/parent tiles if the actual tile is not yet loaded
     for (const auto& tileID : required) {
         TileData::State state = hasTile(tileID);
 
+        auto it = tiles.find(tileID);
+        if (it != tiles.end()) {
+            it->second->data->setRequestPriority(priority);
+        }
+
         switch (state) {
         case TileData::State::partial:
             if (parameters.shouldReparsePartialTiles) {
@@ -427,10 +498,14 @@ bool Source::update(const StyleUpdateParameters& parameters) {
             break;
         case TileData::State::invalid:
             state = addTile(tileID, parameters);
+            if (state == TileData::State::loading) {
+                tiles.at(tileID)->data->setRequestPriority(priority);
+            }
             break;
         default:
             break;
         }
+        priority++;
 
         if (!TileData::isReadyState(state)) {
             // The tile we require is not yet loaded. Try to find a parent or
@@ -461,11 +536,16 @@ bool Source::update(const StyleUpdateParameters& parameters) {
     // Remove tiles that we definitely don't need, i.e. tiles that are not on
     // the required list.
     std::set<TileID> retain_data;
-    util::erase_if(tiles, [this, &retain, &retain_data, &tileCache](std::pair<const TileID, std::unique_ptr<Tile>> &pair) {
+    util::erase_if(tiles, [this, &required, &retain, &retain_data, &tileCache](std::pair<const TileID, std::unique_ptr<Tile>> &pair) {
         Tile &tile = *pair.second;
         bool obsolete = std::find(retain.begin(), retain.end(), tile.id) == retain.end();
         if (!obsolete) {
             retain_data.insert(tile.data->id);
+
+            // Parents and children that only fill in for missing tiles yield to the required tiles.
+            if (std::find(required.begin(), required.end(), tile.id) == required.end()) {
+                tile.data->setRequestPriority(kBackgroundWorkPriority);
+            }
         } else if (type != SourceType::Raster && tile.data->getState() == TileData::State::parsed) {
             // Partially parsed tiles are never added to the cache because otherwise
             // they never get updated if the go out from the viewport and the pending
@@ -495,12 +575,14 @@ bool Source::update(const StyleUpdateParameters& parameters) {
 
     updateTilePtrs();
 
+    const PlacementConfig config = PlacementConfig(parameters.transformState.getAngle(),
+                                                   parameters.transformState.getPitch(),
+                                                   parameters.debugOptions & MapDebugOptions::Collision)
+                                       .quantized(kPlacementStep);
     for (auto& tilePtr : tilePtrs) {
-        tilePtr->data->redoPlacement(
-            { parameters.transformState.getAngle(), parameters.transformState.getPitch(), parameters.debugOptions & MapDebugOptions::Collision },
-            [this]() {
-                observer->onPlacementRedone();
-            });
+        tilePtr->data->redoPlacement(config, [this]() {
+            observer->onPlacementRedone();
+        });
     }
 
     updated = parameters.animationTime;
@@ -521,6 +603,7 @@ void Source::setCacheSize(size_t size) {
 
 void Source::onLowMemory() {
     cache.clear();
+    decodedTiles.clear();
 }
 
 void Source::setObserver(Observer* observer_) {
@@ -2,6 +2,7 @@
 #define MBGL_MAP_SOURCE
 
 #include <mbgl/map/tile_cache.hpp>
+#include <mbgl/map/vector_tile.hpp>
 #include <mbgl/map/source_info.hpp>
 
 #include <mbgl/util/mat4.hpp>
@@ -59,6 +60,11 @@ public:
     // new data available that a tile in the "partial" state might be interested at.
     bool update(const StyleUpdateParameters&);
 
+    // Requests the tiles covering the given camera states with low priority, so that they are
+    // in the cache by the time they're needed. Requests for tiles that are no longer in the list
+    // are canceled.
+    void prefetch(const std::vector<TransformState>&, float pixelRatio);
+
     void updateMatrices(const mat4 &projMatrix, const TransformState &transform);
     void drawClippingMasks(Painter &painter);
     void finishRender(Painter &painter);
@@ -72,6 +78,9 @@ public:
     void setObserver(Observer* observer);
     void dumpDebugLogs() const;
 
+    // The tile information of this source, or nullptr while it is still being loaded.
+    const SourceInfo* getInfo() const { return info.get(); }
+
     const SourceType type;
     const std::string id;
     const std::string url;
@@ -102,12 +111,16 @@ private:
     // Stores the time when this source was most recently updated.
     TimePoint updated = TimePoint::min();
 
+    // Outlives the tiles, whose monitors refer to it.
+    DecodedTileCache decodedTiles;
+
     std::map<TileID, std::unique_ptr<Tile>> tiles;
     std::vector<Tile*> tilePtrs;
     std::map<TileID, std::weak_ptr<TileData>> tileDataMap;
     TileCache cache;
 
     std::unique_ptr<FileRequest> req;
+    std::map<TileID, std::unique_ptr<FileRequest>> prefetchRequests;
 
     Observer nullObserver;
     Observer* observer = &nullObserver;
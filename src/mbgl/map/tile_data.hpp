@@ -82,6 +82,10 @@ public:
     virtual void redoPlacement(PlacementConfig, const std::function<void()>&) {}
     virtual void redoPlacement(const std::function<void()>&) {}
 
+    // Forwards the request priority to the pending FileRequest of this tile, if any, and uses it
+    // for the work this tile queues from now on. Lower values are more urgent.
+    virtual void setRequestPriority(double) {}
+
     bool isReady() const {
         return isReadyState(state);
     }
@@ -12,10 +12,22 @@
 #include <mbgl/platform/log.hpp>
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/exception.hpp>
+#include <mbgl/util/get_geometries.hpp>
+#include <mbgl/util/thread_pool.hpp>
+
+#include <algorithm>
+#include <map>
 #include <utility>
 
 using namespace mbgl;
 
+namespace {
+
+// The distance outside of the tile, in pixels, where filled and stroked geometries are cut off.
+const float kClipBufferPixels = 128;
+
+} // namespace
+
 TileWorker::TileWorker(TileID id_,
                        std::string sourceID_,
                        SpriteStore& spriteStore_,
@@ -50,15 +62,20 @@ TileParseResult TileWorker::parseAllLayers(std::vector<std::unique_ptr<StyleLaye
     // We're storing a set of bucket names we've parsed to avoid parsing a bucket twice that is
     // referenced from more than one layer
     std::set<std::string> parsed;
+    std::vector<const StyleLayer*> styleLayers;
 
     for (auto i = layers.rbegin(); i != layers.rend(); i++) {
         const StyleLayer* layer = i->get();
         if (parsed.find(layer->bucketName()) == parsed.end()) {
             parsed.emplace(layer->bucketName());
-            parseLayer(layer, *geometryTile);
+            if (needsParsing(layer)) {
+                styleLayers.push_back(layer);
+            }
         }
     }
 
+    parseLayers(styleLayers, *geometryTile);
+
     result.state = pending.empty() ? TileData::State::parsed : TileData::State::partial;
 
     if (result.state == TileData::State::parsed) {
@@ -112,45 +129,39 @@ void TileWorker::redoPlacement(
     const std::unordered_map<std::string, std::unique_ptr<Bucket>>* buckets,
     PlacementConfig config) {
 
-    CollisionTile collisionTile(config);
+    if (collisionTile) {
+        collisionTile->reset(config);
+    } else {
+        collisionTile = std::make_unique<CollisionTile>(config);
+    }
 
     for (auto i = layers.rbegin(); i != layers.rend(); i++) {
         const auto it = buckets->find((*i)->id);
         if (it != buckets->end()) {
-            it->second->placeFeatures(collisionTile);
+            it->second->placeFeatures(*collisionTile);
         }
     }
 }
 
-void TileWorker::parseLayer(const StyleLayer* layer, const GeometryTile& geometryTile) {
-    // Cancel early when parsing.
-    if (state == TileData::State::obsolete)
-        return;
-
+bool TileWorker::needsParsing(const StyleLayer* layer) const {
     // Background and custom layers are special cases.
     if (layer->is<BackgroundLayer>() || layer->is<CustomLayer>())
-        return;
+        return false;
 
     // Skip this bucket if we are to not render this
     if ((layer->source != sourceID) ||
         (id.z < std::floor(layer->minZoom)) ||
         (id.z >= std::ceil(layer->maxZoom)) ||
         (layer->visibility == VisibilityType::None)) {
-        return;
+        return false;
     }
 
-    auto geometryLayer = geometryTile.getLayer(layer->sourceLayer);
-    if (!geometryLayer) {
-        // The layer specified in the bucket does not exist. Do nothing.
-        if (debug::tileParseWarnings) {
-            Log::Warning(Event::ParseTile, "layer '%s' does not exist in tile %d/%d/%d",
-                    layer->sourceLayer.c_str(), id.z, id.x, id.y);
-        }
-        return;
-    }
+    return true;
+}
 
+void TileWorker::parseLayers(const std::vector<const StyleLayer*>& styleLayers,
+                             const GeometryTile& geometryTile) {
     StyleBucketParameters parameters(id,
-                                     *geometryLayer,
                                      state,
                                      reinterpret_cast<uintptr_t>(this),
                                      partialParse,
@@ -159,17 +170,103 @@ void TileWorker::parseLayer(const StyleLayer* layer, const GeometryTile& geometr
                                      glyphStore,
                                      mode);
 
-    std::unique_ptr<Bucket> bucket = layer->createBucket(parameters);
+    // Group the style layers by their source layer, so that the features of every source layer
+    // are read, filtered and decoded once for all buckets that use them.
+    std::map<std::string, std::vector<std::size_t>> sourceLayers;
+    for (std::size_t i = 0; i < styleLayers.size(); i++) {
+        sourceLayers[styleLayers[i]->sourceLayer].push_back(i);
+    }
 
-    if (layer->is<SymbolLayer>()) {
-        if (partialParse) {
-            // We cannot parse this bucket yet. Instead, we're saving it for later.
-            pending.emplace_back(layer->as<SymbolLayer>(), std::move(bucket));
+    std::vector<std::unique_ptr<Bucket>> buckets(styleLayers.size());
+
+    // Look up the source layers and create their buckets up front. Creating a bucket may update
+    // the shared parameters, such as `partialParse`, so it isn't safe to do from several threads.
+    std::vector<std::pair<util::ptr<GeometryTileLayer>, const std::vector<std::size_t>*>> groups;
+    for (const auto& sourceLayer : sourceLayers) {
+        auto geometryLayer = geometryTile.getLayer(sourceLayer.first);
+        if (!geometryLayer) {
+            // The layer specified in the bucket does not exist. Do nothing.
+            if (debug::tileParseWarnings) {
+                Log::Warning(Event::ParseTile, "layer '%s' does not exist in tile %d/%d/%d",
+                        sourceLayer.first.c_str(), id.z, id.x, id.y);
+            }
+            continue;
+        }
+
+        for (const auto i : sourceLayer.second) {
+            buckets[i] = styleLayers[i]->createBucket(parameters);
+        }
+        groups.emplace_back(geometryLayer, &sourceLayer.second);
+    }
+
+    // Start with the source layers that feed the most buckets, since they take longest.
+    std::stable_sort(groups.begin(), groups.end(), [] (const auto& a, const auto& b) {
+        return a.second->size() > b.second->size();
+    });
+
+    // Fills and lines are clipped a fixed number of pixels outside of the tile. The buffer of the
+    // source tile grows with the overscaling, so overscaled tiles drop most of it.
+    const int16_t clipBuffer = kClipBufferPixels * util::EXTENT / (util::tileSize * id.overscaling);
+
+    if (geometryStorage.size() < groups.size()) {
+        geometryStorage.resize(groups.size());
+    }
+
+    // Every source layer only touches its own buckets, so they can be filled on several threads
+    // of the worker pool at once.
+    util::ThreadPool::parallel(groups.size(), [&] (std::size_t group) {
+        // Cancel early when parsing.
+        if (parameters.cancelled())
+            return;
+
+        const GeometryTileLayer& geometryLayer = *groups[group].first;
+
+        std::vector<std::pair<Bucket*, std::unique_ptr<GeometryTileFilter>>> filters;
+        for (const auto i : *groups[group].second) {
+            if (buckets[i]) {
+                filters.emplace_back(buckets[i].get(), geometryLayer.compileFilter(styleLayers[i]->filter));
+            }
+        }
+
+        geometryLayer.eachFeature([&](const GeometryTileFeature& feature) {
+            if (parameters.cancelled())
+                return false;
+
+            FeatureGeometries geometries(feature, clipBuffer, geometryStorage[group]);
+            for (const auto& filter : filters) {
+                if ((*filter.second)(feature)) {
+                    filter.first->addFeature(feature, geometries);
+                }
+            }
+            return true;
+        });
+    });
+
+    // Finish the buckets in layer order. Once a symbol layer is missing glyphs or icons, the
+    // symbol layers after it don't add their features either, so that text collisions respect
+    // the layer order.
+    for (std::size_t i = 0; i < styleLayers.size(); i++) {
+        if (parameters.cancelled())
+            return;
+
+        const StyleLayer* layer = styleLayers[i];
+        std::unique_ptr<Bucket> bucket = std::move(buckets[i]);
+        if (!bucket) {
+            continue;
+        }
+
+        layer->finishBucket(*bucket, parameters);
+
+        if (layer->is<SymbolLayer>()) {
+            if (partialParse) {
+                // We cannot parse this bucket yet. Instead, we're saving it for later.
+                pending.emplace_back(layer->as<SymbolLayer>(), std::move(bucket));
+            } else {
+                placementPending.emplace(layer->bucketName(), std::move(bucket));
+            }
         } else {
-            placementPending.emplace(layer->bucketName(), std::move(bucket));
+            insertBucket(layer->bucketName(), std::move(bucket));
         }
-    } else {
-        insertBucket(layer->bucketName(), std::move(bucket));
     }
 }
 
@@ -7,6 +7,7 @@
 #include <mbgl/map/tile_data.hpp>
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/ptr.hpp>
+#include <mbgl/util/get_geometries.hpp>
 #include <mbgl/text/placement_config.hpp>
 
 #include <string>
@@ -59,7 +60,8 @@ public:
                        PlacementConfig);
 
 private:
-    void parseLayer(const StyleLayer*, const GeometryTile&);
+    bool needsParsing(const StyleLayer*) const;
+    void parseLayers(const std::vector<const StyleLayer*>&, const GeometryTile&);
     void insertBucket(const std::string& name, std::unique_ptr<Bucket>);
     void placeLayers(PlacementConfig);
 
@@ -86,6 +88,13 @@ private:
 
     // Temporary holder
     TileParseResultBuckets result;
+
+    // Scratch space for decoding the features of each source layer that is parsed at once. It's
+    // kept from one parse to the next.
+    std::vector<FeatureGeometries::Storage> geometryStorage;
+
+    // Reused for every placement, so that its index keeps its memory.
+    std::unique_ptr<CollisionTile> collisionTile;
 };
 
 } // namespace mbgl
@@ -16,6 +16,9 @@
 
 using namespace mbgl;
 
+/** The number of camera states along an animated transition that tiles are prefetched for. */
+static const int kTransitionPathSamples = 8;
+
 /** Converts the given angle (in radians) to be numerically close to the anchor angle, allowing it to be interpolated properly without sudden jumps. */
 static double _normalizeAngle(double angle, double anchorAngle)
 {
@@ -616,6 +619,7 @@ void Transform::startTransition(const CameraOptions& camera,
     };
 
     transitionFinishFn = [isAnimated, animation, this] {
+        transitionPath.reset();
         state.panning = false;
         state.scaling = false;
         state.rotating = false;
@@ -627,6 +631,20 @@ void Transform::startTransition(const CameraOptions& camera,
     
     if (!isAnimated) {
         transitionFrameFn(Clock::now());
+    } else {
+        // Evaluate the frames ahead of time, starting with the destination, then restore the
+        // current state.
+        const TransformState current = state;
+        auto path = std::make_shared<std::vector<TransformState>>();
+        for (int i = 0; i < kTransitionPathSamples; ++i) {
+            frame(i == 0 ? 1.0 : double(i) / kTransitionPathSamples);
+            if (_validPoint(anchor)) {
+                state.moveLatLng(anchorLatLng, anchor);
+            }
+            path->push_back(state);
+        }
+        state = current;
+        transitionPath = std::move(path);
     }
 }
 
@@ -12,6 +12,8 @@
 #include <cstdint>
 #include <cmath>
 #include <functional>
+#include <memory>
+#include <vector>
 
 namespace mbgl {
 
@@ -125,6 +127,11 @@ public:
     Update updateTransitions(const TimePoint& now);
     void cancelTransitions();
 
+    /** Returns camera states sampled along the current animated transition, starting with its
+        destination, or nullptr if no animation is in progress. A new path is returned for every
+        transition, so that tiles along it can be loaded ahead of the camera. */
+    std::shared_ptr<const std::vector<TransformState>> getTransitionPath() const { return transitionPath; }
+
     // Gesture
     void setGestureInProgress(bool);
     bool isGestureInProgress() const { return state.isGestureInProgress(); }
@@ -155,6 +162,7 @@ private:
     Duration transitionDuration;
     std::function<Update(const TimePoint)> transitionFrameFn;
     std::function<void()> transitionFinishFn;
+    std::shared_ptr<const std::vector<TransformState>> transitionPath;
 };
 
 } // namespace mbgl
@@ -1,10 +1,14 @@
 #include <mbgl/map/vector_tile.hpp>
+#include <mbgl/map/vector_tile_filter.hpp>
 #include <mbgl/map/source.hpp>
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/response.hpp>
 #include <mbgl/storage/file_source.hpp>
+#include <mbgl/util/run_loop.hpp>
 #include <mbgl/util/thread_context.hpp>
 #include <mbgl/util/url.hpp>
+#include <mbgl/util/varint.hpp>
+#include <mbgl/util/work_request.hpp>
 
 #include <utility>
 
@@ -64,7 +68,7 @@ optional<Value> VectorTileFeature::getValue(const std::string& key) const {
     while (tags) {
         uint32_t tag_key = tags.varint();
 
-        if (layer.keys.size() <= tag_key) {
+        if (layer.keyCount <= tag_key) {
             throw std::runtime_error("feature referenced out of range key");
         }
 
@@ -86,20 +90,51 @@ optional<Value> VectorTileFeature::getValue(const std::string& key) const {
 }
 
 GeometryCollection VectorTileFeature::getGeometries() const {
-    pbf data(geometry_pbf);
+    GeometryCollection lines;
+    readGeometries(lines);
+    return lines;
+}
+
+void VectorTileFeature::readGeometries(GeometryCollection& lines) const {
+    // Commands and parameters are decoded in batches, so that runs of short varints are decoded
+    // several at a time.
+    const std::size_t kBatchSize = 128;
+    uint32_t values[kBatchSize];
+    std::size_t available = 0;
+    std::size_t index = 0;
+    const uint8_t* data = geometry_pbf.data;
+    auto next = [&] {
+        if (index == available) {
+            available = util::decodeVarints(data, geometry_pbf.end, values, kBatchSize);
+            index = 0;
+            if (available == 0) {
+                throw pbf::unterminated_varint_exception();
+            }
+        }
+        return values[index++];
+    };
+
     uint8_t cmd = 1;
     uint32_t length = 0;
     int32_t x = 0;
     int32_t y = 0;
 
-    GeometryCollection lines;
+    // Lines are decoded into the ones that are already there, so that they keep their capacity.
+    std::size_t count = 0;
+    auto nextLine = [&] {
+        if (count == lines.size()) {
+            lines.emplace_back();
+        }
+        std::vector<Coordinate>* reused = &lines[count++];
+        reused->clear();
+        return reused;
+    };
 
-    lines.emplace_back();
-    std::vector<Coordinate>* line = &lines.back();
+    std::vector<Coordinate>* line = nextLine();
 
-    while (data.data < data.end) {
+    while (index < available || data < geometry_pbf.end) {
         if (length == 0) {
-            uint32_t cmd_length = data.varint();
+            uint32_t cmd_length = next();
             cmd = cmd_length & 0x7;
             length = cmd_length >> 3;
         }
@@ -107,12 +142,11 @@ GeometryCollection VectorTileFeature::getGeometries() const {
         --length;
 
         if (cmd == 1 || cmd == 2) {
-            x += data.svarint();
-            y += data.svarint();
+            x += util::zigzag32(next());
+            y += util::zigzag32(next());
 
             if (cmd == 1 && !line->empty()) { // moveTo
-                lines.emplace_back();
-                line = &lines.back();
+                line = nextLine();
             }
 
             line->emplace_back(x, y);
@@ -127,7 +161,7 @@ GeometryCollection VectorTileFeature::getGeometries() const {
         }
     }
 
-    return lines;
+    lines.resize(count);
 }
 
 uint32_t VectorTileFeature::getExtent() const {
@@ -139,22 +173,37 @@ VectorTile::VectorTile(std::shared_ptr<const std::string> data_)
 }
 
 util::ptr<GeometryTileLayer> VectorTile::getLayer(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex);
+
     if (!parsed) {
+        // Only read the layer names; length-delimited fields like features are skipped without
+        // looking at their contents.
         parsed = true;
         pbf tile_pbf(reinterpret_cast<const unsigned char *>(data->c_str()), data->size());
         while (tile_pbf.next()) {
             if (tile_pbf.tag == 3) { // layer
-                util::ptr<VectorTileLayer> layer = std::make_shared<VectorTileLayer>(tile_pbf.message());
-                layers.emplace(layer->name, layer);
+                pbf layer_pbf = tile_pbf.message();
+                layers.push_back({ "", layer_pbf, nullptr });
+                while (layer_pbf.next()) {
+                    if (layer_pbf.tag == 1) { // name
+                        layers.back().name = layer_pbf.string();
+                        break;
+                    }
+                    layer_pbf.skip();
+                }
             } else {
                 tile_pbf.skip();
             }
         }
     }
 
-    auto layer_it = layers.find(name);
-    if (layer_it != layers.end()) {
-        return layer_it->second;
+    for (auto& layer : layers) {
+        if (layer.name == name) {
+            if (!layer.layer) {
+                layer.layer = std::make_shared<VectorTileLayer>(layer.data);
+            }
+            return layer.layer;
+        }
     }
 
     return nullptr;
@@ -162,12 +211,11 @@ util::ptr<GeometryTileLayer> VectorTile::getLayer(const std::string& name) const
 
 VectorTileLayer::VectorTileLayer(pbf layer_pbf) {
     while (layer_pbf.next()) {
-        if (layer_pbf.tag == 1) { // name
-            name = layer_pbf.string();
-        } else if (layer_pbf.tag == 2) { // feature
+        if (layer_pbf.tag == 2) { // feature
             features.push_back(layer_pbf.message());
         } else if (layer_pbf.tag == 3) { // keys
-            keys.emplace(layer_pbf.string(), keys.size());
+            // Duplicate keys keep their first index, but still take up an index.
+            keys.emplace(layer_pbf.string(), keyCount++);
         } else if (layer_pbf.tag == 4) { // values
             values.emplace_back(parseValue(layer_pbf.message()));
         } else if (layer_pbf.tag == 5) { // extent
@@ -182,20 +230,124 @@ util::ptr<const GeometryTileFeature> VectorTileLayer::getFeature(std::size_t i)
     return std::make_shared<VectorTileFeature>(features.at(i), *this);
 }
 
-VectorTileMonitor::VectorTileMonitor(const TileID& tileID_, float pixelRatio_, const std::string& urlTemplate_)
+void VectorTileLayer::eachFeature(const std::function<bool (const GeometryTileFeature&)>& function) const {
+    for (const auto& feature : features) {
+        if (!function(VectorTileFeature(feature, *this))) {
+            return;
+        }
+    }
+}
+
+std::unique_ptr<GeometryTileFilter> VectorTileLayer::compileFilter(const FilterExpression& expression) const {
+    return std::make_unique<VectorTileFilter>(expression, *this);
+}
+
+namespace {
+
+// Hands a decoded tile that is shared with other tiles to a single TileWorker.
+class SharedVectorTile : public GeometryTile {
+public:
+    SharedVectorTile(std::shared_ptr<const VectorTile> tile_)
+        : tile(std::move(tile_)) {}
+
+    util::ptr<GeometryTileLayer> getLayer(const std::string& name) const override {
+        return tile->getLayer(name);
+    }
+
+private:
+    const std::shared_ptr<const VectorTile> tile;
+};
+
+uint64_t sourceKey(const TileID& id) {
+    return TileID { id.sourceZ, id.x, id.y, id.sourceZ }.to_uint64();
+}
+
+} // namespace
+
+void DecodedTileCache::add(const TileID& id, Entry entry) {
+    const uint64_t key = sourceKey(id);
+    entries.remove_if([&] (const auto& pair) { return pair.first == key; });
+    entries.emplace_front(key, std::move(entry));
+
+    while (entries.size() > size) {
+        entries.pop_back();
+    }
+}
+
+const DecodedTileCache::Entry* DecodedTileCache::get(const TileID& id) {
+    const uint64_t key = sourceKey(id);
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        if (it->first == key) {
+            // Move the entry to the front, so that it is evicted last.
+            entries.splice(entries.begin(), entries, it);
+            return &entries.front().second;
+        }
+    }
+    return nullptr;
+}
+
+namespace {
+
+class DecodedTileRequest : public FileRequest {
+public:
+    DecodedTileRequest(std::unique_ptr<WorkRequest> reply_, std::unique_ptr<FileRequest> request_)
+        : reply(std::move(reply_)),
+          request(std::move(request_)) {
+    }
+
+    void setPriority(double priority) override {
+        request->setPriority(priority);
+    }
+
+    // Replies with the decoded tile.
+    std::unique_ptr<WorkRequest> reply;
+
+    // Revalidates the tile like for any other tile.
+    std::unique_ptr<FileRequest> request;
+};
+
+} // namespace
+
+VectorTileMonitor::VectorTileMonitor(const TileID& tileID_, float pixelRatio_, const std::string& urlTemplate_,
+                                     DecodedTileCache* decodedTiles_)
     : tileID(tileID_),
       pixelRatio(pixelRatio_),
-      urlTemplate(urlTemplate_) {
+      urlTemplate(urlTemplate_),
+      decodedTiles(decodedTiles_) {
 }
 
 std::unique_ptr<FileRequest> VectorTileMonitor::monitorTile(const GeometryTileMonitor::Callback& callback) {
+    // Overscaled tiles reuse the decoded tile when it is still around. They still request the
+    // tile below, so that they are revalidated and replaced like any other tile.
+    std::unique_ptr<WorkRequest> reply;
+    if (decodedTiles && tileID.z > tileID.sourceZ) {
+        if (auto entry = decodedTiles->get(tileID)) {
+            // Still reply asynchronously, like a file source would, so that the tile data is
+            // set up and has its priority before it starts parsing.
+            reusedData = entry->data;
+            reply = util::RunLoop::Get()->invokeCancellable(
+                [callback, this, tile = entry->tile, modified = entry->modified, expires = entry->expires] {
+                    // Skip it if the file source already replied with other data.
+                    if (reusedData) {
+                        callback(nullptr, std::make_unique<SharedVectorTile>(tile), modified, expires);
+                    }
+                });
+        }
+    }
+
     const Resource resource = Resource::tile(urlTemplate, pixelRatio, tileID.x, tileID.y, tileID.sourceZ);
-    return util::ThreadContext::getFileSource()->request(resource, [callback, this](Response res) {
+    auto request = util::ThreadContext::getFileSource()->request(resource, [callback, this](Response res) {
         if (res.notModified) {
             // We got the same data again. Abort early.
             return;
         }
 
+        if (reusedData && res.data && *res.data == *reusedData) {
+            // The reused tile was decoded from the same data.
+            return;
+        }
+        reusedData.reset();
+
         if (res.error) {
             if (res.error->reason == Response::Error::Reason::NotFound) {
                 callback(nullptr, nullptr, res.modified, res.expires);
@@ -206,8 +358,20 @@ std::unique_ptr<FileRequest> VectorTileMonitor::monitorTile(const GeometryTileMo
             }
         }
 
-        callback(nullptr, std::make_unique<VectorTile>(res.data), res.modified, res.expires);
+        if (!decodedTiles) {
+            callback(nullptr, std::make_unique<VectorTile>(res.data), res.modified, res.expires);
+            return;
+        }
+
+        auto tile = std::make_shared<const VectorTile>(res.data);
+        decodedTiles->add(tileID, { tile, res.modified, res.expires, res.data });
+        callback(nullptr, std::make_unique<SharedVectorTile>(tile), res.modified, res.expires);
     });
+
+    if (reply) {
+        return std::make_unique<DecodedTileRequest>(std::move(reply), std::move(request));
+    }
+    return request;
 }
 
 } // namespace mbgl
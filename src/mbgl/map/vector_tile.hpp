@@ -5,7 +5,9 @@
 #include <mbgl/map/tile_id.hpp>
 #include <mbgl/util/pbf.hpp>
 
-#include <map>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 namespace mbgl {
 
@@ -19,8 +21,11 @@ public:
     optional<Value> getValue(const std::string&) const override;
     GeometryCollection getGeometries() const override;
     uint32_t getExtent() const override;
+    void readGeometries(GeometryCollection&) const override;
 
 private:
+    friend class VectorTileFilter;
+
     const VectorTileLayer& layer;
     uint64_t id = 0;
     FeatureType type = FeatureType::Unknown;
@@ -34,14 +39,16 @@ public:
 
     std::size_t featureCount() const override { return features.size(); }
     util::ptr<const GeometryTileFeature> getFeature(std::size_t) const override;
+    void eachFeature(const std::function<bool (const GeometryTileFeature&)>&) const override;
+    std::unique_ptr<GeometryTileFilter> compileFilter(const FilterExpression&) const override;
 
 private:
-    friend class VectorTile;
     friend class VectorTileFeature;
+    friend class VectorTileFilter;
 
-    std::string name;
     uint32_t extent = 4096;
-    std::map<std::string, uint32_t> keys;
+    std::unordered_map<std::string, uint32_t> keys;
+    uint32_t keyCount = 0;
     std::vector<Value> values;
     std::vector<pbf> features;
 };
@@ -50,19 +57,53 @@ class VectorTile : public GeometryTile {
 public:
     VectorTile(std::shared_ptr<const std::string> data);
 
+    // Safe to call from several threads, so that overscaled tiles can share a decoded tile.
     util::ptr<GeometryTileLayer> getLayer(const std::string&) const override;
 
 private:
+    // Layers are only decoded once they're requested; until then, only their names are known.
+    struct Layer {
+        std::string name;
+        pbf data;
+        util::ptr<GeometryTileLayer> layer;
+    };
+
     std::shared_ptr<const std::string> data;
+    mutable std::mutex mutex;
     mutable bool parsed = false;
-    mutable std::map<std::string, util::ptr<GeometryTileLayer>> layers;
+    mutable std::vector<Layer> layers;
 };
 
-class TileID;
+// Keeps the most recently decoded tiles at the maximum zoom level of a source. Overscaled tiles
+// cover the same area as the tile at the maximum zoom level, so they share its decoded tile
+// instead of requesting and decoding it again.
+class DecodedTileCache {
+public:
+    struct Entry {
+        std::shared_ptr<const VectorTile> tile;
+        optional<SystemTimePoint> modified;
+        optional<SystemTimePoint> expires;
+        // The data the tile was decoded from.
+        std::shared_ptr<const std::string> data;
+    };
+
+    DecodedTileCache(std::size_t size_ = 8) : size(size_) {}
+
+    // Tiles are keyed by the tile they were loaded from, regardless of their overscaling.
+    void add(const TileID&, Entry);
+    const Entry* get(const TileID&);
+    void clear() { entries.clear(); }
+
+private:
+    const std::size_t size;
+    std::list<std::pair<uint64_t, Entry>> entries;
+};
 
 class VectorTileMonitor : public GeometryTileMonitor {
 public:
-    VectorTileMonitor(const TileID&, float pixelRatio, const std::string& urlTemplate);
+    // Tiles at the maximum zoom level of the source pass a cache to share their decoded tile.
+    VectorTileMonitor(const TileID&, float pixelRatio, const std::string& urlTemplate,
+                      DecodedTileCache* = nullptr);
 
     std::unique_ptr<FileRequest> monitorTile(const GeometryTileMonitor::Callback&) override;
 
@@ -70,6 +111,10 @@ private:
     TileID tileID;
     float pixelRatio;
     std::string urlTemplate;
+    DecodedTileCache* decodedTiles;
+
+    // The data of the decoded tile this tile reused, until the file source replies with other data.
+    std::shared_ptr<const std::string> reusedData;
 };
 
 } // namespace mbgl
@@ -58,7 +58,7 @@ VectorTileData::VectorTileData(const TileID& id_,
         // when tile data changed. Replacing the workdRequest will cancel a pending work
         // request in case there is one.
         workRequest.reset();
-        workRequest = worker.parseGeometryTile(tileWorker, style.getLayers(), std::move(tile), targetConfig, [callback, this, config = targetConfig] (TileParseResult result) {
+        workRequest = worker.parseGeometryTile(priority, tileWorker, style.getLayers(), std::move(tile), targetConfig, [callback, this, config = targetConfig] (TileParseResult result) {
             workRequest.reset();
             if (state == State::obsolete) {
                 return;
@@ -98,7 +98,7 @@ bool VectorTileData::parsePending(std::function<void(std::exception_ptr)> callba
     }
 
     workRequest.reset();
-    workRequest = worker.parsePendingGeometryTileLayers(tileWorker, targetConfig, [this, callback, config = targetConfig] (TileParseResult result) {
+    workRequest = worker.parsePendingGeometryTileLayers(priority, tileWorker, targetConfig, [this, callback, config = targetConfig] (TileParseResult result) {
         workRequest.reset();
         if (state == State::obsolete) {
             return;
@@ -144,16 +144,37 @@ void VectorTileData::redoPlacement(const PlacementConfig newConfig, const std::f
     if (newConfig != placedConfig) {
         targetConfig = newConfig;
 
+        // Rotating back and forth keeps coming back to the same configurations. Their render data
+        // is still around, so there's no need to place the labels on a worker again.
+        if (!workRequest && restorePlacement(newConfig)) {
+            callback();
+            return;
+        }
+
         redoPlacement(callback);
     }
 }
 
+bool VectorTileData::restorePlacement(const PlacementConfig& config) {
+    for (const auto& bucket : buckets) {
+        if (!bucket.second->hasPlacement(config)) {
+            return false;
+        }
+    }
+
+    for (auto& bucket : buckets) {
+        bucket.second->restorePlacement(config);
+    }
+    placedConfig = config;
+    return true;
+}
+
 void VectorTileData::redoPlacement(const std::function<void()>& callback) {
     // Don't start a new placement request when the current one hasn't completed yet, or when
     // we are parsing buckets.
     if (workRequest) return;
 
-    workRequest = worker.redoPlacement(tileWorker, buckets, targetConfig, [this, callback, config = targetConfig] {
+    workRequest = worker.redoPlacement(priority, tileWorker, buckets, targetConfig, [this, callback, config = targetConfig] {
         workRequest.reset();
 
         // Persist the configuration we just placed so that we can later check whether we need to
@@ -174,6 +195,13 @@ void VectorTileData::redoPlacement(const std::function<void()>& callback) {
     });
 }
 
+void VectorTileData::setRequestPriority(double priority_) {
+    priority = priority_;
+    if (tileRequest) {
+        tileRequest->setPriority(priority);
+    }
+}
+
 void VectorTileData::cancel() {
     state = State::obsolete;
     tileRequest.reset();
@@ -34,9 +34,14 @@ public:
     void redoPlacement(PlacementConfig config, const std::function<void()>&) override;
     void redoPlacement(const std::function<void()>&) override;
 
+    void setRequestPriority(double) override;
+
     void cancel() override;
 
 private:
+    // Shows a recent placement of all buckets again, if they all have one for this configuration.
+    bool restorePlacement(const PlacementConfig&);
+
     Style& style;
     Worker& worker;
     TileWorker tileWorker;
@@ -44,6 +49,7 @@ private:
     std::unique_ptr<GeometryTileMonitor> monitor;
     std::unique_ptr<FileRequest> tileRequest;
     std::unique_ptr<WorkRequest> workRequest;
+    double priority = 0;
 
     // Contains all the Bucket objects for the tile. Buckets are render
     // objects and they get added by tile parsing operations.
@@ -0,0 +1,200 @@
+#include <mbgl/map/vector_tile_filter.hpp>
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/style/filter_expression_private.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace mbgl {
+
+namespace {
+
+const uint32_t kTypeSlot = std::numeric_limits<uint32_t>::max();
+const uint32_t kMissing = std::numeric_limits<uint32_t>::max();
+
+// The number of FeatureType values.
+const uint32_t kTypeCount = 4;
+
+// Answers every key with the same value, so that a single comparison can be evaluated for it.
+class ValueExtractor {
+public:
+    ValueExtractor(optional<Value> value_)
+        : value(std::move(value_)) {}
+
+    const optional<Value>& getValue(const std::string&) const {
+        return value;
+    }
+
+private:
+    const optional<Value> value;
+};
+
+} // namespace
+
+struct VectorTileFilter::Compiler : public mapbox::util::static_visitor<uint32_t> {
+    VectorTileFilter& filter;
+    const FilterExpression* current = nullptr;
+
+    Compiler(VectorTileFilter& filter_)
+        : filter(filter_) {}
+
+    uint32_t compile(const FilterExpression& expression) {
+        current = &expression;
+        return mapbox::util::apply_visitor(*this, expression);
+    }
+
+    uint32_t operator()(const NullExpression&) {
+        return add(Node { NodeType::Constant, true });
+    }
+
+    uint32_t operator()(const AnyExpression& e) { return group(NodeType::Any, e.expressions); }
+    uint32_t operator()(const AllExpression& e) { return group(NodeType::All, e.expressions); }
+    uint32_t operator()(const NoneExpression& e) { return group(NodeType::None, e.expressions); }
+
+    template <class E>
+    uint32_t operator()(const E& e) {
+        Node node { NodeType::Comparison };
+        node.expression = current;
+        node.result = mbgl::evaluate(*current, ValueExtractor({}));
+
+        if (e.key == "$type") {
+            node.first = kTypeSlot;
+            node.results = filter.results.size();
+            filter.results.resize(filter.results.size() + kTypeCount);
+            return add(node);
+        }
+
+        auto it = filter.layer.keys.find(e.key);
+        if (it == filter.layer.keys.end()) {
+            // None of the features have the key.
+            node.type = NodeType::Constant;
+            return add(node);
+        }
+
+        auto slot = std::find(filter.slotKeys.begin(), filter.slotKeys.end(), it->second);
+        node.first = slot - filter.slotKeys.begin();
+        if (slot == filter.slotKeys.end()) {
+            filter.slotKeys.push_back(it->second);
+            filter.slotValues.push_back(kMissing);
+        }
+
+        node.results = filter.results.size();
+        filter.results.resize(filter.results.size() + filter.layer.values.size());
+        return add(node);
+    }
+
+    uint32_t group(NodeType type, const std::vector<FilterExpression>& expressions) {
+        std::vector<uint32_t> indices;
+        for (const auto& expression : expressions) {
+            indices.push_back(compile(expression));
+        }
+
+        Node node { type };
+        node.first = filter.operands.size();
+        node.last = node.first + indices.size();
+        filter.operands.insert(filter.operands.end(), indices.begin(), indices.end());
+        return add(node);
+    }
+
+    uint32_t add(const Node& node) {
+        filter.nodes.push_back(node);
+        return filter.nodes.size() - 1;
+    }
+};
+
+VectorTileFilter::VectorTileFilter(const FilterExpression& expression, const VectorTileLayer& layer_)
+    : layer(layer_) {
+    root = Compiler(*this).compile(expression);
+}
+
+bool VectorTileFilter::operator()(const GeometryTileFeature& feature_) {
+    // The layer only passes its own features.
+    const auto& feature = static_cast<const VectorTileFeature&>(feature_);
+
+    if (!slotKeys.empty()) {
+        std::fill(slotValues.begin(), slotValues.end(), kMissing);
+
+        pbf tags = feature.tags_pbf;
+        while (tags) {
+            uint32_t tag_key = tags.varint();
+
+            if (layer.keyCount <= tag_key) {
+                throw std::runtime_error("feature referenced out of range key");
+            }
+
+            if (!tags) {
+                throw std::runtime_error("uneven number of feature tag ids");
+            }
+
+            uint32_t tag_val = tags.varint();
+            if (layer.values.size() <= tag_val) {
+                throw std::runtime_error("feature referenced out of range value");
+            }
+
+            for (std::size_t i = 0; i < slotKeys.size(); i++) {
+                // Like VectorTileFeature::getValue(), use the first value of a repeated key.
+                if (slotKeys[i] == tag_key && slotValues[i] == kMissing) {
+                    slotValues[i] = tag_val;
+                }
+            }
+        }
+    }
+
+    return evaluate(root, feature.type);
+}
+
+bool VectorTileFilter::evaluate(uint32_t index, FeatureType type) {
+    const Node& node = nodes[index];
+
+    switch (node.type) {
+    case NodeType::Constant:
+        return node.result;
+
+    case NodeType::Comparison: {
+        const bool isType = node.first == kTypeSlot;
+        const uint32_t value = isType ? uint32_t(type) : slotValues[node.first];
+        if (value == kMissing) {
+            return node.result;
+        }
+
+        if (isType && value >= kTypeCount) {
+            return mbgl::evaluate(*node.expression, ValueExtractor(Value(uint64_t(type))));
+        }
+
+        uint8_t& result = results[node.results + value];
+        if (!result) {
+            ValueExtractor extractor(isType ? Value(uint64_t(type)) : layer.values[value]);
+            result = mbgl::evaluate(*node.expression, extractor) ? 2 : 1;
+        }
+        return result == 2;
+    }
+
+    case NodeType::Any:
+        for (uint32_t i = node.first; i < node.last; i++) {
+            if (evaluate(operands[i], type)) {
+                return true;
+            }
+        }
+        return false;
+
+    case NodeType::All:
+        for (uint32_t i = node.first; i < node.last; i++) {
+            if (!evaluate(operands[i], type)) {
+                return false;
+            }
+        }
+        return true;
+
+    case NodeType::None:
+        for (uint32_t i = node.first; i < node.last; i++) {
+            if (evaluate(operands[i], type)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace mbgl
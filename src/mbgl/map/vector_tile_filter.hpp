@@ -0,0 +1,71 @@
+#ifndef MBGL_MAP_VECTOR_TILE_FILTER
+#define MBGL_MAP_VECTOR_TILE_FILTER
+
+#include <mbgl/map/geometry_tile.hpp>
+#include <mbgl/style/filter_expression.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace mbgl {
+
+class VectorTileLayer;
+class VectorTileFeature;
+
+// A filter expression that has been resolved against the key and value tables of a vector tile
+// layer. Keys are matched by their index in the layer, and the result of every comparison is
+// cached per value index, so evaluating a feature only decodes its tags; it neither looks up nor
+// copies strings.
+class VectorTileFilter : public GeometryTileFilter {
+public:
+    VectorTileFilter(const FilterExpression&, const VectorTileLayer&);
+
+    bool operator()(const GeometryTileFeature&) override;
+
+private:
+    struct Compiler;
+
+    enum class NodeType : uint8_t {
+        Constant,
+        Comparison,
+        Any,
+        All,
+        None
+    };
+
+    struct Node {
+        NodeType type;
+
+        // For constants, the result. For comparisons, the result if the feature doesn't have the key.
+        bool result = false;
+
+        // For comparisons, the index into slotKeys, or kTypeSlot for comparisons of the feature
+        // type. For Any, All and None, the range of their operands in `operands`.
+        uint32_t first = 0;
+        uint32_t last = 0;
+
+        // For comparisons, the offset of their cached results in `results`, and the expression
+        // that computes them.
+        uint32_t results = 0;
+        const FilterExpression* expression = nullptr;
+    };
+
+    bool evaluate(uint32_t node, FeatureType);
+
+    const VectorTileLayer& layer;
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> operands;
+    uint32_t root = 0;
+
+    // The indices of the keys the filter uses, and the index of their value in the current feature.
+    std::vector<uint32_t> slotKeys;
+    std::vector<uint32_t> slotValues;
+
+    // 0 for comparisons that haven't been evaluated for a value yet, 1 for false and 2 for true.
+    std::vector<uint8_t> results;
+};
+
+} // namespace mbgl
+
+#endif
@@ -17,6 +17,9 @@ class Painter;
 class StyleLayer;
 class TileID;
 class CollisionTile;
+class PlacementConfig;
+class GeometryTileFeature;
+class FeatureGeometries;
 
 class Bucket : private util::noncopyable {
 public:
@@ -34,6 +37,9 @@ public:
 
     virtual bool hasData() const = 0;
 
+    // Adds a feature that matches the filter of the layer.
+    virtual void addFeature(const GeometryTileFeature&, const FeatureGeometries&) {}
+
     inline bool needsUpload() const {
         return !uploaded;
     }
@@ -41,6 +47,13 @@ public:
     virtual void placeFeatures(CollisionTile&) {}
     virtual void swapRenderData() {}
 
+    // Returns whether the bucket can show its placement for this configuration without placing its
+    // features again, because it is shown now or was shown recently.
+    virtual bool hasPlacement(const PlacementConfig&) const { return true; }
+
+    // Shows a placement for which hasPlacement() returned true.
+    virtual void restorePlacement(const PlacementConfig&) {}
+
 protected:
     std::atomic<bool> uploaded;
 
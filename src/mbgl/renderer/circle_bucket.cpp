@@ -1,4 +1,5 @@
 #include <mbgl/renderer/circle_bucket.hpp>
+#include <mbgl/util/get_geometries.hpp>
 #include <mbgl/renderer/painter.hpp>
 
 #include <mbgl/shader/circle_shader.hpp>
@@ -31,8 +32,15 @@ bool CircleBucket::hasData() const {
     return !triangleGroups_.empty();
 }
 
+void CircleBucket::addFeature(const GeometryTileFeature&, const FeatureGeometries& geometries) {
+    addGeometry(geometries.get());
+}
+
 void CircleBucket::addGeometry(const GeometryCollection& geometryCollection) {
     for (auto& circle : geometryCollection) {
+        vertexBuffer_.reserve(circle.size() * 4);
+        elementsBuffer_.reserve(circle.size() * 2);
+
         for(auto & geometry : circle) {
             auto x = geometry.x;
             auto y = geometry.y;
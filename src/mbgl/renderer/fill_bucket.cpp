@@ -1,4 +1,6 @@
 #include <mbgl/renderer/fill_bucket.hpp>
+#include <mbgl/util/get_geometries.hpp>
+#include <mbgl/util/earcut.hpp>
 #include <mbgl/geometry/fill_buffer.hpp>
 #include <mbgl/layer/fill_layer.hpp>
 #include <mbgl/geometry/elements_buffer.hpp>
@@ -53,7 +55,16 @@ FillBucket::~FillBucket() {
     }
 }
 
+void FillBucket::addFeature(const GeometryTileFeature&, const FeatureGeometries& geometries) {
+    addGeometry(geometries.getClippedPolygons());
+}
+
 void FillBucket::addGeometry(const GeometryCollection& geometryCollection) {
+    // Most polygons in vector tiles are valid, so try the fast path first.
+    if (triangulate(geometryCollection)) {
+        return;
+    }
+
     for (auto& line_ : geometryCollection) {
         for (auto& v : line_) {
             line.emplace_back(v.x, v.y);
@@ -100,6 +111,10 @@ void FillBucket::tessellate() {
     LineGroup& lineGroup = *lineGroups.back();
     GLsizei lineIndex = lineGroup.vertex_length;
 
+    vertexBuffer.reserve(total_vertex_count);
+    lineElementsBuffer.reserve(total_vertex_count);
+    triangleElementsBuffer.reserve(triangles.size() / 3);
+
     for (const auto& polygon : polygons) {
         const GLsizei group_count = static_cast<GLsizei>(polygon.size());
         assert(group_count >= 3);
@@ -186,6 +201,97 @@ void FillBucket::tessellate() {
     lineGroup.vertex_length += total_vertex_count;
 }
 
+bool FillBucket::triangulate(const GeometryCollection& geometryCollection) {
+    // Holes that are wound like their outer ring are only filled right by the fallback path.
+    if (!util::classifyRings(geometryCollection, ringGroups)) {
+        return false;
+    }
+
+    GLsizei total_vertex_count = 0;
+    for (const auto& polygon : ringGroups) {
+        for (const auto& ring : polygon) {
+            total_vertex_count += ring.size();
+        }
+    }
+
+    if (ringGroups.empty()) {
+        return true;
+    }
+
+    if (total_vertex_count > 65536) {
+        throw geometry_too_long_exception();
+    }
+
+    // Triangulate all polygons before adding anything, so that we can still fall back.
+    triangles.clear();
+    uint32_t offset = 0;
+    for (const auto& polygon : ringGroups) {
+        indices.clear();
+        util::earcut(polygon, indices);
+
+        // Self-intersecting polygons or holes that cross their outer ring leave parts uncovered.
+        if (util::earcutDeviation(polygon, indices) > 1e-9) {
+            return false;
+        }
+
+        for (const auto index : indices) {
+            triangles.push_back(offset + index);
+        }
+        for (const auto& ring : polygon) {
+            offset += ring.size();
+        }
+    }
+
+    if (lineGroups.empty() || (lineGroups.back()->vertex_length + total_vertex_count > 65535)) {
+        // Move to a new group because the old one can't hold the geometry.
+        lineGroups.emplace_back(std::make_unique<LineGroup>());
+    }
+
+    assert(lineGroups.back());
+    LineGroup& lineGroup = *lineGroups.back();
+    GLsizei lineIndex = lineGroup.vertex_length;
+
+    vertexBuffer.reserve(total_vertex_count);
+    lineElementsBuffer.reserve(total_vertex_count);
+    triangleElementsBuffer.reserve(triangles.size() / 3);
+
+    for (const auto& polygon : ringGroups) {
+        for (const auto& ring : polygon) {
+            const GLsizei group_count = static_cast<GLsizei>(ring.size());
+            for (GLsizei i = 0; i < group_count; i++) {
+                vertexBuffer.add(ring[i].x, ring[i].y);
+
+                const GLsizei prev_i = (i == 0 ? group_count : i) - 1;
+                lineElementsBuffer.add(lineIndex + prev_i, lineIndex + i);
+            }
+            lineIndex += group_count;
+        }
+    }
+
+    lineGroup.elements_length += total_vertex_count;
+    lineGroup.vertex_length += total_vertex_count;
+
+    if (triangleGroups.empty() || (triangleGroups.back()->vertex_length + total_vertex_count > 65535)) {
+        // Move to a new group because the old one can't hold the geometry.
+        triangleGroups.emplace_back(std::make_unique<TriangleGroup>());
+    }
+
+    assert(triangleGroups.back());
+    TriangleGroup& triangleGroup = *triangleGroups.back();
+    GLsizei triangleIndex = triangleGroup.vertex_length;
+
+    for (std::size_t i = 0; i < triangles.size(); i += 3) {
+        triangleElementsBuffer.add(triangleIndex + triangles[i],
+                                   triangleIndex + triangles[i + 1],
+                                   triangleIndex + triangles[i + 2]);
+    }
+
+    triangleGroup.vertex_length += total_vertex_count;
+    triangleGroup.elements_length += triangles.size() / 3;
+
+    return true;
+}
+
 void FillBucket::upload() {
     vertexBuffer.upload();
     triangleElementsBuffer.upload();
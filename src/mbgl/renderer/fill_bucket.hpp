@@ -36,9 +36,14 @@ public:
     void render(Painter&, const StyleLayer&, const TileID&, const mat4&) override;
     bool hasData() const override;
 
+    void addFeature(const GeometryTileFeature&, const FeatureGeometries&) override;
     void addGeometry(const GeometryCollection&);
     void tessellate();
 
+    // Triangulates valid polygons by ear clipping. Returns false without adding anything when
+    // the geometry needs to be cleaned up by tessellate() instead.
+    bool triangulate(const GeometryCollection&);
+
     void drawElements(PlainShader& shader);
     void drawElements(PatternShader& shader);
     void drawVertices(OutlineShader& shader);
@@ -58,6 +63,11 @@ private:
     std::vector<ClipperLib::IntPoint> line;
     bool hasVertices = false;
 
+    // Scratch space for triangulate().
+    std::vector<GeometryCollection> ringGroups;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> triangles;
+
     static const int vertexSize = 2;
     static const int stride = sizeof(TESSreal) * vertexSize;
     static const int vertices_per_group = 3;
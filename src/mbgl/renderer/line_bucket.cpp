@@ -1,4 +1,5 @@
 #include <mbgl/renderer/line_bucket.hpp>
+#include <mbgl/util/get_geometries.hpp>
 #include <mbgl/layer/line_layer.hpp>
 #include <mbgl/geometry/elements_buffer.hpp>
 #include <mbgl/renderer/painter.hpp>
@@ -19,6 +20,10 @@ LineBucket::~LineBucket() {
     // Do not remove. header file only contains forward definitions to unique pointers.
 }
 
+void LineBucket::addFeature(const GeometryTileFeature&, const FeatureGeometries& geometries) {
+    addGeometry(geometries.getClippedLines());
+}
+
 void LineBucket::addGeometry(const GeometryCollection& geometryCollection) {
     for (auto& line : geometryCollection) {
         addGeometry(line);
@@ -70,7 +75,11 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
     }
 
     const GLint startVertex = vertexBuffer.index();
-    std::vector<TriangleElement> triangleStore;
+    lineTriangles.clear();
+
+    // Every vertex of the line adds at least two vertices and two triangles.
+    vertexBuffer.reserve(len * 2);
+    lineTriangles.reserve(len * 2);
 
     for (GLsizei i = 0; i < len; ++i) {
         if (closed && i == len - 1) {
@@ -170,7 +179,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         if (middleVertex && currentJoin == JoinType::Miter) {
             joinNormal = joinNormal * miterLength;
             addCurrentVertex(currentVertex, flip, distance, joinNormal, 0, 0, false, startVertex,
-                             triangleStore);
+                             lineTriangles);
 
         } else if (middleVertex && currentJoin == JoinType::FlipBevel) {
             // miter is too big, flip the direction to make a beveled join
@@ -186,10 +195,10 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             }
 
             addCurrentVertex(currentVertex, flip, distance, joinNormal, 0, 0, false, startVertex,
-                             triangleStore);
+                             lineTriangles);
 
             addCurrentVertex(currentVertex, -flip, distance, joinNormal, 0, 0, false, startVertex,
-                             triangleStore);
+                             lineTriangles);
         } else if (middleVertex && (currentJoin == JoinType::Bevel || currentJoin == JoinType::FakeRound)) {
             const bool lineTurnsLeft = flip * (prevNormal.x * nextNormal.y - prevNormal.y * nextNormal.x) > 0;
             const float offset = -std::sqrt(miterLength * miterLength - 1);
@@ -207,7 +216,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             // Close previous segement with bevel
             if (!startOfLine) {
                 addCurrentVertex(currentVertex, flip, distance, prevNormal, offsetA, offsetB, false,
-                                 startVertex, triangleStore);
+                                 startVertex, lineTriangles);
             }
 
             if (currentJoin == JoinType::FakeRound) {
@@ -222,41 +231,41 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
 
                 for (int m = 0; m < n; m++) {
                     auto approxFractionalJoinNormal = util::unit(nextNormal * ((m + 1.0f) / (n + 1.0f)) + prevNormal);
-                    addPieSliceVertex(currentVertex, flip, distance, approxFractionalJoinNormal, lineTurnsLeft, startVertex, triangleStore);
+                    addPieSliceVertex(currentVertex, flip, distance, approxFractionalJoinNormal, lineTurnsLeft, startVertex, lineTriangles);
                 }
 
-                addPieSliceVertex(currentVertex, flip, distance, joinNormal, lineTurnsLeft, startVertex, triangleStore);
+                addPieSliceVertex(currentVertex, flip, distance, joinNormal, lineTurnsLeft, startVertex, lineTriangles);
 
                 for (int k = n - 1; k >= 0; k--) {
                     auto approxFractionalJoinNormal = util::unit(prevNormal * ((k + 1.0f) / (n + 1.0f)) + nextNormal);
-                    addPieSliceVertex(currentVertex, flip, distance, approxFractionalJoinNormal, lineTurnsLeft, startVertex, triangleStore);
+                    addPieSliceVertex(currentVertex, flip, distance, approxFractionalJoinNormal, lineTurnsLeft, startVertex, lineTriangles);
                 }
             }
 
             // Start next segment
             if (nextVertex) {
                 addCurrentVertex(currentVertex, flip, distance, nextNormal, -offsetA, -offsetB,
-                                 false, startVertex, triangleStore);
+                                 false, startVertex, lineTriangles);
             }
 
         } else if (!middleVertex && currentCap == CapType::Butt) {
             if (!startOfLine) {
                 // Close previous segment with a butt
                 addCurrentVertex(currentVertex, flip, distance, prevNormal, 0, 0, false,
-                                 startVertex, triangleStore);
+                                 startVertex, lineTriangles);
             }
 
             // Start next segment with a butt
             if (nextVertex) {
                 addCurrentVertex(currentVertex, flip, distance, nextNormal, 0, 0, false,
-                                 startVertex, triangleStore);
+                                 startVertex, lineTriangles);
             }
 
         } else if (!middleVertex && currentCap == CapType::Square) {
             if (!startOfLine) {
                 // Close previous segment with a square cap
                 addCurrentVertex(currentVertex, flip, distance, prevNormal, 1, 1, false,
-                                 startVertex, triangleStore);
+                                 startVertex, lineTriangles);
 
                 // The segment is done. Unset vertices to disconnect segments.
                 e1 = e2 = -1;
@@ -266,18 +275,18 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             // Start next segment
             if (nextVertex) {
                 addCurrentVertex(currentVertex, flip, distance, nextNormal, -1, -1, false,
-                                 startVertex, triangleStore);
+                                 startVertex, lineTriangles);
             }
 
         } else if (middleVertex ? currentJoin == JoinType::Round : currentCap == CapType::Round) {
             if (!startOfLine) {
                 // Close previous segment with a butt
                 addCurrentVertex(currentVertex, flip, distance, prevNormal, 0, 0, false,
-                                 startVertex, triangleStore);
+                                 startVertex, lineTriangles);
 
                 // Add round cap or linejoin at end of segment
                 addCurrentVertex(currentVertex, flip, distance, prevNormal, 1, 1, true, startVertex,
-                                 triangleStore);
+                                 lineTriangles);
 
                 // The segment is done. Unset vertices to disconnect segments.
                 e1 = e2 = -1;
@@ -288,10 +297,10 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             if (nextVertex) {
                 // Add round cap before first segment
                 addCurrentVertex(currentVertex, flip, distance, nextNormal, -1, -1, true,
-                                 startVertex, triangleStore);
+                                 startVertex, lineTriangles);
 
                 addCurrentVertex(currentVertex, flip, distance, nextNormal, 0, 0, false,
-                                 startVertex, triangleStore);
+                                 startVertex, lineTriangles);
             }
         }
 
@@ -310,14 +319,15 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
 
         assert(triangleGroups.back());
         auto& group = *triangleGroups.back();
-        for (const auto& triangle : triangleStore) {
+        triangleElementsBuffer.reserve(lineTriangles.size());
+        for (const auto& triangle : lineTriangles) {
             triangleElementsBuffer.add(group.vertex_length + triangle.a,
                                        group.vertex_length + triangle.b,
                                        group.vertex_length + triangle.c);
         }
 
         group.vertex_length += vertexCount;
-        group.elements_length += triangleStore.size();
+        group.elements_length += lineTriangles.size();
     }
 }
 
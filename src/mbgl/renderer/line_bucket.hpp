@@ -31,6 +31,7 @@ public:
     void render(Painter&, const StyleLayer&, const TileID&, const mat4&) override;
     bool hasData() const override;
 
+    void addFeature(const GeometryTileFeature&, const FeatureGeometries&) override;
     void addGeometry(const GeometryCollection&);
     void addGeometry(const std::vector<Coordinate>& line);
 
@@ -62,6 +63,9 @@ private:
     GLint e3;
 
     std::vector<std::unique_ptr<TriangleGroup>> triangleGroups;
+
+    // The triangles of the line that is being added. Kept to reuse its storage for every line.
+    std::vector<TriangleElement> lineTriangles;
 };
 
 } // namespace mbgl
@@ -14,10 +14,12 @@
 
 #include <mbgl/layer/background_layer.hpp>
 #include <mbgl/layer/custom_layer.hpp>
+#include <mbgl/layer/symbol_layer.hpp>
 
 #include <mbgl/sprite/sprite_atlas.hpp>
 #include <mbgl/geometry/line_atlas.hpp>
 #include <mbgl/geometry/glyph_atlas.hpp>
+#include <mbgl/renderer/symbol_bucket.hpp>
 
 #include <mbgl/shader/pattern_shader.hpp>
 #include <mbgl/shader/plain_shader.hpp>
@@ -32,6 +34,7 @@
 #include <mbgl/shader/box_shader.hpp>
 #include <mbgl/shader/circle_shader.hpp>
 
+#include <mbgl/text/viewport_collision.hpp>
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/mat3.hpp>
 #include <mbgl/util/tile_coordinate.hpp>
@@ -64,6 +67,8 @@ Painter::Painter(MapData& data_, TransformState& state_)
     collisionBoxShader = std::make_unique<CollisionBoxShader>();
     circleShader = std::make_unique<CircleShader>();
 
+    viewportCollision = std::make_unique<ViewportCollision>();
+
     // Reset GL values
     config.reset();
 }
@@ -80,6 +85,28 @@ void Painter::prepareTile(const Tile& tile) {
     config.stencilFunc = { GL_EQUAL, ref, mask };
 }
 
+void Painter::collideSymbols(const std::vector<RenderItem>& order) {
+    // The world coordinates of the center of the screen, see getProjMatrix().
+    const double centerX = state.getWidth() / 2.0 - state.pixel_x();
+    const double centerY = state.getHeight() / 2.0 - state.pixel_y();
+    const float radius = std::hypot(state.getWidth(), state.getHeight()) / 2;
+    viewportCollision->reset({ state.getAngle(), state.getPitch() }, state.getZoom(), centerX, centerY, radius);
+
+    // Symbols of upper layers take precedence, like they do within a tile. Within a layer, tiles
+    // always come in the same order, so the same symbols win at every frame.
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        if (!it->tile || !it->bucket || !it->layer.is<SymbolLayer>()) {
+            continue;
+        }
+
+        auto& bucket = *static_cast<SymbolBucket*>(it->bucket);
+        if (const PlacedSymbols* placed = bucket.getPlacedSymbols()) {
+            viewportCollision->place(it->tile->id, *placed, hiddenSymbols);
+            bucket.hideSymbols(hiddenSymbols);
+        }
+    }
+}
+
 void Painter::render(const Style& style, const FrameData& frame_, SpriteAtlas& annotationSpriteAtlas) {
     frame = frame_;
 
@@ -103,6 +130,13 @@ void Painter::render(const Style& style, const FrameData& frame_, SpriteAtlas& a
     matrix::identity(nativeMatrix);
     matrix::multiply(nativeMatrix, projMatrix, nativeMatrix);
 
+    // - COLLISION PASS ----------------------------------------------------------------------------
+    // Tiles place their symbols on their own. Symbols of neighbouring tiles meet here.
+    {
+        MBGL_DEBUG_GROUP("collision");
+        collideSymbols(order);
+    }
+
     // - UPLOAD PASS -------------------------------------------------------------------------------
     // Uploads all required buffers and images before we do any actual rendering.
     {
@@ -64,6 +64,8 @@ class SDFIconShader;
 class DotShader;
 class CollisionBoxShader;
 
+class ViewportCollision;
+
 struct ClipID;
 
 class Painter : private util::noncopyable {
@@ -110,6 +112,9 @@ private:
 
     void prepareTile(const Tile& tile);
 
+    // Hides symbols that collide with symbols of other tiles.
+    void collideSymbols(const std::vector<RenderItem>& order);
+
     template <typename BucketProperties, typename StyleProperties>
     void renderSDF(SymbolBucket &bucket,
                    const TileID &id,
@@ -162,6 +167,9 @@ private:
 
     FrameHistory frameHistory;
 
+    std::unique_ptr<ViewportCollision> viewportCollision;
+    std::vector<bool> hiddenSymbols;
+
     std::unique_ptr<PlainShader> plainShader;
     std::unique_ptr<OutlineShader> outlineShader;
     std::unique_ptr<LineShader> lineShader;
@@ -258,7 +258,7 @@ void Painter::renderSymbol(SymbolBucket& bucket, const SymbolLayer& layer, const
             config.depthTest = GL_FALSE;
         }
 
-        glyphAtlas->bind();
+        glyphAtlas->bind(bucket.glyphPage);
 
         renderSDF(bucket,
                   id,
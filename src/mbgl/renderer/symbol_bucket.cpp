@@ -27,8 +27,23 @@
 #include <mbgl/util/get_geometries.hpp>
 #include <mbgl/util/constants.hpp>
 
+#include <atomic>
+#include <iterator>
+
 namespace mbgl {
 
+namespace {
+
+// The number of earlier placements that a bucket keeps, besides the one it shows.
+const std::size_t kPlacementCacheSize = 4;
+
+// The total size of the buffers of the earlier placements that all buckets keep. Buckets drop
+// their oldest placements while the total is larger.
+const std::size_t kPlacementCacheBufferSize = 16 * 1024 * 1024;
+std::atomic<std::size_t> placementCacheBufferSize { 0 };
+
+} // namespace
+
 SymbolInstance::SymbolInstance(Anchor& anchor, const std::vector<Coordinate>& line,
         const Shaping& shapedText, const PositionedIcon& shapedIcon,
         const SymbolLayoutProperties& layout, const bool addToBuffers, const uint32_t index_,
@@ -61,7 +76,9 @@ SymbolBucket::SymbolBucket(float overscaling_, float zoom_, const MapMode mode_)
 }
 
 SymbolBucket::~SymbolBucket() {
-    // Do not remove. header file only contains forward definitions to unique pointers.
+    for (const auto& cached : placementCache) {
+        placementCacheBufferSize -= cached->bufferSize();
+    }
 }
 
 void SymbolBucket::upload() {
@@ -92,8 +109,7 @@ bool SymbolBucket::hasIconData() const { return renderData && !renderData->icon.
 
 bool SymbolBucket::hasCollisionBoxData() const { return renderData && !renderData->collisionBox.groups.empty(); }
 
-void SymbolBucket::parseFeatures(const GeometryTileLayer& layer,
-                                 const FilterExpression& filter) {
+void SymbolBucket::addFeature(const GeometryTileFeature& feature, const FeatureGeometries& geometries) {
     const bool has_text = !layout.text.field.value.empty() && !layout.text.font.value.empty();
     const bool has_icon = !layout.icon.image.value.empty();
 
@@ -101,61 +117,53 @@ void SymbolBucket::parseFeatures(const GeometryTileLayer& layer,
         return;
     }
 
-    // Determine and load glyph ranges
-    const GLsizei featureCount = static_cast<GLsizei>(layer.featureCount());
-    for (GLsizei i = 0; i < featureCount; i++) {
-        auto feature = layer.getFeature(i);
-
-        GeometryTileFeatureExtractor extractor(*feature);
-        if (!evaluate(filter, extractor))
-            continue;
+    SymbolFeature ft;
 
-        SymbolFeature ft;
+    auto getValue = [&feature](const std::string& key) -> std::string {
+        auto value = feature.getValue(key);
+        return value ? toString(*value) : std::string();
+    };
 
-        auto getValue = [&feature](const std::string& key) -> std::string {
-            auto value = feature->getValue(key);
-            return value ? toString(*value) : std::string();
-        };
+    if (has_text) {
+        std::string u8string = util::replaceTokens(layout.text.field, getValue);
 
-        if (has_text) {
-            std::string u8string = util::replaceTokens(layout.text.field, getValue);
-
-            if (layout.text.transform == TextTransformType::Uppercase) {
-                u8string = platform::uppercase(u8string);
-            } else if (layout.text.transform == TextTransformType::Lowercase) {
-                u8string = platform::lowercase(u8string);
-            }
+        if (layout.text.transform == TextTransformType::Uppercase) {
+            u8string = platform::uppercase(u8string);
+        } else if (layout.text.transform == TextTransformType::Lowercase) {
+            u8string = platform::lowercase(u8string);
+        }
 
-            ft.label = util::utf8_to_utf32::convert(u8string);
+        ft.label = util::utf8_to_utf32::convert(u8string);
 
-            if (!ft.label.empty()) {
-                // Loop through all characters of this text and collect unique codepoints.
-                for (char32_t chr : ft.label) {
-                    ranges.insert(getGlyphRange(chr));
-                }
+        if (!ft.label.empty()) {
+            // Determine and load glyph ranges: loop through all characters of this text and
+            // collect unique codepoints.
+            for (char32_t chr : ft.label) {
+                ranges.insert(getGlyphRange(chr));
             }
         }
+    }
 
-        if (has_icon) {
-            ft.sprite = util::replaceTokens(layout.icon.image, getValue);
-        }
+    if (has_icon) {
+        ft.sprite = util::replaceTokens(layout.icon.image, getValue);
+    }
 
-        if (ft.label.length() || ft.sprite.length()) {
+    if (ft.label.length() || ft.sprite.length()) {
 
-            auto &multiline = ft.geometry;
+        auto &multiline = ft.geometry;
 
-            GeometryCollection geometryCollection = getGeometries(*feature);
-            for (auto& line : geometryCollection) {
-                multiline.emplace_back();
-                for (auto& point : line) {
-                    multiline.back().emplace_back(point.x, point.y);
-                }
+        for (auto& line : geometries.get()) {
+            multiline.emplace_back();
+            for (auto& point : line) {
+                multiline.back().emplace_back(point.x, point.y);
             }
-
-            features.push_back(std::move(ft));
         }
+
+        features.push_back(std::move(ft));
     }
+}
 
+void SymbolBucket::finishFeatures() {
     if (layout.placement == PlacementType::Line) {
         util::mergeLines(features);
     }
@@ -218,18 +226,19 @@ void SymbolBucket::addFeatures(uintptr_t tileUID,
         layout.text.justify == TextJustifyType::Left ? 0 :
         0.5;
 
-    auto fontStack = glyphStore.getFontStack(layout.text.font);
+    // Shape all labels first, so that the glyphs they need go to the glyph atlas at once, and the
+    // font stacks are unlocked for other workers as soon as possible.
+    std::vector<Shaping> shapings(features.size());
+    GlyphPositions face;
+    {
+        auto fontStack = glyphStore.getFontStack(layout.text.font);
+        std::set<uint32_t> glyphs;
 
-    for (const auto& feature : features) {
-        if (feature.geometry.empty()) continue;
+        for (std::size_t i = 0; i < features.size(); i++) {
+            const auto& feature = features[i];
+            if (feature.geometry.empty() || !feature.label.length()) continue;
 
-        Shaping shapedText;
-        PositionedIcon shapedIcon;
-        GlyphPositions face;
-
-        // if feature has text, shape the text
-        if (feature.label.length()) {
-            shapedText = fontStack->getShaping(
+            shapings[i] = fontStack->getShaping(
                 /* string */ feature.label,
                 /* maxWidth: ems */ layout.placement != PlacementType::Line ?
                     layout.text.maxWidth * 24 : 0,
@@ -240,12 +249,25 @@ void SymbolBucket::addFeatures(uintptr_t tileUID,
                 /* spacing: ems */ layout.text.letterSpacing * 24,
                 /* translate */ vec2<float>(layout.text.offset.value[0], layout.text.offset.value[1]));
 
-            // Add the glyphs we need for this label to the glyph atlas.
-            if (shapedText) {
-                glyphAtlas.addGlyphs(tileUID, feature.label, layout.text.font, **fontStack, face);
+            if (shapings[i]) {
+                glyphs.insert(feature.label.begin(), feature.label.end());
             }
         }
 
+        // Add the glyphs we need for these labels to the glyph atlas.
+        if (!glyphs.empty()) {
+            glyphPage = glyphAtlas.addGlyphs(tileUID, std::u32string(glyphs.begin(), glyphs.end()),
+                                             layout.text.font, **fontStack, face);
+        }
+    }
+
+    for (std::size_t i = 0; i < features.size(); i++) {
+        const auto& feature = features[i];
+        if (feature.geometry.empty()) continue;
+
+        const Shaping& shapedText = shapings[i];
+        PositionedIcon shapedIcon;
+
         // if feature has icon, get sprite atlas position
         if (feature.sprite.length()) {
             auto image = spriteAtlas.getImage(feature.sprite, false);
@@ -360,6 +382,7 @@ bool SymbolBucket::anchorIsTooClose(const std::u32string &text, const float repe
 void SymbolBucket::placeFeatures(CollisionTile& collisionTile) {
 
     renderDataInProgress = std::make_unique<SymbolRenderData>();
+    renderDataInProgress->config = collisionTile.config;
 
     // Calculate which labels can be shown and when they can be shown and
     // create the bufers used for rendering.
@@ -391,7 +414,18 @@ void SymbolBucket::placeFeatures(CollisionTile& collisionTile) {
         });
     }
 
+    // Keeps the boxes of the text and the icons that are shown, for the collision pass over the
+    // viewport.
+    auto& placed = renderDataInProgress->placed;
+    auto addPlacedBoxes = [&](const CollisionFeature& feature, float scale, bool allowOverlap, bool ignorePlacement) {
+        for (const auto& box : feature.boxes) {
+            placed.boxes.push_back({ box, allowOverlap, ignorePlacement });
+            placed.boxes.back().box.placementScale = scale;
+        }
+    };
+
     for (SymbolInstance &symbolInstance : symbolInstances) {
+        const auto symbol = static_cast<uint32_t>(placed.ends.size());
 
         const bool hasText = symbolInstance.hasText;
         const bool hasIcon = symbolInstance.hasIcon;
@@ -430,8 +464,10 @@ void SymbolBucket::placeFeatures(CollisionTile& collisionTile) {
             }
             if (glyphScale < collisionTile.maxScale) {
                 addSymbols<SymbolRenderData::TextBuffer, TextElementGroup>(
-                    renderDataInProgress->text, symbolInstance.glyphQuads, glyphScale,
+                    renderDataInProgress->text, symbol, symbolInstance.glyphQuads, glyphScale,
                     layout.text.keepUpright, textAlongLine, collisionTile.config.angle);
+                addPlacedBoxes(symbolInstance.textCollisionFeature, glyphScale,
+                    layout.text.allowOverlap, layout.text.ignorePlacement);
             }
         }
 
@@ -441,10 +477,14 @@ void SymbolBucket::placeFeatures(CollisionTile& collisionTile) {
             }
             if (iconScale < collisionTile.maxScale) {
                 addSymbols<SymbolRenderData::IconBuffer, IconElementGroup>(
-                    renderDataInProgress->icon, symbolInstance.iconQuads, iconScale,
+                    renderDataInProgress->icon, symbol, symbolInstance.iconQuads, iconScale,
                     layout.icon.keepUpright, iconAlongLine, collisionTile.config.angle);
+                addPlacedBoxes(symbolInstance.iconCollisionFeature, iconScale,
+                    layout.icon.allowOverlap, layout.icon.ignorePlacement);
             }
         }
+
+        placed.ends.push_back(static_cast<uint32_t>(placed.boxes.size()));
     }
 
     if (collisionTile.config.debug) {
@@ -453,7 +493,7 @@ void SymbolBucket::placeFeatures(CollisionTile& collisionTile) {
 }
 
 template <typename Buffer, typename GroupType>
-void SymbolBucket::addSymbols(Buffer &buffer, const SymbolQuads &symbols, float scale, const bool keepUpright, const bool alongLine, const float placementAngle) {
+void SymbolBucket::addSymbols(Buffer &buffer, const uint32_t symbolIndex, const SymbolQuads &symbols, float scale, const bool keepUpright, const bool alongLine, const float placementAngle) {
 
     const float placementZoom = ::fmax(std::log(scale) / std::log(2) + zoom, 0);
 
@@ -512,6 +552,40 @@ void SymbolBucket::addSymbols(Buffer &buffer, const SymbolQuads &symbols, float
 
         triangleGroup.vertex_length += glyph_vertex_length;
         triangleGroup.elements_length += 2;
+
+        // Remember which vertices belong to this symbol, so that it can be hidden later.
+        const auto group = static_cast<uint32_t>(buffer.groups.size() - 1);
+        if (buffer.ranges.empty() || buffer.ranges.back().symbol != symbolIndex || buffer.ranges.back().group != group) {
+            buffer.ranges.push_back({ symbolIndex, group, static_cast<uint32_t>(triangleIndex), 0 });
+        }
+        buffer.ranges.back().vertexCount += glyph_vertex_length;
+    }
+}
+
+template <typename Buffer, typename GroupType>
+void SymbolBucket::filterSymbols(Buffer &buffer, const std::vector<bool>& hidden) {
+    buffer.visibleGroups.clear();
+    if (std::find(hidden.begin(), hidden.end(), true) == hidden.end()) {
+        buffer.visibleTriangles.reset();
+        return;
+    }
+
+    // The vertices stay as they are; only the triangles of hidden symbols are left out.
+    buffer.visibleTriangles = std::make_unique<TriangleElementsBuffer>();
+    for (const auto& group : buffer.groups) {
+        buffer.visibleGroups.emplace_back(std::make_unique<GroupType>(group->vertex_length, 0));
+    }
+
+    for (const auto& range : buffer.ranges) {
+        if (hidden[range.symbol]) {
+            continue;
+        }
+        const uint32_t end = range.firstVertex + range.vertexCount;
+        for (uint32_t index = range.firstVertex; index < end; index += 4) {
+            buffer.visibleTriangles->add(index + 0, index + 1, index + 2);
+            buffer.visibleTriangles->add(index + 1, index + 2, index + 3);
+        }
+        buffer.visibleGroups[range.group]->elements_length += range.vertexCount / 2;
     }
 }
 
@@ -568,20 +642,101 @@ void SymbolBucket::addToDebugBuffers(CollisionTile &collisionTile) {
 
 void SymbolBucket::swapRenderData() {
     if (renderDataInProgress) {
+        cachePlacement();
         renderData = std::move(renderDataInProgress);
     }
 }
 
+void SymbolBucket::cachePlacement() {
+    if (!renderData) {
+        return;
+    }
+
+    const PlacementConfig& config = renderData->config;
+    for (auto it = placementCache.begin(); it != placementCache.end();) {
+        if ((*it)->config == config) {
+            it = evictPlacement(it);
+        } else {
+            ++it;
+        }
+    }
+
+    placementCacheBufferSize += renderData->bufferSize();
+    placementCache.push_front(std::move(renderData));
+    while (!placementCache.empty() && (placementCache.size() > kPlacementCacheSize ||
+                                       placementCacheBufferSize > kPlacementCacheBufferSize)) {
+        evictPlacement(std::prev(placementCache.end()));
+    }
+}
+
+SymbolBucket::PlacementCache::iterator SymbolBucket::evictPlacement(PlacementCache::iterator it) {
+    placementCacheBufferSize -= (*it)->bufferSize();
+    return placementCache.erase(it);
+}
+
+std::size_t SymbolBucket::SymbolRenderData::bufferSize() const {
+    auto size = [] (const auto& buffer) {
+        return buffer.index() * buffer.itemSize;
+    };
+
+    return size(text.vertices) + size(text.triangles) +
+           (text.visibleTriangles ? size(*text.visibleTriangles) : 0) +
+           size(icon.vertices) + size(icon.triangles) +
+           (icon.visibleTriangles ? size(*icon.visibleTriangles) : 0) +
+           size(collisionBox.vertices);
+}
+
+bool SymbolBucket::hasPlacement(const PlacementConfig& config) const {
+    if (renderData && renderData->config == config) {
+        return true;
+    }
+    return std::any_of(placementCache.begin(), placementCache.end(), [&](const std::unique_ptr<SymbolRenderData>& cached) {
+        return cached->config == config;
+    });
+}
+
+void SymbolBucket::restorePlacement(const PlacementConfig& config) {
+    if (renderData && renderData->config == config) {
+        return;
+    }
+
+    auto it = std::find_if(placementCache.begin(), placementCache.end(), [&](const std::unique_ptr<SymbolRenderData>& cached) {
+        return cached->config == config;
+    });
+    assert(it != placementCache.end());
+    auto restored = std::move(*it);
+    placementCacheBufferSize -= restored->bufferSize();
+    placementCache.erase(it);
+
+    cachePlacement();
+    renderData = std::move(restored);
+}
+
+const PlacedSymbols* SymbolBucket::getPlacedSymbols() const {
+    return renderData ? &renderData->placed : nullptr;
+}
+
+void SymbolBucket::hideSymbols(const std::vector<bool>& hidden) {
+    if (!renderData || renderData->hidden == hidden) {
+        return;
+    }
+
+    renderData->hidden = hidden;
+    filterSymbols<SymbolRenderData::TextBuffer, TextElementGroup>(renderData->text, hidden);
+    filterSymbols<SymbolRenderData::IconBuffer, IconElementGroup>(renderData->icon, hidden);
+}
+
 void SymbolBucket::drawGlyphs(SDFShader &shader) {
     GLbyte *vertex_index = BUFFER_OFFSET_0;
     GLbyte *elements_index = BUFFER_OFFSET_0;
     auto& text = renderData->text;
-    for (auto &group : text.groups) {
+    auto& triangles = text.visibleTriangles ? *text.visibleTriangles : text.triangles;
+    for (auto &group : text.visibleTriangles ? text.visibleGroups : text.groups) {
         assert(group);
-        group->array[0].bind(shader, text.vertices, text.triangles, vertex_index);
+        group->array[0].bind(shader, text.vertices, triangles, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, group->elements_length * 3, GL_UNSIGNED_SHORT, elements_index));
         vertex_index += group->vertex_length * text.vertices.itemSize;
-        elements_index += group->elements_length * text.triangles.itemSize;
+        elements_index += group->elements_length * triangles.itemSize;
     }
 }
 
@@ -589,12 +744,13 @@ void SymbolBucket::drawIcons(SDFShader &shader) {
     GLbyte *vertex_index = BUFFER_OFFSET_0;
     GLbyte *elements_index = BUFFER_OFFSET_0;
     auto& icon = renderData->icon;
-    for (auto &group : icon.groups) {
+    auto& triangles = icon.visibleTriangles ? *icon.visibleTriangles : icon.triangles;
+    for (auto &group : icon.visibleTriangles ? icon.visibleGroups : icon.groups) {
         assert(group);
-        group->array[0].bind(shader, icon.vertices, icon.triangles, vertex_index);
+        group->array[0].bind(shader, icon.vertices, triangles, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, group->elements_length * 3, GL_UNSIGNED_SHORT, elements_index));
         vertex_index += group->vertex_length * icon.vertices.itemSize;
-        elements_index += group->elements_length * icon.triangles.itemSize;
+        elements_index += group->elements_length * triangles.itemSize;
     }
 }
 
@@ -602,12 +758,13 @@ void SymbolBucket::drawIcons(IconShader &shader) {
     GLbyte *vertex_index = BUFFER_OFFSET_0;
     GLbyte *elements_index = BUFFER_OFFSET_0;
     auto& icon = renderData->icon;
-    for (auto &group : icon.groups) {
+    auto& triangles = icon.visibleTriangles ? *icon.visibleTriangles : icon.triangles;
+    for (auto &group : icon.visibleTriangles ? icon.visibleGroups : icon.groups) {
         assert(group);
-        group->array[1].bind(shader, icon.vertices, icon.triangles, vertex_index);
+        group->array[1].bind(shader, icon.vertices, triangles, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, group->elements_length * 3, GL_UNSIGNED_SHORT, elements_index));
         vertex_index += group->vertex_length * icon.vertices.itemSize;
-        elements_index += group->elements_length * icon.triangles.itemSize;
+        elements_index += group->elements_length * triangles.itemSize;
     }
 }
 
@@ -13,9 +13,12 @@
 #include <mbgl/text/collision_feature.hpp>
 #include <mbgl/text/shaping.hpp>
 #include <mbgl/text/quads.hpp>
+#include <mbgl/text/placement_config.hpp>
+#include <mbgl/text/viewport_collision.hpp>
 #include <mbgl/style/filter_expression.hpp>
 #include <mbgl/layer/symbol_layer.hpp>
 
+#include <list>
 #include <memory>
 #include <map>
 #include <set>
@@ -73,6 +76,7 @@ public:
     void upload() override;
     void render(Painter&, const StyleLayer&, const TileID&, const mat4&) override;
     bool hasData() const override;
+    void addFeature(const GeometryTileFeature&, const FeatureGeometries&) override;
     bool hasTextData() const;
     bool hasIconData() const;
     bool hasCollisionBoxData() const;
@@ -87,10 +91,19 @@ public:
     void drawIcons(IconShader& shader);
     void drawCollisionBoxes(CollisionBoxShader& shader);
 
-    void parseFeatures(const GeometryTileLayer&,
-                       const FilterExpression&);
+    // Called once all features have been added.
+    void finishFeatures();
     bool needsDependencies(GlyphStore&, SpriteStore&);
     void placeFeatures(CollisionTile&) override;
+    bool hasPlacement(const PlacementConfig&) const override;
+    void restorePlacement(const PlacementConfig&) override;
+
+    // The symbols of the placement that is shown, for the collision pass over the viewport.
+    const PlacedSymbols* getPlacedSymbols() const;
+
+    // Stops drawing the symbols that the collision pass over the viewport hid, and draws the
+    // others again.
+    void hideSymbols(const std::vector<bool>& hidden);
 
 private:
     void addFeature(const std::vector<std::vector<Coordinate>> &lines,
@@ -103,16 +116,26 @@ private:
 
     void swapRenderData() override;
 
+    // Keeps the render data that is shown now for a later restorePlacement().
+    void cachePlacement();
+
     // Adds placed items to the buffer.
     template <typename Buffer, typename GroupType>
-    void addSymbols(Buffer &buffer, const SymbolQuads &symbols, float scale,
+    void addSymbols(Buffer &buffer, uint32_t symbolIndex, const SymbolQuads &symbols, float scale,
             const bool keepUpright, const bool alongLine, const float placementAngle);
 
+    // Rebuilds the triangles that are drawn from those of the symbols that aren't hidden.
+    template <typename Buffer, typename GroupType>
+    void filterSymbols(Buffer &buffer, const std::vector<bool>& hidden);
+
 public:
     SymbolLayoutProperties layout;
     bool sdfIcons = false;
     bool iconsNeedLinear = false;
 
+    // The glyph atlas page that holds the glyphs of this bucket.
+    std::size_t glyphPage = 0;
+
 private:
 
     const float overscaling;
@@ -125,27 +148,62 @@ private:
     std::vector<SymbolInstance> symbolInstances;
     std::vector<SymbolFeature> features;
 
+    // The vertices that a symbol added to a group, which are consecutive quads.
+    struct SymbolQuadRange {
+        uint32_t symbol;
+        uint32_t group;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+    };
+
     struct SymbolRenderData {
+        PlacementConfig config;
+
         struct TextBuffer {
             TextVertexBuffer vertices;
             TriangleElementsBuffer triangles;
             std::vector<std::unique_ptr<TextElementGroup>> groups;
+            std::vector<SymbolQuadRange> ranges;
+
+            // The triangles of the symbols that aren't hidden, when some are.
+            std::unique_ptr<TriangleElementsBuffer> visibleTriangles;
+            std::vector<std::unique_ptr<TextElementGroup>> visibleGroups;
         } text;
 
         struct IconBuffer {
             IconVertexBuffer vertices;
             TriangleElementsBuffer triangles;
             std::vector<std::unique_ptr<IconElementGroup>> groups;
+            std::vector<SymbolQuadRange> ranges;
+
+            std::unique_ptr<TriangleElementsBuffer> visibleTriangles;
+            std::vector<std::unique_ptr<IconElementGroup>> visibleGroups;
         } icon;
 
         struct CollisionBoxBuffer {
             CollisionBoxVertexBuffer vertices;
             std::vector<std::unique_ptr<CollisionBoxElementGroup>> groups;
         } collisionBox;
+
+        PlacedSymbols placed;
+
+        // The symbols that the collision pass over the viewport hid.
+        std::vector<bool> hidden;
+
+        // The size of the vertex and element buffers, in bytes.
+        std::size_t bufferSize() const;
     };
 
     std::unique_ptr<SymbolRenderData> renderData;
     std::unique_ptr<SymbolRenderData> renderDataInProgress;
+
+    // The render data of the most recently shown placements, most recent first. Their buffers
+    // stay on the GPU, so showing one of them again costs nothing. The buffers of all cached
+    // placements of all buckets together are limited in size.
+    using PlacementCache = std::list<std::unique_ptr<SymbolRenderData>>;
+    PlacementCache placementCache;
+
+    PlacementCache::iterator evictPlacement(PlacementCache::iterator);
 };
 
 } // namespace mbgl
@@ -0,0 +1,37 @@
+#ifndef MBGL_STORAGE_MBTILES_FILE_SOURCE
+#define MBGL_STORAGE_MBTILES_FILE_SOURCE
+
+#include <mbgl/storage/file_source.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace mbgl {
+
+namespace util {
+template <typename T> class Thread;
+} // namespace util
+
+// Serves mbtiles:// URLs from local MBTiles files. Requesting mbtiles:///path/to/file.mbtiles
+// returns a TileJSON document generated from the metadata table, whose tile URLs point back into
+// the same file.
+class MBTilesFileSource : public FileSource {
+public:
+    MBTilesFileSource();
+    ~MBTilesFileSource() override;
+
+    std::unique_ptr<FileRequest> request(const Resource&, Callback) override;
+
+private:
+    class Impl;
+
+    // The reader threads are only started by the first request.
+    std::once_flag threadsStarted;
+    std::vector<std::unique_ptr<util::Thread<Impl>>> threads;
+    std::atomic<size_t> nextThread { 0 };
+};
+
+} // namespace mbgl
+
+#endif // MBGL_STORAGE_MBTILES_FILE_SOURCE
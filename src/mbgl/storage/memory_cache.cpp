@@ -0,0 +1,133 @@
+#include <mbgl/storage/memory_cache.hpp>
+
+namespace mbgl {
+
+MemoryCache::MemoryCache(uint64_t maximumSize_)
+    : maximumSize(maximumSize_) {
+}
+
+void MemoryCache::setMaximumSize(uint64_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maximumSize = size;
+    evict();
+}
+
+void MemoryCache::setMaximumEntrySize(uint64_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    maximumEntrySize = size;
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (dataSize(*it) > maximumEntrySize) {
+            stats.size -= entrySize(*it);
+            stats.evictions++;
+            index.erase(it->first);
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::unique_ptr<Response> MemoryCache::get(const std::string& url) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!maximumSize) {
+        return nullptr;
+    }
+
+    auto it = index.find(url);
+    if (it == index.end()) {
+        stats.misses++;
+        return nullptr;
+    }
+
+    stats.hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return std::make_unique<Response>(it->second->second);
+}
+
+void MemoryCache::put(const std::string& url, const Response& response) {
+    insert(url, response, true);
+}
+
+void MemoryCache::add(const std::string& url, const Response& response) {
+    insert(url, response, false);
+}
+
+void MemoryCache::insert(const std::string& url, const Response& response, bool replace) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!maximumSize) {
+        return;
+    }
+
+    auto it = index.find(url);
+    if (it != index.end() && !replace) {
+        return;
+    }
+
+    if (it != index.end()) {
+        stats.size -= entrySize(*it->second);
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    // Entries larger than the whole cache would evict everything else.
+    Entry entry { url, response };
+    if (entrySize(entry) > maximumSize || dataSize(entry) > maximumEntrySize) {
+        return;
+    }
+
+    entries.push_front(std::move(entry));
+    if (!entries.front().second.data) {
+        // Match the disk cache, which always returns data, even for empty responses.
+        entries.front().second.data = std::make_shared<std::string>();
+    }
+    entries.front().second.notModified = false;
+    index.emplace(url, entries.begin());
+    stats.size += entrySize(entries.front());
+
+    evict();
+}
+
+void MemoryCache::refresh(const std::string& url, optional<SystemTimePoint> expires) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(url);
+    if (it != index.end()) {
+        it->second->second.expires = expires;
+        entries.splice(entries.begin(), entries, it->second);
+    }
+}
+
+void MemoryCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.evictions += entries.size();
+    stats.size = 0;
+    entries.clear();
+    index.clear();
+}
+
+MemoryCache::Stats MemoryCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result = stats;
+    result.entries = entries.size();
+    return result;
+}
+
+uint64_t MemoryCache::dataSize(const Entry& entry) {
+    return entry.second.data ? entry.second.data->size() : 0;
+}
+
+uint64_t MemoryCache::entrySize(const Entry& entry) {
+    return entry.first.size() + dataSize(entry);
+}
+
+void MemoryCache::evict() {
+    while (!entries.empty() && stats.size > maximumSize) {
+        stats.size -= entrySize(entries.back());
+        index.erase(entries.back().first);
+        entries.pop_back();
+        stats.evictions++;
+    }
+}
+
+} // namespace mbgl
@@ -0,0 +1,69 @@
+#ifndef MBGL_STORAGE_MEMORY_CACHE
+#define MBGL_STORAGE_MEMORY_CACHE
+
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/chrono.hpp>
+#include <mbgl/util/optional.hpp>
+
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace mbgl {
+
+// A byte-bounded, least recently used cache of decoded responses, keyed by canonical URL.
+// Response data is shared with the cached entries and never copied. Can be used from any thread.
+class MemoryCache : private util::noncopyable {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t size = 0;
+        uint64_t entries = 0;
+    };
+
+    // A maximum size of 0 disables the cache.
+    explicit MemoryCache(uint64_t maximumSize = 0);
+
+    void setMaximumSize(uint64_t size);
+
+    // Responses with more data than this are not kept, just like in the database.
+    void setMaximumEntrySize(uint64_t size);
+
+    // Returns nullptr on a miss.
+    std::unique_ptr<Response> get(const std::string& canonicalURL);
+    void put(const std::string& canonicalURL, const Response&);
+    // Like put(), but keeps an existing entry, which is newer than data loaded from disk.
+    void add(const std::string& canonicalURL, const Response&);
+    void refresh(const std::string& canonicalURL, optional<SystemTimePoint> expires);
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    using Entry = std::pair<std::string, Response>;
+
+    static uint64_t dataSize(const Entry&);
+    static uint64_t entrySize(const Entry&);
+    void insert(const std::string& canonicalURL, const Response&, bool replace);
+    void evict();
+
+    uint64_t maximumSize;
+    uint64_t maximumEntrySize = std::numeric_limits<uint64_t>::max();
+    Stats stats;
+
+    // Most recently used entries are at the front.
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+
+    mutable std::mutex mutex;
+};
+
+} // namespace mbgl
+
+#endif
@@ -0,0 +1,292 @@
+#include <mbgl/storage/offline.hpp>
+#include <mbgl/storage/file_source.hpp>
+#include <mbgl/storage/sqlite_cache.hpp>
+
+#include <mbgl/layer/symbol_layer.hpp>
+#include <mbgl/map/source.hpp>
+#include <mbgl/platform/log.hpp>
+#include <mbgl/style/style_calculation_parameters.hpp>
+#include <mbgl/style/style_parser.hpp>
+#include <mbgl/text/glyph.hpp>
+#include <mbgl/util/box.hpp>
+#include <mbgl/util/constants.hpp>
+#include <mbgl/util/mapbox.hpp>
+#include <mbgl/util/math.hpp>
+#include <mbgl/util/tile_cover.hpp>
+
+#include <cmath>
+#include <deque>
+#include <list>
+#include <set>
+
+namespace {
+
+// The number of resources that are requested from the file source at the same time. The file
+// source limits the number of concurrent network requests on its own, but this keeps us from
+// creating requests for every tile in the region at once.
+const size_t kMaximumConcurrentRequests = 20;
+
+// Offline regions download all glyphs of every font, since the labels are not known in advance.
+const uint32_t kGlyphRangeCount = 256;
+
+} // namespace
+
+namespace mbgl {
+
+class OfflineDownload::Impl {
+public:
+    Impl(const OfflineRegionDefinition&, FileSource&, SQLiteCache*, const std::string& accessToken,
+         std::unique_ptr<OfflineRegionObserver>);
+
+    OfflineRegionStatus status;
+
+private:
+    using Callback = std::function<void (const Response&)>;
+
+    void ensureResource(const Resource&, Callback = {});
+    void continueDownload();
+    void pin(const Resource&);
+
+    void queueStyleResources(const std::string& json);
+    void queueTiles(SourceType, uint16_t tileSize, const SourceInfo&);
+
+    int32_t coveringZoomLevel(SourceType, uint16_t tileSize, double zoom) const;
+    box coveringBox(int32_t z) const;
+
+    const OfflineRegionDefinition definition;
+    FileSource& fileSource;
+    SQLiteCache* const cache;
+    const std::string accessToken;
+    const std::unique_ptr<OfflineRegionObserver> observer;
+
+    std::deque<std::pair<Resource, Callback>> queue;
+    std::list<std::unique_ptr<FileRequest>> requests;
+
+    // The number of sources whose TileJSON hasn't been loaded yet. Until then, we don't know
+    // how many tiles have to be downloaded.
+    uint32_t pendingSources = 0;
+    bool styleParsed = false;
+};
+
+OfflineDownload::OfflineDownload(const OfflineRegionDefinition& definition,
+                                 FileSource& fileSource,
+                                 SQLiteCache* cache,
+                                 const std::string& accessToken,
+                                 std::unique_ptr<OfflineRegionObserver> observer)
+    : impl(std::make_unique<Impl>(definition, fileSource, cache, accessToken, std::move(observer))) {
+}
+
+OfflineDownload::~OfflineDownload() = default;
+
+OfflineRegionStatus OfflineDownload::getStatus() const {
+    return impl->status;
+}
+
+OfflineDownload::Impl::Impl(const OfflineRegionDefinition& definition_,
+                            FileSource& fileSource_,
+                            SQLiteCache* cache_,
+                            const std::string& accessToken_,
+                            std::unique_ptr<OfflineRegionObserver> observer_)
+    : definition(definition_),
+      fileSource(fileSource_),
+      cache(cache_),
+      accessToken(accessToken_),
+      observer(observer_ ? std::move(observer_) : std::make_unique<OfflineRegionObserver>()) {
+    ensureResource(Resource::style(definition.styleURL), [this] (const Response& res) {
+        if (res.data) {
+            queueStyleResources(*res.data);
+        }
+        styleParsed = true;
+    });
+}
+
+void OfflineDownload::Impl::ensureResource(const Resource& resource, Callback callback) {
+    status.requiredResourceCount++;
+    queue.emplace_back(resource, callback);
+    continueDownload();
+}
+
+void OfflineDownload::Impl::continueDownload() {
+    while (requests.size() < kMaximumConcurrentRequests && !queue.empty()) {
+        const Resource resource = queue.front().first;
+        const Callback callback = queue.front().second;
+        queue.pop_front();
+
+        requests.emplace_front();
+        auto it = requests.begin();
+
+        // Resources that are already cached are answered from the cache, so they won't be
+        // downloaded again when an interrupted download is restarted.
+        *it = fileSource.request(resource, [this, it, resource, callback] (Response res) {
+            if (res.error && res.error->reason != Response::Error::Reason::NotFound) {
+                observer->responseError(*res.error);
+                if (res.error->reason == Response::Error::Reason::Server ||
+                    res.error->reason == Response::Error::Reason::Connection) {
+                    // The file source retries the request; wait for the next response.
+                    return;
+                }
+            }
+
+            // Releasing the request destroys this lambda, so work with copies from here on.
+            auto self = this;
+            const auto resource_ = resource;
+            const auto callback_ = callback;
+            requests.erase(it);
+
+            if (res.error && res.error->reason != Response::Error::Reason::NotFound) {
+                // Other errors are not retried, so give up on this resource.
+                self->status.failedResourceCount++;
+            } else {
+                self->status.completedResourceCount++;
+                if (res.data) {
+                    self->status.completedResourceSize += res.data->size();
+                }
+
+                self->pin(resource_);
+            }
+
+            if (callback_) {
+                callback_(res);
+            }
+
+            self->status.requiredResourceCountIsPrecise = self->styleParsed && !self->pendingSources;
+            self->observer->statusChanged(self->status);
+            self->continueDownload();
+        });
+    }
+}
+
+void OfflineDownload::Impl::pin(const Resource& resource) {
+    if (!cache) {
+        return;
+    }
+
+    // The online file source stores mapbox:// resources under the URL it requested.
+    try {
+        cache->pin({ resource.kind, util::mapbox::normalizeURL(resource.kind, resource.url, accessToken) });
+    } catch (const std::exception& ex) {
+        Log::Error(Event::Database, "Failed to pin [%s]: %s", resource.url.c_str(), ex.what());
+    }
+}
+
+void OfflineDownload::Impl::queueStyleResources(const std::string& json) {
+    StyleParser parser;
+    parser.parse(json);
+
+    for (const auto& source : parser.sources) {
+        const SourceType type = source->type;
+        const uint16_t tileSize = source->tileSize;
+        const std::string url = source->url;
+
+        switch (type) {
+        case SourceType::Vector:
+        case SourceType::Raster:
+            if (url.empty()) {
+                if (source->getInfo()) {
+                    queueTiles(type, tileSize, *source->getInfo());
+                }
+            } else {
+                pendingSources++;
+                ensureResource(Resource::source(url), [this, type, tileSize, url] (const Response& res) {
+                    pendingSources--;
+                    if (!res.data || res.error) {
+                        return;
+                    }
+
+                    try {
+                        queueTiles(type, tileSize, *StyleParser::parseTileJSON(*res.data, url, type));
+                    } catch (const std::exception& ex) {
+                        Log::Error(Event::ParseStyle, "Failed to parse [%s]: %s", url.c_str(), ex.what());
+                    }
+                });
+            }
+            break;
+
+        case SourceType::GeoJSON:
+            // GeoJSON is tiled on the device, so only the data itself needs to be downloaded.
+            if (!url.empty()) {
+                ensureResource(Resource::source(url));
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    if (!parser.spriteURL.empty()) {
+        ensureResource(Resource::spriteImage(parser.spriteURL, definition.pixelRatio));
+        ensureResource(Resource::spriteJSON(parser.spriteURL, definition.pixelRatio));
+    }
+
+    if (!parser.glyphURL.empty()) {
+        std::set<std::string> fontStacks;
+        for (const auto& layer : parser.layers) {
+            auto symbolLayer = layer->as<SymbolLayer>();
+            if (!symbolLayer || !symbolLayer->layout.text.field.parsedValue) {
+                continue;
+            }
+
+            // The font may be a function of the zoom level.
+            for (double z = std::floor(definition.minZoom); z <= definition.maxZoom; z++) {
+                symbolLayer->layout.text.font.calculate(StyleCalculationParameters(z));
+                fontStacks.insert(symbolLayer->layout.text.font);
+            }
+        }
+
+        for (const auto& fontStack : fontStacks) {
+            for (uint32_t i = 0; i < kGlyphRangeCount; i++) {
+                const GlyphRange range { uint16_t(i * 256), uint16_t(i * 256 + 255) };
+                ensureResource(Resource::glyphs(parser.glyphURL, fontStack, range));
+            }
+        }
+    }
+}
+
+void OfflineDownload::Impl::queueTiles(SourceType type, uint16_t tileSize, const SourceInfo& info) {
+    if (info.tiles.empty()) {
+        return;
+    }
+
+    const int32_t minZ = std::max<int32_t>(coveringZoomLevel(type, tileSize, definition.minZoom), info.minZoom);
+    const int32_t maxZ = std::min<int32_t>(coveringZoomLevel(type, tileSize, definition.maxZoom), info.maxZoom);
+
+    for (int32_t z = minZ; z <= maxZ; z++) {
+        const int32_t tiles = 1 << z;
+        for (const auto& tile : tileCover(z, coveringBox(z), z)) {
+            if (tile.x < 0 || tile.x >= tiles || tile.y < 0 || tile.y >= tiles) {
+                continue;
+            }
+            ensureResource(Resource::tile(info.tiles.front(), definition.pixelRatio, tile.x, tile.y, z));
+        }
+    }
+}
+
+int32_t OfflineDownload::Impl::coveringZoomLevel(SourceType type, uint16_t tileSize, double zoom) const {
+    // Mirrors Source::coveringZoomLevel(), so that we download the tiles the renderer will request.
+    zoom += std::log(util::tileSize / tileSize) / std::log(2);
+    if (type == SourceType::Raster) {
+        return ::round(zoom);
+    } else {
+        return std::floor(zoom);
+    }
+}
+
+box OfflineDownload::Impl::coveringBox(int32_t z) const {
+    const double scale = std::pow(2, z);
+    auto coordinate = [&] (const LatLng& latLng) {
+        const double lat = util::clamp(latLng.latitude, -util::LATITUDE_MAX, util::LATITUDE_MAX);
+        const double y = 180 / M_PI * std::log(std::tan(M_PI / 4 + lat * M_PI / 360));
+        return TileCoordinate {
+            (180 + latLng.longitude) / 360 * scale,
+            (180 - y) / 360 * scale,
+            double(z)
+        };
+    };
+
+    const LatLngBounds& bounds = definition.bounds;
+    return box(coordinate(bounds.northwest()), coordinate(bounds.northeast()),
+               coordinate(bounds.southeast()), coordinate(bounds.southwest()));
+}
+
+} // namespace mbgl
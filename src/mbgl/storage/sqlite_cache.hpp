@@ -1,6 +1,7 @@
 #ifndef MBGL_STORAGE_DEFAULT_SQLITE_CACHE
 #define MBGL_STORAGE_DEFAULT_SQLITE_CACHE
 
+#include <mbgl/storage/memory_cache.hpp>
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/chrono.hpp>
 
@@ -28,14 +29,38 @@ public:
     void setMaximumCacheSize(uint64_t size);
     void setMaximumCacheEntrySize(uint64_t size);
 
+    // Controls how often SQLite syncs the write-ahead log to disk. Off is the fastest
+    // but a crash of the OS may corrupt the cache; Normal is safe for a cache.
+    enum class Synchronous : uint8_t { Off = 0, Normal = 1, Full = 2 };
+    void setSynchronous(Synchronous);
+
+    // Writes are queued and committed in a single transaction once either the interval
+    // elapsed or the given number of entries is pending. Queued entries are visible to
+    // get() before they are committed.
+    void setWriteBatching(Duration interval, uint32_t maximumEntries);
+
+    // Compresses tiles with a deflate dictionary that is built from the first tiles written to
+    // the cache and stored in the database. Small tiles barely shrink without one.
+    void setDictionaryCompression(bool);
+
+    // Recently used responses are kept in memory and returned without querying the database.
+    // Caches obtained with getShared() have a memory cache by default; a size of 0 disables it.
+    void setMaximumMemoryCacheSize(uint64_t size);
+    MemoryCache::Stats getMemoryCacheStats() const;
+
     using Callback = std::function<void(std::unique_ptr<Response>)>;
 
     std::unique_ptr<WorkRequest> get(const Resource&, Callback);
     void put(const Resource&, const Response&);
 
+    // Pinned entries are never pruned, e.g. because they belong to an offline region.
+    void pin(const Resource&);
+    void unpin(const Resource&);
+
     class Impl;
 
 private:
+    const std::shared_ptr<MemoryCache> memory;
     const std::unique_ptr<util::Thread<Impl>> thread;
 };
 
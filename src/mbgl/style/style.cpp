@@ -34,7 +34,7 @@ Style::Style(MapData& data_)
       spriteStore(std::make_unique<SpriteStore>(data.pixelRatio)),
       spriteAtlas(std::make_unique<SpriteAtlas>(1024, 1024, data.pixelRatio, *spriteStore)),
       lineAtlas(std::make_unique<LineAtlas>(512, 512)),
-      workers(4) {
+      workers(data.workerThreadCount) {
     glyphStore->setObserver(this);
     spriteStore->setObserver(this);
 }
@@ -142,6 +142,13 @@ void Style::update(const TransformState& transform,
     }
 }
 
+void Style::prefetch(const std::vector<TransformState>& path) {
+    prefetchPath = path;
+    for (const auto& source : sources) {
+        source->prefetch(path, data.pixelRatio);
+    }
+}
+
 void Style::cascade() {
     std::vector<ClassID> classes;
 
@@ -317,6 +324,11 @@ void Style::onGlyphsError(const std::string& fontStack, const GlyphRange& glyphR
 }
 
 void Style::onSourceLoaded(Source& source) {
+    // Sources only know their tiles once they are loaded.
+    if (!prefetchPath.empty()) {
+        source.prefetch(prefetchPath, data.pixelRatio);
+    }
+
     observer->onSourceLoaded(source);
     observer->onResourceLoaded();
 }
@@ -369,6 +381,7 @@ void Style::dumpDebugLogs() const {
     }
 
     spriteStore->dumpDebugLogs();
+    glyphAtlas->dumpDebugLogs();
 }
 
 } // namespace mbgl
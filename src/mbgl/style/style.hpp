@@ -81,6 +81,10 @@ public:
     // a tile is ready so observers can render the tile.
     void update(const TransformState&, TexturePool&);
 
+    // Requests the tiles for the given camera states ahead of time, e.g. along the path of an
+    // animation. Replaces the previously prefetched tiles; an empty list cancels prefetching.
+    void prefetch(const std::vector<TransformState>&);
+
     void cascade();
     void recalculate(float z);
 
@@ -144,6 +148,9 @@ private:
     ZoomHistory zoomHistory;
     bool hasPendingTransitions = false;
 
+    // The camera states that are currently prefetched, for sources that finish loading later.
+    std::vector<TransformState> prefetchPath;
+
 public:
     bool loaded = false;
     Worker workers;
@@ -2,16 +2,11 @@
 #define STYLE_BUCKET_PARAMETERS
 
 #include <mbgl/map/mode.hpp>
-#include <mbgl/style/filter_expression.hpp>
 #include <mbgl/map/tile_data.hpp>
 
-#include <functional>
-
 namespace mbgl {
 
 class TileID;
-class GeometryTileLayer;
-class GeometryTileFeature;
 class SpriteStore;
 class GlyphAtlas;
 class GlyphStore;
@@ -20,7 +15,6 @@ class CollisionTile;
 class StyleBucketParameters {
 public:
     StyleBucketParameters(const TileID& tileID_,
-                          const GeometryTileLayer& layer_,
                           const std::atomic<TileData::State>& state_,
                           uintptr_t tileUID_,
                           bool& partialParse_,
@@ -29,7 +23,6 @@ public:
                           GlyphStore& glyphStore_,
                           const MapMode mode_)
         : tileID(tileID_),
-          layer(layer_),
           state(state_),
           tileUID(tileUID_),
           partialParse(partialParse_),
@@ -42,10 +35,7 @@ public:
         return state == TileData::State::obsolete;
     }
 
-    void eachFilteredFeature(const FilterExpression&, std::function<void (const GeometryTileFeature&)>);
-
     const TileID& tileID;
-    const GeometryTileLayer& layer;
     const std::atomic<TileData::State>& state;
     uintptr_t tileUID;
     bool& partialParse;
@@ -45,7 +45,10 @@ public:
     // Returns true if any paint properties have active transitions.
     virtual bool recalculate(const StyleCalculationParameters&) = 0;
 
+    // Creates an empty bucket for a tile. The tile worker then adds the features of the source
+    // layer that match the filter, and calls finishBucket() once all of them have been added.
     virtual std::unique_ptr<Bucket> createBucket(StyleBucketParameters&) const = 0;
+    virtual void finishBucket(Bucket&, StyleBucketParameters&) const {}
 
     // Checks whether this layer needs to be rendered in the given render pass.
     bool hasRenderPass(RenderPass) const;
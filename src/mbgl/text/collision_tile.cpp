@@ -6,7 +6,15 @@ namespace mbgl {
 
 auto infinity = std::numeric_limits<float>::infinity();
 
-CollisionTile::CollisionTile(PlacementConfig config_) : config(config_),
+namespace {
+
+// The grid covers the tile and this much around it, and is made of square cells of this size.
+const float kGridBuffer = util::EXTENT / 8;
+const float kGridCellSize = util::EXTENT / 16;
+
+} // namespace
+
+CollisionTile::CollisionTile(PlacementConfig config_) : config(config_), grid(kGridCellSize),
     edges({{
         // left
         CollisionBox(vec2<float>(0, 0), 0, -infinity, 0, infinity, infinity),
@@ -17,7 +25,11 @@ CollisionTile::CollisionTile(PlacementConfig config_) : config(config_),
         // bottom
         CollisionBox(vec2<float>(0, util::EXTENT), -infinity, 0, infinity, 0, infinity),
     }}) {
-    tree.clear();
+    reset(config_);
+}
+
+void CollisionTile::reset(PlacementConfig config_) {
+    config = config_;
 
     // Compute the transformation matrix.
     const float angle_sin = std::sin(config.angle);
@@ -31,6 +43,19 @@ CollisionTile::CollisionTile(PlacementConfig config_) : config(config_),
     // The amount the map is squished depends on the y position.
     // Sort of account for this by making all boxes a bit bigger.
     yStretch = std::pow(_yStretch, 1.3);
+
+    // Boxes are indexed around their rotated anchors, so the grid covers the rotated tile.
+    float x1 = infinity, y1 = infinity, x2 = -infinity, y2 = -infinity;
+    for (const float x : { -kGridBuffer, util::EXTENT + kGridBuffer }) {
+        for (const float y : { -kGridBuffer, util::EXTENT + kGridBuffer }) {
+            const auto corner = vec2<float>(x, y).matMul(rotationMatrix);
+            x1 = ::fmin(x1, corner.x);
+            y1 = ::fmin(y1, corner.y);
+            x2 = ::fmax(x2, corner.x);
+            y2 = ::fmax(y2, corner.y);
+        }
+    }
+    grid.reset(x1, y1, x2, y2);
 }
 
 
@@ -82,16 +107,13 @@ float CollisionTile::placeFeature(const CollisionFeature &feature, const bool al
         const auto anchor = box.anchor.matMul(rotationMatrix);
 
         if (!allowOverlap) {
-            std::vector<CollisionTreeBox> blockingBoxes;
-            tree.query(bgi::intersects(getTreeBox(anchor, box)), std::back_inserter(blockingBoxes));
-
-            for (auto& blockingTreeBox : blockingBoxes) {
-                const auto& blocking = std::get<1>(blockingTreeBox);
+            grid.query(getGridBox(anchor, box), [&] (const CollisionBox& blocking) {
                 auto blockingAnchor = blocking.anchor.matMul(rotationMatrix);
 
                 minPlacementScale = findPlacementScale(minPlacementScale, anchor, box, blockingAnchor, blocking);
-                if (minPlacementScale >= maxScale) return minPlacementScale;
-            }
+                return minPlacementScale < maxScale;
+            });
+            if (minPlacementScale >= maxScale) return minPlacementScale;
         }
 
         if (avoidEdges) {
@@ -127,25 +149,19 @@ void CollisionTile::insertFeature(CollisionFeature &feature, const float minPlac
     }
 
     if (minPlacementScale < maxScale) {
-        std::vector<CollisionTreeBox> treeBoxes;
         for (auto& box : feature.boxes) {
-            treeBoxes.emplace_back(getTreeBox(box.anchor.matMul(rotationMatrix), box), box);
+            grid.insert(box, getGridBox(box.anchor.matMul(rotationMatrix), box));
         }
-        tree.insert(treeBoxes.begin(), treeBoxes.end());
     }
 
 }
 
-Box CollisionTile::getTreeBox(const vec2<float> &anchor, const CollisionBox &box) {
-    return Box{
-        CollisionPoint{
-            anchor.x + box.x1,
-            anchor.y + box.y1 * yStretch
-        },
-        CollisionPoint{
-            anchor.x + box.x2,
-            anchor.y + box.y2 * yStretch
-        }
+CollisionTile::Grid::BBox CollisionTile::getGridBox(const vec2<float> &anchor, const CollisionBox &box) {
+    return Grid::BBox{
+        anchor.x + box.x1,
+        anchor.y + box.y1 * yStretch,
+        anchor.x + box.x2,
+        anchor.y + box.y2 * yStretch
     };
 }
 
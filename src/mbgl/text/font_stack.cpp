@@ -5,7 +5,18 @@
 
 namespace mbgl {
 
+namespace {
+
+// The number of shapings that a font stack keeps. The cache starts over when it is full.
+const std::size_t kMaxCachedShapings = 4096;
+
+} // namespace
+
 void FontStack::insert(uint32_t id, const SDFGlyph &glyph) {
+    // Shapings leave out glyphs that are missing, and depend on the metrics of the others.
+    shapings.clear();
+
+
     auto it = sdfs.find(id);
     if (it == sdfs.end()) {
         // Glyph doesn't exist yet.
@@ -33,6 +44,27 @@ const Shaping FontStack::getShaping(const std::u32string &string, const float ma
                                     const float lineHeight, const float horizontalAlign,
                                     const float verticalAlign, const float justify,
                                     const float spacing, const vec2<float> &translate) const {
+    ShapingKey key(string, maxWidth, lineHeight, horizontalAlign, verticalAlign, justify, spacing,
+                   translate.x, translate.y);
+    auto it = shapings.find(key);
+    if (it != shapings.end()) {
+        return it->second;
+    }
+
+    if (shapings.size() >= kMaxCachedShapings) {
+        shapings.clear();
+    }
+
+    Shaping shaping = shape(string, maxWidth, lineHeight, horizontalAlign, verticalAlign, justify,
+                            spacing, translate);
+    shapings.emplace(std::move(key), shaping);
+    return shaping;
+}
+
+Shaping FontStack::shape(const std::u32string &string, const float maxWidth,
+                         const float lineHeight, const float horizontalAlign,
+                         const float verticalAlign, const float justify,
+                         const float spacing, const vec2<float> &translate) const {
     Shaping shaping(translate.x * 24, translate.y * 24, string);
 
     // the y offset *should* be part of the font metadata
@@ -4,12 +4,18 @@
 #include <mbgl/text/glyph.hpp>
 #include <mbgl/util/vec.hpp>
 
+#include <map>
+#include <tuple>
+
 namespace mbgl {
 
 class FontStack {
 public:
     void insert(uint32_t id, const SDFGlyph &glyph);
     const std::map<uint32_t, SDFGlyph> &getSDFs() const;
+
+    // Returns the shaping of a label, which is cached until the glyphs of this stack change. Labels
+    // such as road and place names repeat across tiles and zoom levels.
     const Shaping getShaping(const std::u32string &string, float maxWidth, float lineHeight,
                              float horizontalAlign, float verticalAlign, float justify,
                              float spacing, const vec2<float> &translate) const;
@@ -17,7 +23,15 @@ public:
                   float verticalAlign, float justify, const vec2<float> &translate) const;
 
 private:
+    Shaping shape(const std::u32string &string, float maxWidth, float lineHeight,
+                  float horizontalAlign, float verticalAlign, float justify,
+                  float spacing, const vec2<float> &translate) const;
+
     std::map<uint32_t, SDFGlyph> sdfs;
+
+    // Font stacks are only used while they are locked, see GlyphStore::getFontStack().
+    using ShapingKey = std::tuple<std::u32string, float, float, float, float, float, float, float, float>;
+    mutable std::map<ShapingKey, Shaping> shapings;
 };
 
 } // end namespace mbgl
@@ -1,6 +1,8 @@
 #ifndef MBGL_TEXT_PLACEMENT_CONFIG
 #define MBGL_TEXT_PLACEMENT_CONFIG
 
+#include <cmath>
+
 namespace mbgl {
 
 class PlacementConfig {
@@ -17,6 +19,12 @@ public:
         return !operator==(rhs);
     }
 
+    // Rounds the angle and the pitch to multiples of `step` radians, so that configurations
+    // which differ by less than a step compare equal and share one placement.
+    inline PlacementConfig quantized(float step) const {
+        return { std::round(angle / step) * step, std::round(pitch / step) * step, debug };
+    }
+
 public:
     float angle;
     float pitch;
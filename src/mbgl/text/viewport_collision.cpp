@@ -0,0 +1,94 @@
+#include <mbgl/text/viewport_collision.hpp>
+#include <mbgl/util/constants.hpp>
+
+#include <cmath>
+
+namespace mbgl {
+
+namespace {
+
+// Labels are a few hundred pixels wide at most, so most of them fit into a few cells.
+const float kGridCellSize = 64;
+
+} // namespace
+
+ViewportCollision::ViewportCollision() : grid(kGridCellSize) {
+}
+
+void ViewportCollision::reset(PlacementConfig config, double zoom_, double centerX_, double centerY_, float radius) {
+    zoom = zoom_;
+    centerX = centerX_;
+    centerY = centerY_;
+
+    const float angle_sin = std::sin(config.angle);
+    const float angle_cos = std::cos(config.angle);
+    rotationMatrix = { { angle_cos, -angle_sin, angle_sin, angle_cos } };
+
+    // Stretch boxes in y direction to account for the map tilt, like CollisionTile does.
+    yStretch = std::pow(1.0f / std::cos(config.pitch), 1.3);
+
+    // Boxes are indexed around the center of the map, which the rotation doesn't move.
+    grid.reset(-radius, -radius * yStretch, radius, radius * yStretch);
+}
+
+void ViewportCollision::place(const TileID& id, const PlacedSymbols& symbols, std::vector<bool>& hidden) {
+    // The scale of the map relative to the zoom level of the tile; symbols are shown from their
+    // placement scale on.
+    const double scale = std::pow(2, zoom - id.z);
+
+    // Anchors are measured in tile units of the source tile, which overscaled tiles stretch.
+    // Collision boxes are measured in tile units at the zoom level of the tile, like in the
+    // painter.
+    const float boxScale = util::tileSize * id.overscaling / util::EXTENT;
+    const double anchorScale = double(util::tileSize) / util::EXTENT * std::pow(2, zoom - id.sourceZ);
+
+    hidden.assign(symbols.ends.size(), false);
+
+    uint32_t begin = 0;
+    for (std::size_t i = 0; i < symbols.ends.size(); i++) {
+        const uint32_t end = symbols.ends[i];
+        bool collides = false;
+        symbolBoxes.clear();
+
+        for (uint32_t b = begin; b < end && !collides; b++) {
+            const PlacedBox& placed = symbols.boxes[b];
+            const CollisionBox& box = placed.box;
+            if (box.placementScale > scale || box.maxScale <= scale) {
+                // The tile doesn't show this box at this zoom level.
+                continue;
+            }
+
+            const vec2<float> anchor = vec2<float>(
+                (double(id.x) * util::EXTENT + box.anchor.x) * anchorScale - centerX,
+                (double(id.y) * util::EXTENT + box.anchor.y) * anchorScale - centerY).matMul(rotationMatrix);
+            const Grid::BBox bbox {
+                anchor.x + box.x1 * boxScale,
+                anchor.y + box.y1 * boxScale * yStretch,
+                anchor.x + box.x2 * boxScale,
+                anchor.y + box.y2 * boxScale * yStretch
+            };
+
+            if (!placed.allowOverlap) {
+                // Symbols of the same tile were placed against each other already.
+                grid.query(bbox, [&] (const TileID& other) {
+                    collides = other != id;
+                    return !collides;
+                });
+            }
+            if (!placed.ignorePlacement) {
+                symbolBoxes.push_back(bbox);
+            }
+        }
+
+        if (collides) {
+            hidden[i] = true;
+        } else {
+            for (const auto& bbox : symbolBoxes) {
+                grid.insert(id, bbox);
+            }
+        }
+        begin = end;
+    }
+}
+
+} // namespace mbgl
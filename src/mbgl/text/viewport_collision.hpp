@@ -0,0 +1,71 @@
+#ifndef MBGL_TEXT_VIEWPORT_COLLISION
+#define MBGL_TEXT_VIEWPORT_COLLISION
+
+#include <mbgl/map/tile_id.hpp>
+#include <mbgl/text/collision_feature.hpp>
+#include <mbgl/text/placement_config.hpp>
+#include <mbgl/util/grid_index.hpp>
+#include <mbgl/util/noncopyable.hpp>
+
+#include <array>
+#include <vector>
+
+namespace mbgl {
+
+// A collision box of a symbol that its tile placed. The placement scale of the box is the scale
+// from which on the tile shows the text or the icon that the box belongs to.
+struct PlacedBox {
+    CollisionBox box;
+
+    // The symbol stays visible when this box overlaps symbols of other tiles.
+    bool allowOverlap;
+
+    // Symbols of other tiles may overlap this box.
+    bool ignorePlacement;
+};
+
+// The symbols of a bucket as its tile placed them.
+struct PlacedSymbols {
+    std::vector<PlacedBox> boxes;
+
+    // For every symbol, the index in `boxes` after its last box.
+    std::vector<uint32_t> ends;
+};
+
+// Tiles place their symbols on their own, so symbols of neighbouring tiles may overlap at the
+// tile borders. This resolves those collisions for the tiles that are shown together: tiles are
+// placed one after another, and a symbol is hidden when it collides with a symbol of a tile that
+// was placed before.
+//
+// Boxes are compared in pixels at the zoom level of the map, around the center of the map and
+// rotated with it, like CollisionTile does within a tile.
+class ViewportCollision : private util::noncopyable {
+public:
+    ViewportCollision();
+
+    // Starts a new pass for the map at `zoom`, with its center at (centerX, centerY) in world
+    // pixels. Most symbols are expected within `radius` pixels of the center.
+    void reset(PlacementConfig, double zoom, double centerX, double centerY, float radius);
+
+    // Places the symbols of a bucket of this tile, and sets `hidden` to whether each symbol collides
+    // with a symbol of another tile.
+    void place(const TileID&, const PlacedSymbols&, std::vector<bool>& hidden);
+
+private:
+    using Grid = util::GridIndex<TileID>;
+
+    double zoom = 0;
+    double centerX = 0;
+    double centerY = 0;
+    float yStretch = 1;
+    std::array<float, 4> rotationMatrix;
+
+    Grid grid;
+
+    // The boxes of the symbol that is being placed, for inserting them after they were checked.
+    std::vector<Grid::BBox> symbolBoxes;
+};
+
+} // namespace mbgl
+
+#endif
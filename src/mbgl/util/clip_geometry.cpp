@@ -0,0 +1,165 @@
+#include <mbgl/util/clip_geometry.hpp>
+
+#include <cmath>
+
+namespace mbgl {
+namespace util {
+
+namespace {
+
+Coordinate interpolate(const Coordinate& a, const Coordinate& b, float t) {
+    return { static_cast<int16_t>(std::round(a.x + (b.x - a.x) * t)),
+             static_cast<int16_t>(std::round(a.y + (b.y - a.y) * t)) };
+}
+
+// Clips the ring against a single edge of the box. `distance` is positive inside of the box.
+template <class Distance>
+void clipRing(const std::vector<Coordinate>& input, std::vector<Coordinate>& output, Distance distance) {
+    output.clear();
+    if (input.empty()) {
+        return;
+    }
+
+    Coordinate previous = input.back();
+    float previousDistance = distance(previous);
+
+    for (const auto& point : input) {
+        const float pointDistance = distance(point);
+        if ((previousDistance >= 0) != (pointDistance >= 0)) {
+            output.push_back(interpolate(previous, point, previousDistance / (previousDistance - pointDistance)));
+        }
+        if (pointDistance >= 0) {
+            output.push_back(point);
+        }
+        previous = point;
+        previousDistance = pointDistance;
+    }
+}
+
+// Returns the next ring of `result`, which keeps the storage it had before.
+std::vector<Coordinate>& nextRing(GeometryCollection& result, std::size_t count) {
+    if (count == result.size()) {
+        result.emplace_back();
+    }
+    result[count].clear();
+    return result[count];
+}
+
+} // namespace
+
+bool exceedsBox(const GeometryCollection& geometries, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    for (const auto& line : geometries) {
+        for (const auto& point : line) {
+            if (point.x < x1 || point.x > x2 || point.y < y1 || point.y > y2) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+GeometryCollection clipPolygons(const GeometryCollection& rings, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    GeometryCollection result;
+    clipPolygons(rings, result, x1, y1, x2, y2);
+    return result;
+}
+
+GeometryCollection clipLineStrings(const GeometryCollection& lines, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    GeometryCollection result;
+    clipLineStrings(lines, result, x1, y1, x2, y2);
+    return result;
+}
+
+void clipPolygons(const GeometryCollection& rings, GeometryCollection& result, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    std::size_t count = 0;
+    std::vector<Coordinate> b;
+
+    for (const auto& ring : rings) {
+        // The first point of a closed ring is repeated at its end; drop it while clipping.
+        const bool closed = ring.size() > 1 && ring.front() == ring.back();
+        std::vector<Coordinate>& a = nextRing(result, count);
+        a.assign(ring.begin(), closed ? ring.end() - 1 : ring.end());
+
+        clipRing(a, b, [x1] (const Coordinate& p) { return float(p.x - x1); });
+        clipRing(b, a, [x2] (const Coordinate& p) { return float(x2 - p.x); });
+        clipRing(a, b, [y1] (const Coordinate& p) { return float(p.y - y1); });
+        clipRing(b, a, [y2] (const Coordinate& p) { return float(y2 - p.y); });
+
+        if (a.size() < 3) {
+            continue;
+        }
+
+        if (closed) {
+            a.push_back(a.front());
+        }
+        count++;
+    }
+
+    result.resize(count);
+}
+
+void clipLineStrings(const GeometryCollection& lines, GeometryCollection& result, int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    std::size_t count = 0;
+
+    for (const auto& line : lines) {
+        const std::size_t first = count;
+
+        // Whether the last line in the result still continues with the next segment.
+        bool open = false;
+
+        for (std::size_t i = 1; i < line.size(); i++) {
+            const Coordinate& a = line[i - 1];
+            const Coordinate& b = line[i];
+
+            // Liang-Barsky: find the part [t0, t1] of the segment that lies inside of the box.
+            const float dx = b.x - a.x;
+            const float dy = b.y - a.y;
+            const float p[4] = { -dx, dx, -dy, dy };
+            const float q[4] = { float(a.x - x1), float(x2 - a.x), float(a.y - y1), float(y2 - a.y) };
+
+            float t0 = 0;
+            float t1 = 1;
+            bool inside = true;
+            for (int k = 0; k < 4 && inside; k++) {
+                if (p[k] == 0) {
+                    inside = q[k] >= 0;
+                } else {
+                    const float t = q[k] / p[k];
+                    if (p[k] < 0) {
+                        if (t > t1) inside = false;
+                        else if (t > t0) t0 = t;
+                    } else {
+                        if (t < t0) inside = false;
+                        else if (t < t1) t1 = t;
+                    }
+                }
+            }
+
+            if (!inside) {
+                open = false;
+                continue;
+            }
+
+            if (!open || t0 > 0) {
+                nextRing(result, count++).push_back(t0 > 0 ? interpolate(a, b, t0) : a);
+            }
+            result[count - 1].push_back(t1 < 1 ? interpolate(a, b, t1) : b);
+            open = t1 == 1;
+        }
+
+        // A closed ring that was cut open at its start continues across it, so that the start
+        // gets a regular join instead of two caps.
+        if (count - first > 1 && line.front() == line.back() &&
+            result[first].front() == line.front() && result[count - 1].back() == line.back()) {
+            auto& last = result[count - 1];
+            last.insert(last.end(), result[first].begin() + 1, result[first].end());
+            std::swap(result[first], last);
+            count--;
+        }
+    }
+
+    result.resize(count);
+}
+
+} // namespace util
+} // namespace mbgl
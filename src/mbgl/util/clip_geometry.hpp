@@ -0,0 +1,28 @@
+#ifndef MBGL_UTIL_CLIP_GEOMETRY
+#define MBGL_UTIL_CLIP_GEOMETRY
+
+#include <mbgl/map/geometry_tile.hpp>
+
+namespace mbgl {
+namespace util {
+
+// Whether any point lies outside of the box from (x1, y1) to (x2, y2), inclusive.
+bool exceedsBox(const GeometryCollection&, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+
+// Clips every ring on its own with the Sutherland-Hodgman algorithm. Parts of a ring that lie
+// outside of the box are replaced by edges along the box, so the area inside the box is the
+// same as before with both even-odd and nonzero filling. Rings that vanish are dropped.
+GeometryCollection clipPolygons(const GeometryCollection&, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+
+// Clips every line to the box. Lines that leave and reenter the box are split in several lines.
+GeometryCollection clipLineStrings(const GeometryCollection&, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+
+// Like the above, but write into `result`, reusing the storage of the rings that are already
+// there. `result` must not be the input.
+void clipPolygons(const GeometryCollection&, GeometryCollection& result, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+void clipLineStrings(const GeometryCollection&, GeometryCollection& result, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+
+} // namespace util
+} // namespace mbgl
+
+#endif
@@ -1,7 +1,10 @@
 #include "compression.hpp"
 
+#include <mbgl/util/thread_local.hpp>
+
 #include <zlib.h>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <stdexcept>
@@ -24,77 +27,234 @@ const static bool zlibVersionCheck = []() {
 
 #pragma GCC diagnostic pop
 
+namespace {
+
+// Setting up a deflate stream allocates a few hundred KB of state, so every thread keeps one
+// stream for each direction and resets it between calls. Most threads only ever inflate, so each
+// stream is only set up when it is first used.
+class Streams {
+public:
+    Streams() {
+        memset(&deflateStream, 0, sizeof(deflateStream));
+        memset(&inflateStream, 0, sizeof(inflateStream));
+    }
+
+    ~Streams() {
+        if (deflateReady) {
+            deflateEnd(&deflateStream);
+        }
+        if (inflateReady) {
+            inflateEnd(&inflateStream);
+        }
+    }
+
+    z_stream& deflater() {
+        if (!deflateReady) {
+            if (deflateInit(&deflateStream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+                throw std::runtime_error("failed to initialize deflate");
+            }
+            deflateReady = true;
+        }
+        return deflateStream;
+    }
+
+    z_stream& inflater() {
+        if (!inflateReady) {
+            // Accept both zlib and gzip headers; MBTiles typically stores gzipped vector tiles.
+            if (inflateInit2(&inflateStream, MAX_WBITS + 32) != Z_OK) {
+                throw std::runtime_error("failed to initialize inflate");
+            }
+            inflateReady = true;
+        }
+        return inflateStream;
+    }
+
+private:
+    z_stream deflateStream;
+    z_stream inflateStream;
+    bool deflateReady = false;
+    bool inflateReady = false;
+};
+
+Streams& threadStreams() {
+    static mbgl::util::ThreadLocal<Streams>& streams = *new mbgl::util::ThreadLocal<Streams>;
+    if (!streams.get()) {
+        streams.set(new Streams);
+    }
+    return *streams.get();
+}
+
+} // namespace
+
 namespace mbgl {
 namespace util {
 
-std::string compress(const std::string &raw) {
-    z_stream deflate_stream;
-    memset(&deflate_stream, 0, sizeof(deflate_stream));
+std::string compress(const std::string &raw, const std::string &dictionary) {
+    z_stream &deflate_stream = threadStreams().deflater();
+    if (deflateReset(&deflate_stream) != Z_OK) {
+        throw std::runtime_error("failed to reset deflate");
+    }
 
-    // TODO: reuse z_streams
-    if (deflateInit(&deflate_stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
-        throw std::runtime_error("failed to initialize deflate");
+    if (!dictionary.empty() &&
+        deflateSetDictionary(&deflate_stream, reinterpret_cast<const Bytef *>(dictionary.data()),
+                             uInt(dictionary.size())) != Z_OK) {
+        throw std::runtime_error("failed to set deflate dictionary");
     }
 
     deflate_stream.next_in = (Bytef *)raw.data();
     deflate_stream.avail_in = uInt(raw.size());
 
+    // The bound is large enough to deflate everything in a single call.
     std::string result;
-    char out[16384];
-
-    int code;
-    do {
-        deflate_stream.next_out = reinterpret_cast<Bytef *>(out);
-        deflate_stream.avail_out = sizeof(out);
-        code = deflate(&deflate_stream, Z_FINISH);
-        if (result.size() < deflate_stream.total_out) {
-            // append the block to the output string
-            result.append(out, deflate_stream.total_out - result.size());
-        }
-    } while (code == Z_OK);
-
-    deflateEnd(&deflate_stream);
+    result.resize(deflateBound(&deflate_stream, uLong(raw.size())));
+    deflate_stream.next_out = reinterpret_cast<Bytef *>(&result[0]);
+    deflate_stream.avail_out = uInt(result.size());
 
+    const int code = deflate(&deflate_stream, Z_FINISH);
     if (code != Z_STREAM_END) {
-        throw std::runtime_error(deflate_stream.msg);
+        throw std::runtime_error(deflate_stream.msg ? deflate_stream.msg : "compression error");
     }
 
+    result.resize(deflate_stream.total_out);
     return result;
 }
 
-std::string decompress(const std::string &raw) {
-    z_stream inflate_stream;
-    memset(&inflate_stream, 0, sizeof(inflate_stream));
+std::string decompress(const std::string &raw, const std::string &dictionary) {
+    return decompress(raw.data(), raw.size(), dictionary);
+}
 
-    // TODO: reuse z_streams
-    if (inflateInit(&inflate_stream) != Z_OK) {
-        throw std::runtime_error("failed to initialize inflate");
+std::string decompress(const char *raw, size_t size, const std::string &dictionary) {
+    z_stream &inflate_stream = threadStreams().inflater();
+    if (inflateReset(&inflate_stream) != Z_OK) {
+        throw std::runtime_error("failed to reset inflate");
     }
 
-    inflate_stream.next_in = (Bytef *)raw.data();
-    inflate_stream.avail_in = uInt(raw.size());
+    inflate_stream.next_in = (Bytef *)raw;
+    inflate_stream.avail_in = uInt(size);
 
+    // Inflate straight into the result instead of going through a separate buffer. Tiles
+    // typically compress to a quarter of their size or better, so this usually needs no
+    // reallocation.
     std::string result;
-    char out[15384];
+    result.resize(std::max<size_t>(size * 4, 1024));
 
     int code;
     do {
-        inflate_stream.next_out = reinterpret_cast<Bytef *>(out);
-        inflate_stream.avail_out = sizeof(out);
-        code = inflate(&inflate_stream, 0);
-        // result.append(out, sizeof(out) - inflate_stream.avail_out);
-        if (result.size() < inflate_stream.total_out) {
-            result.append(out, inflate_stream.total_out - result.size());
+        if (inflate_stream.total_out == result.size()) {
+            result.resize(result.size() * 2);
         }
-    } while (code == Z_OK);
+        inflate_stream.next_out = reinterpret_cast<Bytef *>(&result[inflate_stream.total_out]);
+        inflate_stream.avail_out = uInt(result.size() - inflate_stream.total_out);
+        code = inflate(&inflate_stream, Z_NO_FLUSH);
 
-    inflateEnd(&inflate_stream);
+        if (code == Z_NEED_DICT) {
+            // The data was compressed with a preset dictionary.
+            if (dictionary.empty()) {
+                throw std::runtime_error("decompression requires a dictionary");
+            }
+            code = inflateSetDictionary(&inflate_stream, reinterpret_cast<const Bytef *>(dictionary.data()),
+                                        uInt(dictionary.size()));
+        }
+    } while (code == Z_OK);
 
     if (code != Z_STREAM_END) {
         throw std::runtime_error(inflate_stream.msg ? inflate_stream.msg : "decompression error");
     }
 
+    result.resize(inflate_stream.total_out);
     return result;
 }
+
+std::string trainDictionary(const std::vector<std::shared_ptr<const std::string>> &samples, size_t maximumSize) {
+    // Counts in how many samples each 8 byte sequence occurs. Sequences are bucketed by hash, so
+    // the counts are approximate, which is fine for picking content.
+    const size_t sequenceLength = 8;
+    const size_t tableSize = 1 << 18;
+    std::vector<uint32_t> counts(tableSize, 0);
+    std::vector<uint32_t> lastSample(tableSize, 0);
+
+    auto hash = [&](const char *data) {
+        uint64_t value;
+        memcpy(&value, data, sizeof(value));
+        return size_t((value * 0x9E3779B97F4A7C15ull) >> 46) & (tableSize - 1);
+    };
+
+    for (size_t i = 0; i < samples.size(); i++) {
+        const std::string &sample = *samples[i];
+        for (size_t pos = 0; pos + sequenceLength <= sample.size(); pos++) {
+            const size_t h = hash(&sample[pos]);
+            if (lastSample[h] != i + 1) {
+                lastSample[h] = uint32_t(i + 1);
+                counts[h]++;
+            }
+        }
+    }
+
+    // Scores a segment by the sequences in it that also occur in other samples.
+    const size_t segmentLength = 64;
+    auto score = [&](const std::string &sample, size_t offset) {
+        uint64_t result = 0;
+        for (size_t pos = offset; pos + sequenceLength <= offset + segmentLength; pos++) {
+            const uint32_t count = counts[hash(&sample[pos])];
+            if (count > 1) {
+                result += count;
+            }
+        }
+        return result;
+    };
+
+    struct Segment {
+        uint64_t score;
+        size_t sample;
+        size_t offset;
+    };
+
+    std::vector<Segment> segments;
+    for (size_t i = 0; i < samples.size(); i++) {
+        const std::string &sample = *samples[i];
+        for (size_t offset = 0; offset + segmentLength <= sample.size(); offset += segmentLength) {
+            const uint64_t segmentScore = score(sample, offset);
+            if (segmentScore) {
+                segments.push_back({ segmentScore, i, offset });
+            }
+        }
+    }
+
+    std::sort(segments.begin(), segments.end(), [](const Segment &a, const Segment &b) {
+        return a.score > b.score;
+    });
+
+    // Pick the best segments. Once a segment is picked, its sequences no longer count, so that
+    // similar segments aren't picked over and over again.
+    std::vector<const Segment *> picked;
+    size_t size = 0;
+    for (const auto &segment : segments) {
+        if (size + segmentLength > maximumSize) {
+            break;
+        }
+
+        const std::string &sample = *samples[segment.sample];
+        if (score(sample, segment.offset) * 2 < segment.score) {
+            continue;
+        }
+
+        for (size_t pos = segment.offset; pos + sequenceLength <= segment.offset + segmentLength; pos++) {
+            counts[hash(&sample[pos])] = 0;
+        }
+
+        picked.push_back(&segment);
+        size += segmentLength;
+    }
+
+    // Deflate encodes nearby matches more cheaply, so the best segments go at the end.
+    std::string dictionary;
+    dictionary.reserve(size);
+    for (auto it = picked.rbegin(); it != picked.rend(); ++it) {
+        dictionary.append(*samples[(*it)->sample], (*it)->offset, segmentLength);
+    }
+
+    return dictionary;
+}
+
 } // namespace util
 } // namespace mbgl
@@ -1,13 +1,21 @@
 #ifndef MBGL_UTIL_COMPRESSION
 #define MBGL_UTIL_COMPRESSION
 
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace mbgl {
 namespace util {
 
-std::string compress(const std::string &raw);
-std::string decompress(const std::string &raw);
+// The optional dictionary presets the compression window. Data compressed with a dictionary can
+// only be decompressed with the same dictionary.
+std::string compress(const std::string &raw, const std::string &dictionary = "");
+std::string decompress(const std::string &raw, const std::string &dictionary = "");
+std::string decompress(const char *raw, size_t size, const std::string &dictionary = "");
+
+// Builds a dictionary of at most the given size from the content that recurs across the samples.
+std::string trainDictionary(const std::vector<std::shared_ptr<const std::string>> &samples, size_t maximumSize);
 
 } // namespace util
 } // namespace mbgl
@@ -0,0 +1,812 @@
+#include <mbgl/util/earcut.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+namespace mbgl {
+namespace util {
+
+namespace {
+
+// Polygons with more points than this are indexed along a z-order curve.
+const std::size_t kHashThreshold = 80;
+
+class Earcut {
+public:
+    Earcut(std::vector<uint32_t>& indices_) : indices(indices_) {}
+
+    void run(const GeometryCollection& rings);
+
+private:
+    struct Node {
+        Node(uint32_t i_, double x_, double y_) : i(i_), x(x_), y(y_) {}
+
+        const uint32_t i;
+        const double x;
+        const double y;
+
+        Node* prev = nullptr;
+        Node* next = nullptr;
+
+        // The position on the z-order curve, and the neighbors in that order.
+        int32_t z = 0;
+        Node* prevZ = nullptr;
+        Node* nextZ = nullptr;
+
+        // Holes that consist of a single point.
+        bool steiner = false;
+    };
+
+    Node* linkedList(const std::vector<Coordinate>& ring, uint32_t offset, bool clockwise);
+    Node* filterPoints(Node* start, Node* end = nullptr);
+    void earcutLinked(Node* ear, int pass = 0);
+    bool isEar(Node* ear);
+    bool isEarHashed(Node* ear);
+    Node* cureLocalIntersections(Node* start);
+    void splitEarcut(Node* start);
+    Node* eliminateHoles(const GeometryCollection& rings, Node* outerNode);
+    Node* eliminateHole(Node* hole, Node* outerNode);
+    Node* findHoleBridge(Node* hole, Node* outerNode);
+    void indexCurve(Node* start);
+    Node* sortLinked(Node* list);
+    int32_t zOrder(double x, double y) const;
+    Node* splitPolygon(Node* a, Node* b);
+    Node* insertNode(uint32_t i, const Coordinate&, Node* last);
+    void addTriangle(const Node* a, const Node* b, const Node* c);
+
+    static Node* getLeftmost(Node* start);
+    static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py);
+    static bool isValidDiagonal(Node* a, Node* b);
+    static double area(const Node* p, const Node* q, const Node* r);
+    static bool equals(const Node* p1, const Node* p2);
+    static bool intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2);
+    static bool onSegment(const Node* p, const Node* q, const Node* r);
+    static int sign(double);
+    static bool intersectsPolygon(const Node* a, const Node* b);
+    static bool locallyInside(const Node* a, const Node* b);
+    static bool middleInside(const Node* a, const Node* b);
+    static bool sectorContainsSector(const Node* m, const Node* p);
+    static void removeNode(Node* p);
+
+    std::vector<uint32_t>& indices;
+
+    // Owns the nodes; a deque keeps their addresses stable as it grows.
+    std::deque<Node> nodes;
+
+    bool hashing = false;
+    double minX = 0;
+    double minY = 0;
+    double invSize = 0;
+};
+
+void Earcut::run(const GeometryCollection& rings) {
+    if (rings.empty()) {
+        return;
+    }
+
+    Node* outerNode = linkedList(rings[0], 0, true);
+    if (!outerNode || outerNode->next == outerNode->prev) {
+        return;
+    }
+
+    if (rings.size() > 1) {
+        outerNode = eliminateHoles(rings, outerNode);
+    }
+
+    std::size_t pointCount = 0;
+    for (const auto& ring : rings) {
+        pointCount += ring.size();
+    }
+
+    // Large polygons use a z-order curve to find points near an ear quickly.
+    if (pointCount > kHashThreshold) {
+        double maxX = minX = rings[0][0].x;
+        double maxY = minY = rings[0][0].y;
+        for (const auto& point : rings[0]) {
+            minX = std::min<double>(minX, point.x);
+            minY = std::min<double>(minY, point.y);
+            maxX = std::max<double>(maxX, point.x);
+            maxY = std::max<double>(maxY, point.y);
+        }
+
+        const double size = std::max(maxX - minX, maxY - minY);
+        invSize = size != 0 ? 32767 / size : 0;
+        hashing = invSize != 0;
+    }
+
+    earcutLinked(outerNode);
+}
+
+// Creates a circular doubly linked list from the ring, in the given winding order.
+Earcut::Node* Earcut::linkedList(const std::vector<Coordinate>& ring, uint32_t offset, bool clockwise) {
+    Node* last = nullptr;
+    const uint32_t size = ring.size();
+
+    if (clockwise == (signedArea(ring) > 0)) {
+        for (uint32_t i = 0; i < size; i++) {
+            last = insertNode(offset + i, ring[i], last);
+        }
+    } else {
+        for (uint32_t i = size; i-- > 0;) {
+            last = insertNode(offset + i, ring[i], last);
+        }
+    }
+
+    if (last && equals(last, last->next)) {
+        removeNode(last);
+        last = last->next;
+    }
+
+    return last;
+}
+
+// Removes duplicate and collinear points.
+Earcut::Node* Earcut::filterPoints(Node* start, Node* end) {
+    if (!start) {
+        return start;
+    }
+    if (!end) {
+        end = start;
+    }
+
+    Node* p = start;
+    bool again;
+    do {
+        again = false;
+
+        if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0)) {
+            removeNode(p);
+            p = end = p->prev;
+
+            if (p == p->next) {
+                break;
+            }
+            again = true;
+        } else {
+            p = p->next;
+        }
+    } while (again || p != end);
+
+    return end;
+}
+
+// The main ear slicing loop, which triangulates a polygon given as a linked list.
+void Earcut::earcutLinked(Node* ear, int pass) {
+    if (!ear) {
+        return;
+    }
+
+    if (!pass && hashing) {
+        indexCurve(ear);
+    }
+
+    Node* stop = ear;
+
+    while (ear->prev != ear->next) {
+        Node* prev = ear->prev;
+        Node* next = ear->next;
+
+        if (hashing ? isEarHashed(ear) : isEar(ear)) {
+            addTriangle(prev, ear, next);
+            removeNode(ear);
+
+            // Skipping the next vertex leads to less sliver triangles.
+            ear = next->next;
+            stop = next->next;
+            continue;
+        }
+
+        ear = next;
+
+        // Once we looped through the whole remaining polygon and can't find any more ears:
+        if (ear == stop) {
+            if (!pass) {
+                // Try filtering points and slicing again.
+                earcutLinked(filterPoints(ear), 1);
+            } else if (pass == 1) {
+                // Try to resolve local self-intersections.
+                ear = cureLocalIntersections(filterPoints(ear));
+                earcutLinked(ear, 2);
+            } else if (pass == 2) {
+                // As a last resort, try splitting the remaining polygon into two.
+                splitEarcut(ear);
+            }
+            break;
+        }
+    }
+}
+
+// Whether the polygon node forms a valid ear with its neighbors.
+bool Earcut::isEar(Node* ear) {
+    const Node* a = ear->prev;
+    const Node* b = ear;
+    const Node* c = ear->next;
+
+    if (area(a, b, c) >= 0) {
+        return false; // reflex, can't be an ear
+    }
+
+    // Make sure no other point lies inside of the ear.
+    Node* p = ear->next->next;
+    while (p != ear->prev) {
+        if (pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+            area(p->prev, p, p->next) >= 0) {
+            return false;
+        }
+        p = p->next;
+    }
+
+    return true;
+}
+
+bool Earcut::isEarHashed(Node* ear) {
+    const Node* a = ear->prev;
+    const Node* b = ear;
+    const Node* c = ear->next;
+
+    if (area(a, b, c) >= 0) {
+        return false; // reflex, can't be an ear
+    }
+
+    // Only points within the z-order range of the triangle's bounding box can lie inside of it.
+    const int32_t minZ = zOrder(std::min({ a->x, b->x, c->x }), std::min({ a->y, b->y, c->y }));
+    const int32_t maxZ = zOrder(std::max({ a->x, b->x, c->x }), std::max({ a->y, b->y, c->y }));
+
+    auto inside = [&] (const Node* p) {
+        return p != ear->prev && p != ear->next &&
+               pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+               area(p->prev, p, p->next) >= 0;
+    };
+
+    // Look for points in both directions of the curve.
+    Node* p = ear->prevZ;
+    Node* n = ear->nextZ;
+
+    while (p && p->z >= minZ && n && n->z <= maxZ) {
+        if (inside(p)) return false;
+        p = p->prevZ;
+
+        if (inside(n)) return false;
+        n = n->nextZ;
+    }
+
+    while (p && p->z >= minZ) {
+        if (inside(p)) return false;
+        p = p->prevZ;
+    }
+
+    while (n && n->z <= maxZ) {
+        if (inside(n)) return false;
+        n = n->nextZ;
+    }
+
+    return true;
+}
+
+// Goes through all polygon nodes and cures small local self-intersections.
+Earcut::Node* Earcut::cureLocalIntersections(Node* start) {
+    Node* p = start;
+    do {
+        Node* a = p->prev;
+        Node* b = p->next->next;
+
+        if (!equals(a, b) && intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a)) {
+            addTriangle(a, p, b);
+
+            // Remove the two nodes involved.
+            removeNode(p);
+            removeNode(p->next);
+
+            p = start = b;
+        }
+        p = p->next;
+    } while (p != start);
+
+    return filterPoints(p);
+}
+
+// Tries splitting the polygon into two and triangulating them independently.
+void Earcut::splitEarcut(Node* start) {
+    // Look for a valid diagonal that divides the polygon into two.
+    Node* a = start;
+    do {
+        Node* b = a->next->next;
+        while (b != a->prev) {
+            if (a->i != b->i && isValidDiagonal(a, b)) {
+                Node* c = splitPolygon(a, b);
+
+                // Filter collinear points around the cuts.
+                a = filterPoints(a, a->next);
+                c = filterPoints(c, c->next);
+
+                earcutLinked(a);
+                earcutLinked(c);
+                return;
+            }
+            b = b->next;
+        }
+        a = a->next;
+    } while (a != start);
+}
+
+// Links every hole into the outer loop, producing a single ring polygon without holes.
+Earcut::Node* Earcut::eliminateHoles(const GeometryCollection& rings, Node* outerNode) {
+    std::vector<Node*> queue;
+
+    uint32_t offset = rings[0].size();
+    for (std::size_t i = 1; i < rings.size(); i++) {
+        Node* list = linkedList(rings[i], offset, false);
+        offset += rings[i].size();
+
+        if (!list) {
+            continue;
+        }
+        if (list == list->next) {
+            list->steiner = true;
+        }
+        queue.push_back(getLeftmost(list));
+    }
+
+    // Process the holes from left to right.
+    std::sort(queue.begin(), queue.end(), [] (const Node* a, const Node* b) {
+        return a->x < b->x;
+    });
+
+    for (Node* hole : queue) {
+        outerNode = eliminateHole(hole, outerNode);
+    }
+
+    return outerNode;
+}
+
+// Finds a bridge between the vertices that connects the hole with the outer ring, and links it.
+Earcut::Node* Earcut::eliminateHole(Node* hole, Node* outerNode) {
+    Node* bridge = findHoleBridge(hole, outerNode);
+    if (!bridge) {
+        return outerNode;
+    }
+
+    Node* bridgeReverse = splitPolygon(bridge, hole);
+
+    // Filter collinear points around the cuts.
+    filterPoints(bridgeReverse, bridgeReverse->next);
+    return filterPoints(bridge, bridge->next);
+}
+
+// David Eberly's algorithm for finding a bridge between a hole and the outer polygon.
+Earcut::Node* Earcut::findHoleBridge(Node* hole, Node* outerNode) {
+    Node* p = outerNode;
+    const double hx = hole->x;
+    const double hy = hole->y;
+    double qx = -std::numeric_limits<double>::infinity();
+    Node* m = nullptr;
+
+    // Find a segment intersected by a ray from the hole's leftmost point to the left; the segment's
+    // endpoint with the lesser x will be a potential connection point.
+    do {
+        if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+            const double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+            if (x <= hx && x > qx) {
+                qx = x;
+                m = p->x < p->next->x ? p : p->next;
+                if (x == hx) {
+                    // The hole touches the outer segment; pick the leftmost endpoint.
+                    return m;
+                }
+            }
+        }
+        p = p->next;
+    } while (p != outerNode);
+
+    if (!m) {
+        return nullptr;
+    }
+
+    // Look for points inside of the triangle of the hole point, the segment intersection and the
+    // endpoint. If there are none, the endpoint is the connection point; otherwise, use the point
+    // with the minimum angle to the ray.
+    const Node* stop = m;
+    const double mx = m->x;
+    const double my = m->y;
+    double tanMin = std::numeric_limits<double>::infinity();
+
+    p = m;
+    do {
+        if (hx >= p->x && p->x >= mx && hx != p->x &&
+            pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+            const double tan = std::abs(hy - p->y) / (hx - p->x);
+
+            if (locallyInside(p, hole) &&
+                (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p)))))) {
+                m = p;
+                tanMin = tan;
+            }
+        }
+        p = p->next;
+    } while (p != stop);
+
+    return m;
+}
+
+// Interlinks the polygon nodes in z-order.
+void Earcut::indexCurve(Node* start) {
+    Node* p = start;
+    do {
+        if (p->z == 0) {
+            p->z = zOrder(p->x, p->y);
+        }
+        p->prevZ = p->prev;
+        p->nextZ = p->next;
+        p = p->next;
+    } while (p != start);
+
+    p->prevZ->nextZ = nullptr;
+    p->prevZ = nullptr;
+
+    sortLinked(p);
+}
+
+// Simon Tatham's linked list merge sort algorithm.
+Earcut::Node* Earcut::sortLinked(Node* list) {
+    std::size_t inSize = 1;
+    std::size_t numMerges;
+
+    do {
+        Node* p = list;
+        list = nullptr;
+        Node* tail = nullptr;
+        numMerges = 0;
+
+        while (p) {
+            numMerges++;
+            Node* q = p;
+            std::size_t pSize = 0;
+            for (std::size_t i = 0; i < inSize; i++) {
+                pSize++;
+                q = q->nextZ;
+                if (!q) break;
+            }
+
+            std::size_t qSize = inSize;
+
+            while (pSize > 0 || (qSize > 0 && q)) {
+                Node* e;
+                if (pSize != 0 && (qSize == 0 || !q || p->z <= q->z)) {
+                    e = p;
+                    p = p->nextZ;
+                    pSize--;
+                } else {
+                    e = q;
+                    q = q->nextZ;
+                    qSize--;
+                }
+
+                if (tail) tail->nextZ = e;
+                else list = e;
+
+                e->prevZ = tail;
+                tail = e;
+            }
+
+            p = q;
+        }
+
+        tail->nextZ = nullptr;
+        inSize *= 2;
+    } while (numMerges > 1);
+
+    return list;
+}
+
+// The z-order of a point, given the coordinates and the size of the bounding box.
+int32_t Earcut::zOrder(double x_, double y_) const {
+    // Coordinates are scaled to 15 bits.
+    int32_t x = static_cast<int32_t>((x_ - minX) * invSize);
+    int32_t y = static_cast<int32_t>((y_ - minY) * invSize);
+
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+
+    y = (y | (y << 8)) & 0x00FF00FF;
+    y = (y | (y << 4)) & 0x0F0F0F0F;
+    y = (y | (y << 2)) & 0x33333333;
+    y = (y | (y << 1)) & 0x55555555;
+
+    return x | (y << 1);
+}
+
+// Links two polygon vertices with a bridge. If the vertices belong to the same ring, it splits
+// the polygon into two; if one belongs to the outer ring and the other to a hole, it merges them
+// into a single ring.
+Earcut::Node* Earcut::splitPolygon(Node* a, Node* b) {
+    nodes.emplace_back(a->i, a->x, a->y);
+    Node* a2 = &nodes.back();
+    nodes.emplace_back(b->i, b->x, b->y);
+    Node* b2 = &nodes.back();
+    Node* an = a->next;
+    Node* bp = b->prev;
+
+    a->next = b;
+    b->prev = a;
+
+    a2->next = an;
+    an->prev = a2;
+
+    b2->next = a2;
+    a2->prev = b2;
+
+    bp->next = b2;
+    b2->prev = bp;
+
+    return b2;
+}
+
+// Creates a node and links it after the last node, if any.
+Earcut::Node* Earcut::insertNode(uint32_t i, const Coordinate& point, Node* last) {
+    nodes.emplace_back(i, point.x, point.y);
+    Node* p = &nodes.back();
+
+    if (!last) {
+        p->prev = p;
+        p->next = p;
+    } else {
+        p->next = last->next;
+        p->prev = last;
+        last->next->prev = p;
+        last->next = p;
+    }
+    return p;
+}
+
+void Earcut::addTriangle(const Node* a, const Node* b, const Node* c) {
+    indices.push_back(a->i);
+    indices.push_back(b->i);
+    indices.push_back(c->i);
+}
+
+// The leftmost node of a polygon ring.
+Earcut::Node* Earcut::getLeftmost(Node* start) {
+    Node* p = start;
+    Node* leftmost = start;
+    do {
+        if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y)) {
+            leftmost = p;
+        }
+        p = p->next;
+    } while (p != start);
+
+    return leftmost;
+}
+
+bool Earcut::pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py) {
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+           (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+           (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+// Whether a diagonal between two polygon nodes is valid, i.e. lies in the polygon interior.
+bool Earcut::isValidDiagonal(Node* a, Node* b) {
+    return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&
+           // It's locally visible, and doesn't create opposite-facing sectors,
+           ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&
+             (area(a->prev, a, b->prev) != 0 || area(a, b->prev, b) != 0)) ||
+            // or it's a special zero-length case.
+            (equals(a, b) && area(a->prev, a, a->next) > 0 && area(b->prev, b, b->next) > 0));
+}
+
+// Twice the signed area of a triangle.
+double Earcut::area(const Node* p, const Node* q, const Node* r) {
+    return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+bool Earcut::equals(const Node* p1, const Node* p2) {
+    return p1->x == p2->x && p1->y == p2->y;
+}
+
+// Whether two segments intersect.
+bool Earcut::intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2) {
+    const int o1 = sign(area(p1, q1, p2));
+    const int o2 = sign(area(p1, q1, q2));
+    const int o3 = sign(area(p2, q2, p1));
+    const int o4 = sign(area(p2, q2, q1));
+
+    if (o1 != o2 && o3 != o4) return true; // general case
+
+    if (o1 == 0 && onSegment(p1, p2, q1)) return true; // p1, q1 and p2 are collinear and p2 lies on p1q1
+    if (o2 == 0 && onSegment(p1, q2, q1)) return true; // p1, q1 and q2 are collinear and q2 lies on p1q1
+    if (o3 == 0 && onSegment(p2, p1, q2)) return true; // p2, q2 and p1 are collinear and p1 lies on p2q2
+    if (o4 == 0 && onSegment(p2, q1, q2)) return true; // p2, q2 and q1 are collinear and q1 lies on p2q2
+
+    return false;
+}
+
+// For collinear points p, q and r, whether q lies on segment pr.
+bool Earcut::onSegment(const Node* p, const Node* q, const Node* r) {
+    return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) &&
+           q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+}
+
+int Earcut::sign(double value) {
+    return (value > 0) - (value < 0);
+}
+
+// Whether a polygon diagonal intersects any polygon segments.
+bool Earcut::intersectsPolygon(const Node* a, const Node* b) {
+    const Node* p = a;
+    do {
+        if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i &&
+            intersects(p, p->next, a, b)) {
+            return true;
+        }
+        p = p->next;
+    } while (p != a);
+
+    return false;
+}
+
+// Whether a polygon diagonal is locally inside of the polygon.
+bool Earcut::locallyInside(const Node* a, const Node* b) {
+    return area(a->prev, a, a->next) < 0 ?
+        area(a, b, a->next) >= 0 && area(a, a->prev, b) >= 0 :
+        area(a, b, a->prev) < 0 || area(a, a->next, b) < 0;
+}
+
+// Whether the middle point of a polygon diagonal is inside of the polygon.
+bool Earcut::middleInside(const Node* a, const Node* b) {
+    const Node* p = a;
+    bool inside = false;
+    const double px = (a->x + b->x) / 2;
+    const double py = (a->y + b->y) / 2;
+    do {
+        if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
+            (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x)) {
+            inside = !inside;
+        }
+        p = p->next;
+    } while (p != a);
+
+    return inside;
+}
+
+// Whether the sector in vertex m contains the sector in vertex p of the same vertex position.
+bool Earcut::sectorContainsSector(const Node* m, const Node* p) {
+    return area(m->prev, m, p->prev) < 0 && area(p->next, m, m->next) < 0;
+}
+
+void Earcut::removeNode(Node* p) {
+    p->next->prev = p->prev;
+    p->prev->next = p->next;
+
+    if (p->prevZ) p->prevZ->nextZ = p->nextZ;
+    if (p->nextZ) p->nextZ->prevZ = p->prevZ;
+}
+
+// Whether the point lies inside of the first `size` points of the ring.
+bool ringContains(const std::vector<Coordinate>& ring, std::size_t size, const Coordinate& point) {
+    bool inside = false;
+    for (std::size_t i = 0, j = size - 1; i < size; j = i++) {
+        const Coordinate& a = ring[i];
+        const Coordinate& b = ring[j];
+        if ((a.y > point.y) != (b.y > point.y) &&
+            point.x < double(b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// Whether the point lies inside of the polygon by the even-odd rule, which is how the fallback
+// path fills polygons.
+bool polygonContains(const GeometryCollection& polygon, const Coordinate& point) {
+    bool inside = false;
+    for (const auto& ring : polygon) {
+        inside ^= ringContains(ring, ring.size(), point);
+    }
+    return inside;
+}
+
+} // namespace
+
+void earcut(const GeometryCollection& rings, std::vector<uint32_t>& indices) {
+    Earcut(indices).run(rings);
+}
+
+double earcutDeviation(const GeometryCollection& rings, const std::vector<uint32_t>& indices) {
+    double polygonArea = 0;
+    std::vector<const Coordinate*> points;
+    for (std::size_t i = 0; i < rings.size(); i++) {
+        const double ringArea = std::abs(signedArea(rings[i]));
+        polygonArea += i == 0 ? ringArea : -ringArea;
+        for (const auto& point : rings[i]) {
+            points.push_back(&point);
+        }
+    }
+
+    double trianglesArea = 0;
+    for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const Coordinate& a = *points[indices[i]];
+        const Coordinate& b = *points[indices[i + 1]];
+        const Coordinate& c = *points[indices[i + 2]];
+        trianglesArea += std::abs(double(a.x - c.x) * (b.y - a.y) - double(a.x - b.x) * (c.y - a.y));
+    }
+
+    if (polygonArea == 0 && trianglesArea == 0) {
+        return 0;
+    }
+    return std::abs((trianglesArea - polygonArea) / polygonArea);
+}
+
+double signedArea(const std::vector<Coordinate>& ring) {
+    if (ring.empty()) {
+        return 0;
+    }
+
+    double sum = 0;
+    for (std::size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        sum += double(ring[j].x - ring[i].x) * (ring[i].y + ring[j].y);
+    }
+    return sum;
+}
+
+bool classifyRings(const GeometryCollection& rings, std::vector<GeometryCollection>& polygons) {
+    polygons.clear();
+    bool outerClockwise = false;
+
+    // The bounding boxes of the outer rings, to skip the containment tests for most polygons.
+    std::vector<std::array<int16_t, 4>> boxes;
+
+    for (const auto& ring : rings) {
+        const bool closed = ring.size() > 1 && ring.front() == ring.back();
+        const std::size_t size = closed ? ring.size() - 1 : ring.size();
+        if (size < 3) {
+            continue;
+        }
+
+        const double area = signedArea(ring);
+        if (area == 0) {
+            continue;
+        }
+
+        if (polygons.empty()) {
+            outerClockwise = area > 0;
+        }
+
+        if ((area > 0) == outerClockwise) {
+            std::array<int16_t, 4> box { { ring[0].x, ring[0].y, ring[0].x, ring[0].y } };
+            for (std::size_t i = 1; i < size; i++) {
+                box[0] = std::min(box[0], ring[i].x);
+                box[1] = std::min(box[1], ring[i].y);
+                box[2] = std::max(box[2], ring[i].x);
+                box[3] = std::max(box[3], ring[i].y);
+            }
+
+            // A ring inside of another polygon is a hole that is wound like an outer ring, and
+            // another polygon inside of this ring means that the rings are out of order. Islands
+            // within holes are outside of the polygon, and are fine.
+            for (std::size_t i = 0; i < polygons.size(); i++) {
+                const auto& other = boxes[i];
+                if (box[0] > other[2] || box[2] < other[0] || box[1] > other[3] || box[3] < other[1]) {
+                    continue;
+                }
+                if (polygonContains(polygons[i], ring[0]) || ringContains(ring, size, polygons[i][0][0])) {
+                    return false;
+                }
+            }
+
+            polygons.emplace_back();
+            boxes.push_back(box);
+        }
+
+        polygons.back().emplace_back(ring.begin(), ring.begin() + size);
+    }
+
+    return true;
+}
+
+} // namespace util
+} // namespace mbgl
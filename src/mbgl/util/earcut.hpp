@@ -0,0 +1,37 @@
+#ifndef MBGL_UTIL_EARCUT
+#define MBGL_UTIL_EARCUT
+
+#include <mbgl/map/geometry_tile.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace mbgl {
+namespace util {
+
+// Triangulates a polygon by ear clipping, after joining its holes to the outer ring. The first
+// ring is the outer ring and the others are its holes; rings don't repeat their first point at
+// their end. Appends three indices per triangle to `indices`, counting the points of all rings
+// in order. Polygons with many points are indexed along a z-order curve to find ears quickly.
+//
+// The input is expected to be valid; self-intersecting rings or holes that cross the outer ring
+// produce triangles that don't cover the polygon. earcutDeviation() detects that.
+void earcut(const GeometryCollection& rings, std::vector<uint32_t>& indices);
+
+// The relative difference between the area of the polygon and the area of its triangles.
+double earcutDeviation(const GeometryCollection& rings, const std::vector<uint32_t>& indices);
+
+// Twice the signed area of a ring; positive for rings that are clockwise in tile coordinates.
+double signedArea(const std::vector<Coordinate>& ring);
+
+// Groups the rings of a feature into polygons for earcut(): rings with the winding order of the
+// first ring start a new polygon, and the rings with the opposite winding order that follow are
+// its holes. Rings may repeat their first point at their end; rings without area are dropped.
+// Returns false when the winding order doesn't tell outer rings and holes apart, because a ring
+// of one polygon lies inside of another polygon.
+bool classifyRings(const GeometryCollection& rings, std::vector<GeometryCollection>& polygons);
+
+} // namespace util
+} // namespace mbgl
+
+#endif
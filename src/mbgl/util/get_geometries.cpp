@@ -1,18 +1,53 @@
 #include <mbgl/util/get_geometries.hpp>
 #include <mbgl/util/constants.hpp>
+#include <mbgl/util/clip_geometry.hpp>
 
 namespace mbgl {
 
 GeometryCollection getGeometries(const GeometryTileFeature& feature) {
+    GeometryCollection geometryCollection;
+    getGeometries(feature, geometryCollection);
+    return geometryCollection;
+}
+
+void getGeometries(const GeometryTileFeature& feature, GeometryCollection& geometryCollection) {
     const float scale = float(util::EXTENT) / feature.getExtent();
-    GeometryCollection geometryCollection = feature.getGeometries();
+    feature.readGeometries(geometryCollection);
     for (auto& line : geometryCollection) {
         for (auto& point : line) {
             point.x = std::round(point.x * scale);
             point.y = std::round(point.y * scale);
         }
     }
-    return geometryCollection;
+}
+
+bool FeatureGeometries::needsClipping() const {
+    if (!exceeds) {
+        exceeds = util::exceedsBox(get(), -buffer, -buffer, util::EXTENT + buffer, util::EXTENT + buffer);
+    }
+    return *exceeds;
+}
+
+const GeometryCollection& FeatureGeometries::getClippedPolygons() const {
+    if (!needsClipping()) {
+        return get();
+    }
+    if (!clippedPolygons) {
+        util::clipPolygons(get(), storage.polygons, -buffer, -buffer, util::EXTENT + buffer, util::EXTENT + buffer);
+        clippedPolygons = true;
+    }
+    return storage.polygons;
+}
+
+const GeometryCollection& FeatureGeometries::getClippedLines() const {
+    if (!needsClipping()) {
+        return get();
+    }
+    if (!clippedLines) {
+        util::clipLineStrings(get(), storage.lines, -buffer, -buffer, util::EXTENT + buffer, util::EXTENT + buffer);
+        clippedLines = true;
+    }
+    return storage.lines;
 }
 
 } // namespace mbgl
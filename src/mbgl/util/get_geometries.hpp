@@ -7,6 +7,55 @@ namespace mbgl {
 
 GeometryCollection getGeometries(const GeometryTileFeature& feature);
 
+// Like the above, but decodes into `geometries`, reusing its storage where possible.
+void getGeometries(const GeometryTileFeature& feature, GeometryCollection& geometries);
+
+// The geometries of a feature, decoded when they're first needed. This lets all buckets that a
+// feature is added to share them.
+class FeatureGeometries : private util::noncopyable {
+public:
+    // The decoded and clipped geometries. Passing the same storage for one feature after another
+    // keeps the capacity of its vectors, so decoding features mostly doesn't allocate.
+    struct Storage {
+        GeometryCollection geometries;
+        GeometryCollection polygons;
+        GeometryCollection lines;
+    };
+
+    // Clipped geometries are cut off at `buffer` units outside of the tile.
+    FeatureGeometries(const GeometryTileFeature& feature_, int16_t buffer_ = 0)
+        : FeatureGeometries(feature_, buffer_, ownStorage) {}
+
+    FeatureGeometries(const GeometryTileFeature& feature_, int16_t buffer_, Storage& storage_)
+        : feature(feature_), buffer(buffer_), storage(storage_) {}
+
+    const GeometryCollection& get() const {
+        if (!decoded) {
+            getGeometries(feature, storage.geometries);
+            decoded = true;
+        }
+        return storage.geometries;
+    }
+
+    // The geometries clipped as polygons, for filling them.
+    const GeometryCollection& getClippedPolygons() const;
+
+    // The geometries clipped as lines, for stroking them.
+    const GeometryCollection& getClippedLines() const;
+
+private:
+    bool needsClipping() const;
+
+    const GeometryTileFeature& feature;
+    const int16_t buffer;
+    Storage ownStorage;
+    Storage& storage;
+    mutable bool decoded = false;
+    mutable optional<bool> exceeds;
+    mutable bool clippedPolygons = false;
+    mutable bool clippedLines = false;
+};
+
 } // namespace mbgl
 
 #endif
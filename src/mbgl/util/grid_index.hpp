@@ -0,0 +1,129 @@
+#ifndef MBGL_UTIL_GRID_INDEX
+#define MBGL_UTIL_GRID_INDEX
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace mbgl {
+namespace util {
+
+// A spatial index of axis aligned boxes that are stored in the cells of a uniform grid. Boxes
+// that reach outside of the grid are stored in the cells at its border, so every box can be
+// found, but the grid should cover the area where most boxes are.
+//
+// Queries don't allocate, and reset() keeps the memory of the cells for the next use.
+template <class T>
+class GridIndex : private util::noncopyable {
+public:
+    // Boxes include their edges, so boxes that touch intersect.
+    struct BBox {
+        float x1, y1, x2, y2;
+
+        bool intersects(const BBox& other) const {
+            return x1 <= other.x2 && other.x1 <= x2 && y1 <= other.y2 && other.y1 <= y2;
+        }
+    };
+
+    explicit GridIndex(float cellSize_) : cellSize(cellSize_) {}
+
+    // Removes all boxes and lays the grid over the area from (x1, y1) to (x2, y2).
+    void reset(float x1, float y1, float x2, float y2) {
+        entries.clear();
+        for (auto& cell : cells) {
+            cell.clear();
+        }
+
+        originX = x1;
+        originY = y1;
+        columns = std::max(1, int((x2 - x1) / cellSize) + 1);
+        rows = std::max(1, int((y2 - y1) / cellSize) + 1);
+        cells.resize(std::size_t(columns) * rows);
+    }
+
+    void insert(const T& value, const BBox& box) {
+        const auto index = static_cast<uint32_t>(entries.size());
+        entries.push_back({ box, value });
+
+        const int cx1 = column(box.x1), cx2 = column(box.x2);
+        const int cy1 = row(box.y1), cy2 = row(box.y2);
+        for (int cy = cy1; cy <= cy2; cy++) {
+            for (int cx = cx1; cx <= cx2; cx++) {
+                cells[std::size_t(cy) * columns + cx].push_back(index);
+            }
+        }
+    }
+
+    // Calls the function with every value whose box intersects `box`, once each, until it
+    // returns false.
+    template <class Fn>
+    void query(const BBox& box, Fn&& fn) const {
+        const int cx1 = column(box.x1), cx2 = column(box.x2);
+        const int cy1 = row(box.y1), cy2 = row(box.y2);
+        for (int cy = cy1; cy <= cy2; cy++) {
+            for (int cx = cx1; cx <= cx2; cx++) {
+                for (const auto index : cells[std::size_t(cy) * columns + cx]) {
+                    const Entry& entry = entries[index];
+                    if (!entry.box.intersects(box)) {
+                        continue;
+                    }
+                    // A box that spans several cells is only reported from the cell where its
+                    // intersection with the query box starts.
+                    if (column(std::max(entry.box.x1, box.x1)) != cx ||
+                        row(std::max(entry.box.y1, box.y1)) != cy) {
+                        continue;
+                    }
+                    if (!fn(entry.value)) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    std::size_t size() const {
+        return entries.size();
+    }
+
+private:
+    struct Entry {
+        BBox box;
+        T value;
+    };
+
+    int column(float x) const {
+        return clamp((x - originX) / cellSize, columns);
+    }
+
+    int row(float y) const {
+        return clamp((y - originY) / cellSize, rows);
+    }
+
+    // Also maps NaN to the first cell.
+    static int clamp(float cell, int count) {
+        if (!(cell > 0)) {
+            return 0;
+        }
+        if (!(cell < count - 1)) {
+            return count - 1;
+        }
+        return int(cell);
+    }
+
+    const float cellSize;
+    float originX = 0;
+    float originY = 0;
+    int columns = 1;
+    int rows = 1;
+
+    std::vector<Entry> entries;
+    std::vector<std::vector<uint32_t>> cells = std::vector<std::vector<uint32_t>>(1);
+};
+
+} // namespace util
+} // namespace mbgl
+
+#endif
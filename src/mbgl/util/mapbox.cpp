@@ -139,6 +139,25 @@ std::string normalizeRasterTileURL(const std::string& url) {
     return normalizedURL;
 }
 
+std::string normalizeURL(Resource::Kind kind, const std::string& url, const std::string& accessToken) {
+    switch (kind) {
+    case Resource::Kind::Style:
+        return normalizeStyleURL(url, accessToken);
+
+    case Resource::Kind::Source:
+        return normalizeSourceURL(url, accessToken);
+
+    case Resource::Kind::Glyphs:
+        return normalizeGlyphsURL(url, accessToken);
+
+    case Resource::Kind::SpriteImage:
+    case Resource::Kind::SpriteJSON:
+        return normalizeSpriteURL(url, accessToken);
+
+    default:
+        return url;
+    }
+}
 
 std::string removeAccessTokenFromURL(const std::string &url) {
     const size_t token_start = url.find("access_token=");
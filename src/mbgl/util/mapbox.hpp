@@ -2,6 +2,7 @@
 #define MBGL_UTIL_MAPBOX
 
 #include <string>
+#include <mbgl/storage/resource.hpp>
 #include <mbgl/style/types.hpp>
 
 namespace mbgl {
@@ -16,6 +17,9 @@ std::string normalizeSpriteURL(const std::string& url, const std::string& access
 std::string normalizeGlyphsURL(const std::string& url, const std::string& accessToken);
 std::string normalizeRasterTileURL(const std::string& url);
 
+// Returns the URL that is requested for a resource of the given kind.
+std::string normalizeURL(Resource::Kind, const std::string& url, const std::string& accessToken);
+
 // Canonicalizes Mapbox URLs by removing [a-d] subdomain prefixes, access tokens, and protocol.
 // Note that this is close, but not exactly the reverse operation as above, as this retains certain
 // information, such as the API version. It is used to cache resources retrieved from the URL, that
@@ -97,7 +97,11 @@ T pbf::varint() {
         if (data >= end) {
             throw unterminated_varint_exception();
         }
-        result |= ((T)(byte = *data) & 0x7F) << bitpos;
+        byte = *data;
+        if (bitpos < int(sizeof(T) * 8)) {
+            // Bits beyond the size of T are dropped.
+            result |= ((T)byte & 0x7F) << bitpos;
+        }
 
         data++;
     }
@@ -0,0 +1,181 @@
+#include <mbgl/util/thread_pool.hpp>
+#include <mbgl/util/thread_local.hpp>
+#include <mbgl/platform/platform.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace mbgl {
+namespace util {
+
+namespace {
+
+// The pool the current thread belongs to, and the priority of the job it is running.
+struct Current {
+    ThreadPool* pool;
+    double priority;
+};
+
+ThreadLocal<Current>& current = *new ThreadLocal<Current>;
+
+} // namespace
+
+// Works on the calls of a parallel() call from another thread of the pool.
+class ThreadPool::Helper : public ThreadPool::Job {
+public:
+    Helper(double priority_, std::shared_ptr<Group> group_)
+        : Job(priority_, std::make_shared<std::atomic<bool>>(false)),
+          group(std::move(group_)) {}
+
+private:
+    void run() override {
+        while (group->runNext()) {
+        }
+    }
+
+    const std::shared_ptr<Group> group;
+};
+
+ThreadPool::ThreadPool(const ThreadContext& context, std::size_t count) {
+    assert(count > 0);
+
+    for (std::size_t i = 0; i < count; i++) {
+        threads.emplace_back(&ThreadPool::run, this, context);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::push(std::shared_ptr<Job> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+
+    condition.notify_one();
+}
+
+std::shared_ptr<ThreadPool::Job> ThreadPool::pop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        // Canceled jobs are dropped here, so that they release their arguments.
+        jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [] (const auto& job) {
+            return job->isCanceled();
+        }), jobs.end());
+
+        // The first of the jobs with the lowest priority value, so that ties run in order.
+        auto it = std::min_element(jobs.begin(), jobs.end(), [] (const auto& a, const auto& b) {
+            return a->priority < b->priority;
+        });
+        if (it != jobs.end()) {
+            auto job = std::move(*it);
+            jobs.erase(it);
+            return job;
+        }
+
+        if (stopping) {
+            return nullptr;
+        }
+
+        condition.wait(lock);
+    }
+}
+
+void ThreadPool::run(ThreadContext context) {
+    #if defined( __APPLE__)
+    pthread_setname_np(context.name.c_str());
+    #elif defined(__linux__)
+    pthread_setname_np(pthread_self(), context.name.c_str());
+    #endif
+
+    if (context.priority == ThreadPriority::Low) {
+        platform::makeThreadLowPriority();
+    }
+
+    ThreadContext::Set(&context);
+
+    Current self { this, 0 };
+    current.set(&self);
+
+    while (auto job = pop()) {
+        self.priority = job->priority;
+        (*job)();
+    }
+
+    current.set(nullptr);
+    ThreadContext::Set(nullptr);
+}
+
+void ThreadPool::parallel(std::size_t count, const std::function<void (std::size_t)>& fn) {
+    Current* self = current.get();
+    if (!self || self->pool->size() < 2 || count < 2) {
+        for (std::size_t i = 0; i < count; i++) {
+            fn(i);
+        }
+        return;
+    }
+
+    auto group = std::make_shared<Group>(count, fn);
+
+    std::vector<std::shared_ptr<Job>> helpers;
+    for (std::size_t i = 1; i < std::min(count, self->pool->size()); i++) {
+        helpers.emplace_back(std::make_shared<Helper>(self->priority, group));
+        self->pool->push(helpers.back());
+    }
+
+    while (group->runNext()) {
+    }
+    group->wait();
+
+    // Helpers that haven't started yet have nothing left to do.
+    for (auto& helper : helpers) {
+        helper->cancel();
+    }
+
+    if (group->error) {
+        std::rethrow_exception(group->error);
+    }
+}
+
+bool ThreadPool::Group::runNext() {
+    // Once all calls have been started, fn may already be gone.
+    const std::size_t i = next++;
+    if (i >= count) {
+        return false;
+    }
+
+    std::exception_ptr exception;
+    try {
+        fn(i);
+    } catch (...) {
+        exception = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (exception && !error) {
+        error = exception;
+    }
+    if (++finished == count) {
+        condition.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::Group::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&] { return finished == count; });
+}
+
+} // namespace util
+} // namespace mbgl
@@ -0,0 +1,168 @@
+#ifndef MBGL_UTIL_THREAD_POOL
+#define MBGL_UTIL_THREAD_POOL
+
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <mbgl/util/thread_context.hpp>
+#include <mbgl/util/work_task.hpp>
+#include <mbgl/util/work_request.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace mbgl {
+namespace util {
+
+// A pool of threads that share the work queued on it. All threads take their work from a single
+// queue, so that a long job never holds up the work behind it while another thread is idle. The
+// job with the lowest priority value runs first, and jobs with the same priority run in the order
+// they were queued.
+class ThreadPool : private util::noncopyable {
+public:
+    ThreadPool(const ThreadContext&, std::size_t count);
+    ~ThreadPool();
+
+    std::size_t size() const { return threads.size(); }
+
+    // Queue fn(args...), then invoke callback(results...) on the current RunLoop. Like with
+    // RunLoop::invokeWithCallback(), destroying the returned request guarantees that neither
+    // function runs anymore; work that hasn't started yet is dropped from the queue.
+    template <class Fn, class Cb, class... Args>
+    std::unique_ptr<WorkRequest>
+    invokeWithCallback(double priority, Fn fn, Cb&& callback, Args&&... args) {
+        auto flag = std::make_shared<std::atomic<bool>>();
+        *flag = false;
+
+        auto after = [flag, current = RunLoop::Get(), callback1 = std::move(callback)] (auto&&... results1) {
+            if (!*flag) {
+                current->invoke([flag, callback2 = std::move(callback1)] (auto&&... results2) {
+                    if (!*flag) {
+                        callback2(std::move(results2)...);
+                    }
+                }, std::move(results1)...);
+            }
+        };
+
+        auto tuple = std::make_tuple(std::move(args)..., after);
+        auto job = std::make_shared<Invoker<Fn, decltype(tuple)>>(
+            priority,
+            std::move(fn),
+            std::move(tuple),
+            flag);
+
+        push(job);
+
+        return std::make_unique<WorkRequest>(job);
+    }
+
+    // Calls fn(0) to fn(count - 1) and returns when all calls have finished. When called from a
+    // job of a pool, the calls are spread over the idle threads of that pool, at the priority of
+    // the calling job; otherwise, they run on the current thread. The calling thread takes part
+    // in the work and only waits for calls that other threads have already started, so jobs may
+    // nest these without deadlocking. The first exception thrown by fn is rethrown here.
+    static void parallel(std::size_t count, const std::function<void (std::size_t)>& fn);
+
+private:
+    class Job : public WorkTask {
+    public:
+        Job(double priority_, std::shared_ptr<std::atomic<bool>> canceled_)
+            : priority(priority_), canceled(std::move(canceled_)) {}
+
+        // Lock the mutex while processing so that cancel() will block.
+        void operator()() override {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+            if (!*canceled) {
+                run();
+            }
+        }
+
+        void cancel() override {
+            std::lock_guard<std::recursive_mutex> lock(mutex);
+            *canceled = true;
+        }
+
+        bool isCanceled() const {
+            return *canceled;
+        }
+
+        const double priority;
+
+    private:
+        virtual void run() = 0;
+
+        std::recursive_mutex mutex;
+        std::shared_ptr<std::atomic<bool>> canceled;
+    };
+
+    template <class F, class P>
+    class Invoker : public Job {
+    public:
+        Invoker(double priority_, F&& f, P&& p, std::shared_ptr<std::atomic<bool>> canceled_)
+            : Job(priority_, std::move(canceled_)),
+              func(std::move(f)),
+              params(std::move(p)) {
+        }
+
+    private:
+        void run() override {
+            invoke(std::make_index_sequence<std::tuple_size<P>::value>{});
+        }
+
+        template <std::size_t... I>
+        void invoke(std::index_sequence<I...>) {
+            func(std::move(std::get<I>(std::forward<P>(params)))...);
+        }
+
+        F func;
+        P params;
+    };
+
+    // The state shared by the threads that work on a parallel() call.
+    class Group {
+    public:
+        Group(std::size_t count_, const std::function<void (std::size_t)>& fn_)
+            : count(count_), fn(fn_) {}
+
+        // Runs the next call, if any is left. Returns false once all calls have been started.
+        bool runNext();
+        void wait();
+
+        std::exception_ptr error;
+
+    private:
+        const std::size_t count;
+        const std::function<void (std::size_t)>& fn;
+        std::atomic<std::size_t> next { 0 };
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::size_t finished = 0;
+    };
+
+    class Helper;
+
+    void push(std::shared_ptr<Job>);
+    std::shared_ptr<Job> pop();
+    void run(ThreadContext);
+
+    std::vector<std::thread> threads;
+
+    // Guards the queue, and sleeping and waking up threads.
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::shared_ptr<Job>> jobs;
+    bool stopping = false;
+};
+
+} // namespace util
+} // namespace mbgl
+
+#endif
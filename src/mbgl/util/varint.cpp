@@ -0,0 +1,153 @@
+#include <mbgl/util/varint.hpp>
+#include <mbgl/util/pbf.hpp>
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace mbgl {
+namespace util {
+
+namespace {
+
+// The longest varint that pbf accepts. Only the first five bytes contribute to a 32 bit value.
+const std::size_t kMaxVarintLength = 10;
+
+// Combines the bytes of a varint of up to five bytes that are stored in the lower bytes of
+// `word`, without looking at each byte on its own.
+inline uint32_t combine(uint64_t word, std::size_t length) {
+    word &= ~uint64_t(0) >> (64 - 8 * length);
+    return uint32_t((word & 0x7F) |
+                    ((word >> 1) & 0x3F80) |
+                    ((word >> 2) & 0x1FC000) |
+                    ((word >> 3) & 0xFE00000) |
+                    ((word >> 4) & 0xF0000000));
+}
+
+// Decodes a single varint. The caller makes sure that the longest varint fits before `end`, or
+// passes `checked` to check every byte.
+template <bool checked>
+inline uint32_t decodeVarint(const uint8_t*& data, const uint8_t* end) {
+    if (!checked || data < end) {
+        // Most varints in vector tiles take a single byte.
+        if (data[0] < 0x80) {
+            return *data++;
+        }
+        if ((!checked || data + 1 < end) && data[1] < 0x80) {
+            const uint32_t value = (data[0] & 0x7F) | (uint32_t(data[1]) << 7);
+            data += 2;
+            return value;
+        }
+    }
+
+    uint32_t value = 0;
+    std::size_t i = 0;
+    uint8_t byte = 0x80;
+    for (; i < kMaxVarintLength && (byte & 0x80); i++) {
+        if (checked && data + i >= end) {
+            throw pbf::unterminated_varint_exception();
+        }
+        byte = data[i];
+        if (i < 5) {
+            value |= uint32_t(byte & 0x7F) << (7 * i);
+        }
+    }
+    if (byte & 0x80) {
+        throw pbf::varint_too_long_exception();
+    }
+    data += i;
+    return value;
+}
+
+} // namespace
+
+std::size_t decodeVarintsScalar(const uint8_t*& data, const uint8_t* end, uint32_t* out, std::size_t count) {
+    std::size_t n = 0;
+    while (n < count && end - data >= std::ptrdiff_t(kMaxVarintLength)) {
+        out[n++] = decodeVarint<false>(data, end);
+    }
+    while (n < count && data < end) {
+        out[n++] = decodeVarint<true>(data, end);
+    }
+    return n;
+}
+
+std::size_t decodeVarints(const uint8_t*& data, const uint8_t* end, uint32_t* out, std::size_t count) {
+    std::size_t n = 0;
+
+#if defined(__AVX2__)
+    // Runs of 32 single byte varints, which make up most of the deltas of detailed geometries.
+    while (count - n >= 32 && end - data >= 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        if (_mm256_movemask_epi8(bytes) != 0) {
+            break;
+        }
+        const __m128i low = _mm256_castsi256_si128(bytes);
+        const __m128i high = _mm256_extracti128_si256(bytes, 1);
+        __m256i* target = reinterpret_cast<__m256i*>(out + n);
+        _mm256_storeu_si256(target, _mm256_cvtepu8_epi32(low));
+        _mm256_storeu_si256(target + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(low, 8)));
+        _mm256_storeu_si256(target + 2, _mm256_cvtepu8_epi32(high));
+        _mm256_storeu_si256(target + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(high, 8)));
+        data += 32;
+        n += 32;
+    }
+#endif
+
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    while (n < count && end - data >= 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+
+        // A set bit for every byte that ends a varint.
+        uint32_t terminators = ~uint32_t(_mm_movemask_epi8(bytes)) & 0xFFFF;
+
+        if (terminators == 0xFFFF && count - n >= 16) {
+            // 16 single byte varints: widen them all at once.
+            const __m128i low = _mm_unpacklo_epi8(bytes, zero);
+            const __m128i high = _mm_unpackhi_epi8(bytes, zero);
+            __m128i* target = reinterpret_cast<__m128i*>(out + n);
+            _mm_storeu_si128(target, _mm_unpacklo_epi16(low, zero));
+            _mm_storeu_si128(target + 1, _mm_unpackhi_epi16(low, zero));
+            _mm_storeu_si128(target + 2, _mm_unpacklo_epi16(high, zero));
+            _mm_storeu_si128(target + 3, _mm_unpackhi_epi16(high, zero));
+            data += 16;
+            n += 16;
+            continue;
+        }
+
+        // Otherwise decode the varints that end within these 16 bytes. Their lengths follow from
+        // the terminators, so neither bytes nor lengths need a branch of their own.
+        std::size_t position = 0;
+        while (terminators != 0 && n < count && position <= 8) {
+            const std::size_t last = __builtin_ctz(terminators);
+            const std::size_t length = last + 1 - position;
+            if (length > 5) {
+                // Longer than a 32 bit value needs; leave it to the scalar decoder.
+                break;
+            }
+            uint64_t word;
+            std::memcpy(&word, data + position, sizeof(word));
+            out[n++] = combine(word, length);
+            position = last + 1;
+            terminators &= terminators - 1;
+        }
+
+        data += position;
+        if (position == 0) {
+            out[n++] = decodeVarint<false>(data, end);
+        }
+    }
+#endif
+
+    return n + decodeVarintsScalar(data, end, out + n, count - n);
+}
+
+} // namespace util
+} // namespace mbgl
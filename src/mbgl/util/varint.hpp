@@ -0,0 +1,28 @@
+#ifndef MBGL_UTIL_VARINT
+#define MBGL_UTIL_VARINT
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mbgl {
+namespace util {
+
+// Decodes up to `count` consecutive varints of a packed field from [data, end) into `out`, and
+// advances `data` past them. Returns the number of varints that were decoded, which is only less
+// than `count` at the end of the input. Values are truncated to 32 bits, like pbf::varint().
+// Throws the pbf exceptions for unterminated and too long varints.
+//
+// Uses SSE2 (and AVX2 when it is enabled at compile time) to decode runs of short varints.
+std::size_t decodeVarints(const uint8_t*& data, const uint8_t* end, uint32_t* out, std::size_t count);
+
+// The same, decoding one byte at a time. This is the fallback for other architectures.
+std::size_t decodeVarintsScalar(const uint8_t*& data, const uint8_t* end, uint32_t* out, std::size_t count);
+
+inline int32_t zigzag32(uint32_t value) {
+    return static_cast<int32_t>((value >> 1) ^ -(value & 1));
+}
+
+} // namespace util
+} // namespace mbgl
+
+#endif
@@ -6,18 +6,19 @@
 #include <mbgl/map/geometry_tile.hpp>
 #include <mbgl/style/style_layer.hpp>
 
+#include <algorithm>
 #include <cassert>
-#include <future>
+#include <thread>
 
 namespace mbgl {
 
+// The work that runs on the pool. These functions only use their arguments, so that any thread
+// can run them.
 class Worker::Impl {
 public:
-    Impl() = default;
-
-    void parseRasterTile(std::unique_ptr<RasterBucket> bucket,
-                         std::shared_ptr<const std::string> data,
-                         std::function<void(RasterTileParseResult)> callback) {
+    static void parseRasterTile(std::unique_ptr<RasterBucket> bucket,
+                                std::shared_ptr<const std::string> data,
+                                std::function<void(RasterTileParseResult)> callback) {
         try {
             bucket->setImage(decodeImage(*data));
             // Destruct the shared pointer before calling the callback.
@@ -28,11 +29,11 @@ public:
         }
     }
 
-    void parseGeometryTile(TileWorker* worker,
-                           std::vector<std::unique_ptr<StyleLayer>> layers,
-                           std::unique_ptr<GeometryTile> tile,
-                           PlacementConfig config,
-                           std::function<void(TileParseResult)> callback) {
+    static void parseGeometryTile(TileWorker* worker,
+                                  std::vector<std::unique_ptr<StyleLayer>> layers,
+                                  std::unique_ptr<GeometryTile> tile,
+                                  PlacementConfig config,
+                                  std::function<void(TileParseResult)> callback) {
         try {
             callback(worker->parseAllLayers(std::move(layers), std::move(tile), config));
         } catch (...) {
@@ -40,9 +41,9 @@ public:
         }
     }
 
-    void parsePendingGeometryTileLayers(TileWorker* worker,
-                                        PlacementConfig config,
-                                        std::function<void(TileParseResult)> callback) {
+    static void parsePendingGeometryTileLayers(TileWorker* worker,
+                                               PlacementConfig config,
+                                               std::function<void(TileParseResult)> callback) {
         try {
             callback(worker->parsePendingLayers(config));
         } catch (...) {
@@ -50,61 +51,64 @@ public:
         }
     }
 
-    void redoPlacement(TileWorker* worker,
-                       const std::unordered_map<std::string, std::unique_ptr<Bucket>>* buckets,
-                       PlacementConfig config,
-                       std::function<void()> callback) {
+    static void redoPlacement(TileWorker* worker,
+                              const std::unordered_map<std::string, std::unique_ptr<Bucket>>* buckets,
+                              PlacementConfig config,
+                              std::function<void()> callback) {
         worker->redoPlacement(buckets, config);
         callback();
     }
 };
 
-Worker::Worker(std::size_t count) {
-    util::ThreadContext context = { "Worker", util::ThreadType::Worker, util::ThreadPriority::Low };
-    for (std::size_t i = 0; i < count; i++) {
-        threads.emplace_back(std::make_unique<util::Thread<Impl>>(context));
-    }
+Worker::Worker(std::size_t count)
+    : pool({ "Worker", util::ThreadType::Worker, util::ThreadPriority::Low },
+           // hardware_concurrency() returns zero when it can't tell.
+           std::max<std::size_t>(count ? count : std::thread::hardware_concurrency(), 1)) {
 }
 
 Worker::~Worker() = default;
 
 std::unique_ptr<WorkRequest>
-Worker::parseRasterTile(std::unique_ptr<RasterBucket> bucket,
+Worker::parseRasterTile(double priority,
+                        std::unique_ptr<RasterBucket> bucket,
                         const std::shared_ptr<const std::string> data,
                         std::function<void(RasterTileParseResult)> callback) {
-    current = (current + 1) % threads.size();
-    return threads[current]->invokeWithCallback(&Worker::Impl::parseRasterTile, callback, bucket,
-                                                data);
+    return pool.invokeWithCallback(priority, &Impl::parseRasterTile, callback, bucket, data);
 }
 
 std::unique_ptr<WorkRequest>
-Worker::parseGeometryTile(TileWorker& worker,
+Worker::parseGeometryTile(double priority,
+                          TileWorker& worker,
                           std::vector<std::unique_ptr<StyleLayer>> layers,
                           std::unique_ptr<GeometryTile> tile,
                           PlacementConfig config,
                           std::function<void(TileParseResult)> callback) {
-    current = (current + 1) % threads.size();
-    return threads[current]->invokeWithCallback(&Worker::Impl::parseGeometryTile, callback, &worker,
-                                                std::move(layers), std::move(tile), config);
+    return pool.invokeWithCallback(priority, &Impl::parseGeometryTile, callback, &worker,
+                                   std::move(layers), std::move(tile), config);
 }
 
 std::unique_ptr<WorkRequest>
-Worker::parsePendingGeometryTileLayers(TileWorker& worker,
+Worker::parsePendingGeometryTileLayers(double priority,
+                                       TileWorker& worker,
                                        PlacementConfig config,
                                        std::function<void(TileParseResult)> callback) {
-    current = (current + 1) % threads.size();
-    return threads[current]->invokeWithCallback(&Worker::Impl::parsePendingGeometryTileLayers,
-                                                callback, &worker, config);
+    return pool.invokeWithCallback(priority, &Impl::parsePendingGeometryTileLayers, callback,
+                                   &worker, config);
 }
 
 std::unique_ptr<WorkRequest>
-Worker::redoPlacement(TileWorker& worker,
+Worker::redoPlacement(double priority,
+                      TileWorker& worker,
                       const std::unordered_map<std::string, std::unique_ptr<Bucket>>& buckets,
                       PlacementConfig config,
                       std::function<void()> callback) {
-    current = (current + 1) % threads.size();
-    return threads[current]->invokeWithCallback(&Worker::Impl::redoPlacement, callback, &worker,
-                                                &buckets, config);
+    // Placement runs after parsing the tiles of the viewport, but before any background work.
+    if (priority < kBackgroundWorkPriority) {
+        priority += kPlacementWorkPriority;
+    }
+
+    return pool.invokeWithCallback(priority, &Impl::redoPlacement, callback, &worker, &buckets,
+                                   config);
 }
 
 } // end namespace mbgl
@@ -2,7 +2,7 @@
 #define MBGL_UTIL_WORKER
 
 #include <mbgl/util/noncopyable.hpp>
-#include <mbgl/util/thread.hpp>
+#include <mbgl/util/thread_pool.hpp>
 #include <mbgl/map/tile_worker.hpp>
 
 #include <functional>
@@ -18,12 +18,21 @@ using RasterTileParseResult = mapbox::util::variant<
     std::unique_ptr<Bucket>, // success
     std::exception_ptr>;     // error
 
+// Work priorities: lower values run first. Tiles of the viewport are parsed first, ordered by
+// their distance from the viewport center, then text is placed, and then tiles are parsed that
+// aren't visible anymore, e.g. because they're moving to the tile cache. Placement is offset by
+// kPlacementWorkPriority automatically; work for hidden tiles should be offset by
+// kBackgroundWorkPriority.
+const double kPlacementWorkPriority = 1 << 20;
+const double kBackgroundWorkPriority = 1 << 21;
+
 class Worker : public mbgl::util::noncopyable {
 public:
-    explicit Worker(std::size_t count);
+    // Work is shared by `count` threads; zero uses one per hardware thread.
+    explicit Worker(std::size_t count = 0);
     ~Worker();
 
-    // Request work be done on a thread pool. Callbacks are executed on the invoking
+    // Request work be done on the thread pool. Callbacks are executed on the invoking
     // thread, which must have a run loop, after the work is complete.
     //
     // The return value represents the request to perform the work asynchronously.
@@ -35,29 +44,32 @@ public:
 
     using Request = std::unique_ptr<WorkRequest>;
 
-    Request parseRasterTile(std::unique_ptr<RasterBucket> bucket,
+    Request parseRasterTile(double priority,
+                            std::unique_ptr<RasterBucket> bucket,
                             std::shared_ptr<const std::string> data,
                             std::function<void(RasterTileParseResult)> callback);
 
-    Request parseGeometryTile(TileWorker&,
+    Request parseGeometryTile(double priority,
+                              TileWorker&,
                               std::vector<std::unique_ptr<StyleLayer>>,
                               std::unique_ptr<GeometryTile>,
                               PlacementConfig,
                               std::function<void(TileParseResult)> callback);
 
-    Request parsePendingGeometryTileLayers(TileWorker&,
+    Request parsePendingGeometryTileLayers(double priority,
+                                           TileWorker&,
                                            PlacementConfig config,
                                            std::function<void(TileParseResult)> callback);
 
-    Request redoPlacement(TileWorker&,
+    Request redoPlacement(double priority,
+                          TileWorker&,
                           const std::unordered_map<std::string, std::unique_ptr<Bucket>>&,
                           PlacementConfig config,
                           std::function<void()> callback);
 
 private:
     class Impl;
-    std::vector<std::unique_ptr<util::Thread<Impl>>> threads;
-    std::size_t current = 0;
+    util::ThreadPool pool;
 };
 } // namespace mbgl
 
@@ -0,0 +1,104 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/geometry/glyph_atlas.hpp>
+#include <mbgl/text/font_stack.hpp>
+#include <mbgl/util/thread_context.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+// Glyphs that take up 20 by 20 pixels of the atlas, with their buffer, padding and alignment.
+FontStack fontStack(const std::u32string& chars) {
+    FontStack stack;
+    for (uint32_t chr : chars) {
+        SDFGlyph glyph;
+        glyph.id = chr;
+        glyph.metrics.width = 10;
+        glyph.metrics.height = 10;
+        glyph.bitmap = std::string(16 * 16, char(chr));
+        stack.insert(chr, glyph);
+    }
+    return stack;
+}
+
+} // namespace
+
+TEST(GlyphAtlas, Pages) {
+    util::ThreadContext context { "Map", util::ThreadType::Map, util::ThreadPriority::Regular };
+    util::ThreadContext::Set(&context);
+
+    // Pages hold four glyphs each.
+    GlyphAtlas atlas(40, 40, 2);
+    const FontStack stack = fontStack(U"abcdef");
+
+    GlyphPositions first, second, third;
+    EXPECT_EQ(0u, atlas.addGlyphs(1, U"abc", "Test", stack, first));
+    EXPECT_EQ(0u, atlas.addGlyphs(2, U"abcd", "Test", stack, second));
+    EXPECT_EQ(first.at('a').rect, second.at('a').rect);
+
+    // All glyphs of a batch go to the same page.
+    EXPECT_EQ(1u, atlas.addGlyphs(3, U"aef", "Test", stack, third));
+    EXPECT_EQ(3u, third.size());
+
+    const auto usage = atlas.getPageUsage();
+    ASSERT_EQ(2u, usage.size());
+    EXPECT_EQ(4u, usage[0].glyphs);
+    EXPECT_FLOAT_EQ(1.0f, usage[0].occupancy);
+    EXPECT_EQ(3u, usage[1].glyphs);
+    EXPECT_FLOAT_EQ(0.75f, usage[1].occupancy);
+    EXPECT_EQ(0u, usage[1].released);
+}
+
+TEST(GlyphAtlas, ReleasedGlyphs) {
+    util::ThreadContext context { "Map", util::ThreadType::Map, util::ThreadPriority::Regular };
+    util::ThreadContext::Set(&context);
+
+    GlyphAtlas atlas(40, 40, 1);
+    const FontStack stack = fontStack(U"abcdefg");
+
+    GlyphPositions first;
+    EXPECT_EQ(0u, atlas.addGlyphs(1, U"abcd", "Test", stack, first));
+
+    // Released glyphs stay in the page for tiles that come back.
+    atlas.removeGlyphs(1);
+    EXPECT_EQ(0u, atlas.getPageUsage()[0].glyphs);
+    EXPECT_EQ(4u, atlas.getPageUsage()[0].released);
+
+    GlyphPositions again;
+    atlas.addGlyphs(2, U"d", "Test", stack, again);
+    EXPECT_EQ(first.at('d').rect, again.at('d').rect);
+    EXPECT_EQ(1u, atlas.getPageUsage()[0].glyphs);
+    EXPECT_EQ(3u, atlas.getPageUsage()[0].released);
+
+    // Until their space is needed; the glyphs that were released first go first.
+    GlyphPositions second;
+    EXPECT_EQ(0u, atlas.addGlyphs(3, U"ef", "Test", stack, second));
+    EXPECT_EQ(3u, atlas.getPageUsage()[0].glyphs);
+    EXPECT_EQ(1u, atlas.getPageUsage()[0].released);
+
+    GlyphPositions third;
+    atlas.addGlyphs(4, U"c", "Test", stack, third);
+    EXPECT_EQ(first.at('c').rect, third.at('c').rect);
+}
+
+TEST(GlyphAtlas, Overflow) {
+    util::ThreadContext context { "Map", util::ThreadType::Map, util::ThreadPriority::Regular };
+    util::ThreadContext::Set(&context);
+
+    GlyphAtlas atlas(40, 40, 1);
+    const FontStack stack = fontStack(U"abcdef");
+
+    GlyphPositions first;
+    atlas.addGlyphs(1, U"ab", "Test", stack, first);
+
+    // A batch that doesn't fit gives none of its glyphs back until there is no other option.
+    GlyphPositions second;
+    EXPECT_EQ(0u, atlas.addGlyphs(2, U"bcdef", "Test", stack, second));
+    EXPECT_EQ(3u, second.size());
+    EXPECT_EQ(4u, atlas.getPageUsage()[0].glyphs);
+
+    atlas.removeGlyphs(1);
+    EXPECT_EQ(3u, atlas.getPageUsage()[0].glyphs);
+    EXPECT_EQ(1u, atlas.getPageUsage()[0].released);
+}
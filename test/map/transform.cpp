@@ -231,3 +231,38 @@ TEST(Transform, Padding) {
     ASSERT_DOUBLE_EQ(manualShiftedCenter.latitude, shiftedCenter.latitude);
     ASSERT_DOUBLE_EQ(manualShiftedCenter.longitude, shiftedCenter.longitude);
 }
+
+TEST(Transform, TransitionPath) {
+    MockView view;
+    Transform transform(view, ConstrainMode::HeightOnly);
+    transform.resize({{ 1000, 1000 }});
+    transform.setLatLngZoom({ 0, 0 }, 2);
+
+    // Instantaneous changes don't have a path.
+    ASSERT_EQ(nullptr, transform.getTransitionPath());
+
+    CameraOptions camera;
+    camera.center = LatLng { 10, -100 };
+    camera.zoom = 10;
+    AnimationOptions animation;
+    animation.duration = Seconds(1);
+    transform.flyTo(camera, animation);
+
+    const auto path = transform.getTransitionPath();
+    ASSERT_NE(nullptr, path);
+    ASSERT_FALSE(path->empty());
+
+    // The path starts with the destination...
+    ASSERT_NEAR(10, path->front().getLatLng().latitude, 0.000001);
+    ASSERT_NEAR(-100, path->front().getLatLng().longitude, 0.000001);
+    ASSERT_NEAR(10, path->front().getZoom(), 0.000001);
+
+    // ...without moving the camera ahead of time.
+    ASSERT_NEAR(0, transform.getLatLng().latitude, 0.000001);
+    ASSERT_NEAR(0, transform.getLatLng().longitude, 0.000001);
+    ASSERT_DOUBLE_EQ(2, transform.getZoom());
+
+    // Interrupting the animation discards the path.
+    transform.cancelTransitions();
+    ASSERT_EQ(nullptr, transform.getTransitionPath());
+}
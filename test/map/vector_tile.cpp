@@ -0,0 +1,287 @@
+#include "../fixtures/util.hpp"
+#include "../fixtures/stub_file_source.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/storage/file_source.hpp>
+#include <mbgl/style/filter_expression.hpp>
+#include <mbgl/style/filter_expression_private.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <mbgl/util/thread_context.hpp>
+#include <mbgl/util/timer.hpp>
+
+#include <chrono>
+#include <iostream>
+
+using namespace mbgl;
+
+namespace {
+
+std::string varint(uint64_t value) {
+    std::string result;
+    while (value >= 0x80) {
+        result += char((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    return result + char(value);
+}
+
+std::string message(uint32_t tag, const std::string& data) {
+    return varint((tag << 3) | 2) + varint(data.size()) + data;
+}
+
+std::string feature(uint32_t key, uint32_t value) {
+    return message(2, varint(key) + varint(value)) + // tags
+           varint((3 << 3) | 0) + varint(1) +        // type: point
+           message(4, varint(9) + varint(2) + varint(4)); // geometry: moveTo(1, 2)
+}
+
+std::string layer(const std::string& name, const std::string& features) {
+    return message(1, name) +
+           features +
+           // The second key is a duplicate, but still takes up index 1.
+           message(3, "name") + message(3, "name") + message(3, "class") +
+           message(4, message(1, "a")) + message(4, message(1, "b"));
+}
+
+FilterExpression parseFilter(const char* expression) {
+    rapidjson::GenericDocument<rapidjson::UTF8<>, rapidjson::CrtAllocator> doc;
+    doc.Parse<0>(expression);
+    return parseFilterExpression(doc);
+}
+
+// Pairs of a tile layer and a filter that applies to it.
+const std::vector<std::pair<std::string, const char*>> filters = {
+    { "road", R"(["==", "class", "motorway"])" },
+    { "road", R"(["!=", "class", "street"])" },
+    { "road", R"(["in", "class", "main", "street", "street_limited", "service", "driveway", "path"])" },
+    { "road", R"(["all", ["==", "$type", "LineString"], ["!in", "class", "path", "service"], ["!=", "oneway", 1]])" },
+    { "road", R"(["==", "nonexistent", "value"])" },
+    { "poi_label", R"(["<=", "scalerank", 2])" },
+    { "poi_label", R"(["any", [">", "localrank", 1], ["==", "maki", "cafe"], ["==", "$type", "Polygon"]])" },
+    { "poi_label", R"(["none", ["in", "type", "Park", "Cemetery"], [">=", "scalerank", 3]])" },
+    { "place_label", R"(["<", "scalerank", 4])" },
+    { "landuse", R"(["in", "class", "park", "cemetery", "hospital", "school", "wood", "pitch"])" },
+};
+
+} // namespace
+
+TEST(VectorTile, Layers) {
+    const auto data = std::make_shared<std::string>(
+        message(3, layer("roads", message(2, feature(0, 0)) + message(2, feature(2, 1)))) +
+        message(3, layer("water", message(2, feature(0, 1)))));
+    VectorTile tile(data);
+
+    EXPECT_EQ(nullptr, tile.getLayer("buildings"));
+
+    auto roads = tile.getLayer("roads");
+    ASSERT_NE(nullptr, roads);
+    EXPECT_EQ(roads, tile.getLayer("roads"));
+    ASSERT_EQ(2u, roads->featureCount());
+
+    auto first = roads->getFeature(0);
+    EXPECT_EQ(FeatureType::Point, first->getType());
+    EXPECT_EQ(Value(std::string("a")), *first->getValue("name"));
+    EXPECT_FALSE(first->getValue("class"));
+    EXPECT_EQ(GeometryCollection({ { { 1, 2 } } }), first->getGeometries());
+    EXPECT_EQ(Value(std::string("b")), *roads->getFeature(1)->getValue("class"));
+
+    auto water = tile.getLayer("water");
+    ASSERT_NE(nullptr, water);
+    EXPECT_EQ(1u, water->featureCount());
+    EXPECT_EQ(Value(std::string("b")), *water->getFeature(0)->getValue("name"));
+}
+
+TEST(VectorTile, EachFeature) {
+    const auto data = std::make_shared<std::string>(
+        message(3, layer("roads", message(2, feature(0, 0)) + message(2, feature(0, 1)) +
+                                  message(2, feature(0, 0)))));
+    VectorTile tile(data);
+
+    auto roads = tile.getLayer("roads");
+    ASSERT_NE(nullptr, roads);
+
+    std::vector<Value> names;
+    roads->eachFeature([&](const GeometryTileFeature& feature) {
+        names.push_back(*feature.getValue("name"));
+        return names.size() < 2;
+    });
+
+    ASSERT_EQ(2u, names.size());
+    EXPECT_EQ(Value(std::string("a")), names[0]);
+    EXPECT_EQ(Value(std::string("b")), names[1]);
+}
+
+TEST(VectorTile, ReadGeometries) {
+    VectorTile tile(std::make_shared<std::string>(util::read_file("test/fixtures/resources/vector.pbf")));
+
+    // Decoding one feature after another into the same collection gives the same geometries.
+    GeometryCollection geometries;
+    for (const auto name : { "road", "water", "poi_label" }) {
+        auto layer = tile.getLayer(name);
+        ASSERT_NE(nullptr, layer);
+        for (std::size_t i = 0; i < layer->featureCount(); i++) {
+            const auto feature = layer->getFeature(i);
+            feature->readGeometries(geometries);
+            EXPECT_EQ(feature->getGeometries(), geometries);
+        }
+    }
+}
+
+TEST(VectorTile, FilteredFeatures) {
+    VectorTile tile(std::make_shared<std::string>(util::read_file("test/fixtures/resources/vector.pbf")));
+
+    for (const auto& filter : filters) {
+        auto layer = tile.getLayer(filter.first);
+        ASSERT_NE(nullptr, layer);
+        const FilterExpression expression = parseFilter(filter.second);
+
+        std::vector<std::size_t> expected;
+        for (std::size_t i = 0; i < layer->featureCount(); i++) {
+            if (evaluate(expression, GeometryTileFeatureExtractor(*layer->getFeature(i)))) {
+                expected.push_back(i);
+            }
+        }
+
+        // Match the filtered features to their indices by their geometries.
+        std::vector<std::size_t> actual;
+        std::size_t next = 0;
+        layer->eachFilteredFeature(expression, [&](const GeometryTileFeature& feature) {
+            const auto geometries = feature.getGeometries();
+            while (next < layer->featureCount() && layer->getFeature(next)->getGeometries() != geometries) {
+                next++;
+            }
+            actual.push_back(next++);
+            return true;
+        });
+
+        EXPECT_EQ(expected, actual) << filter.second;
+    }
+}
+
+// Compares filtering with a compiled filter against evaluating the filter expression on every
+// feature. Run with --gtest_also_run_disabled_tests.
+TEST(VectorTile, DISABLED_FilterBenchmark) {
+    VectorTile tile(std::make_shared<std::string>(util::read_file("test/fixtures/resources/vector.pbf")));
+    const std::size_t iterations = 200;
+
+    using Clock = std::chrono::steady_clock;
+    Clock::duration extracted(0);
+    Clock::duration compiled(0);
+
+    for (const auto& filter : filters) {
+        auto layer = tile.getLayer(filter.first);
+        ASSERT_NE(nullptr, layer);
+        const FilterExpression expression = parseFilter(filter.second);
+
+        std::size_t expected = 0;
+        auto start = Clock::now();
+        for (std::size_t n = 0; n < iterations; n++) {
+            layer->eachFeature([&](const GeometryTileFeature& feature) {
+                expected += evaluate(expression, GeometryTileFeatureExtractor(feature));
+                return true;
+            });
+        }
+        extracted += Clock::now() - start;
+
+        std::size_t actual = 0;
+        start = Clock::now();
+        for (std::size_t n = 0; n < iterations; n++) {
+            layer->eachFilteredFeature(expression, [&](const GeometryTileFeature&) {
+                actual++;
+                return true;
+            });
+        }
+        compiled += Clock::now() - start;
+
+        EXPECT_EQ(expected, actual) << filter.second;
+    }
+
+    using std::chrono::microseconds;
+    std::cout << "extracted: " << std::chrono::duration_cast<microseconds>(extracted).count() / iterations << "us, "
+              << "compiled: " << std::chrono::duration_cast<microseconds>(compiled).count() / iterations << "us" << std::endl;
+}
+
+TEST(VectorTile, DecodedTileCache) {
+    DecodedTileCache cache(2);
+    auto tile = [] { return std::make_shared<const VectorTile>(std::make_shared<std::string>()); };
+
+    const auto a = tile();
+    const auto b = tile();
+    const auto c = tile();
+
+    cache.add(TileID { 14, 10, 20, 14 }, { a, {}, {}, {} });
+    cache.add(TileID { 14, 11, 20, 14 }, { b, {}, {}, {} });
+
+    // Overscaled tiles find the tile they were loaded from.
+    ASSERT_NE(nullptr, cache.get(TileID { 16, 10, 20, 14 }));
+    EXPECT_EQ(a, cache.get(TileID { 22, 10, 20, 14 })->tile);
+    EXPECT_EQ(nullptr, cache.get(TileID { 16, 10, 21, 14 }));
+
+    // The least recently used tile is evicted first.
+    cache.add(TileID { 14, 12, 20, 14 }, { c, {}, {}, {} });
+    EXPECT_EQ(nullptr, cache.get(TileID { 15, 11, 20, 14 }));
+    EXPECT_EQ(a, cache.get(TileID { 15, 10, 20, 14 })->tile);
+    EXPECT_EQ(c, cache.get(TileID { 15, 12, 20, 14 })->tile);
+
+    cache.clear();
+    EXPECT_EQ(nullptr, cache.get(TileID { 15, 10, 20, 14 }));
+}
+
+TEST(VectorTile, DecodedTileMonitor) {
+    util::RunLoop loop;
+    util::ThreadContext context { "Map", util::ThreadType::Map, util::ThreadPriority::Regular };
+    util::ThreadContext::Set(&context);
+
+    StubFileSource fileSource;
+    util::ThreadContext::setFileSource(&fileSource);
+
+    auto data = std::make_shared<const std::string>("tile");
+    DecodedTileCache cache;
+    cache.add(TileID { 14, 10, 20, 14 }, { std::make_shared<const VectorTile>(data), {}, {}, data });
+
+    int called = 0;
+    auto callback = [&] (std::exception_ptr err, std::unique_ptr<GeometryTile> tile,
+                         optional<SystemTimePoint>, optional<SystemTimePoint>) {
+        EXPECT_EQ(nullptr, err);
+        EXPECT_NE(nullptr, tile);
+        called++;
+    };
+
+    util::Timer timer;
+    auto runFor = [&] (Duration duration) {
+        timer.start(duration, Duration::zero(), [&] { loop.stop(); });
+        loop.run();
+    };
+
+    // Overscaled tiles that reuse a decoded tile still get it asynchronously, and still revalidate
+    // it. The same data doesn't reply again.
+    fileSource.tileResponse = [&] (const Resource& resource) {
+        EXPECT_EQ(14, int(resource.tileData->z));
+        Response response;
+        response.data = std::make_shared<const std::string>("tile");
+        return response;
+    };
+
+    VectorTileMonitor monitor(TileID { 16, 10, 20, 14 }, 1.0, "http://tile/{z}/{x}/{y}", &cache);
+    auto req = monitor.monitorTile(callback);
+    EXPECT_EQ(0, called);
+    runFor(Milliseconds(50));
+    EXPECT_EQ(1, called);
+
+    // Changed data replies again, and replaces the decoded tile.
+    called = 0;
+    fileSource.tileResponse = [&] (const Resource&) {
+        Response response;
+        response.data = std::make_shared<const std::string>("changed");
+        return response;
+    };
+
+    VectorTileMonitor changed(TileID { 15, 10, 20, 14 }, 1.0, "http://tile/{z}/{x}/{y}", &cache);
+    auto changedReq = changed.monitorTile(callback);
+    runFor(Milliseconds(50));
+    EXPECT_EQ(2, called);
+    EXPECT_EQ("changed", *cache.get(TileID { 15, 10, 20, 14 })->data);
+
+    util::ThreadContext::Set(nullptr);
+}
@@ -0,0 +1,102 @@
+#include "storage.hpp"
+
+#include "sqlite_cache_impl.hpp"
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <mbgl/util/timer.hpp>
+#include <mbgl/util/chrono.hpp>
+
+namespace {
+
+void putEntry(mbgl::SQLiteCache::Impl& cache, const std::string& url, const std::string& data) {
+    using namespace mbgl;
+
+    Response response;
+    response.data = std::make_shared<std::string>(data);
+    cache.put({ Resource::Unknown, url }, response);
+}
+
+std::string getEntry(mbgl::SQLiteCache::Impl& cache, const std::string& url) {
+    using namespace mbgl;
+
+    std::string result;
+    cache.get({ Resource::Unknown, url }, [&] (std::unique_ptr<Response> res) {
+        if (res && res->data) {
+            result = *res->data;
+        }
+    });
+    return result;
+}
+
+} // namespace
+
+TEST_F(Storage, CacheBatchingVisibleBeforeCommit) {
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    SQLiteCache::Impl cache(":memory:", Seconds(60), 3);
+
+    // Queued entries are served from the write queue.
+    putEntry(cache, "http://127.0.0.1:3000/a", "a");
+    putEntry(cache, "http://127.0.0.1:3000/b", "b");
+    EXPECT_EQ("a", getEntry(cache, "http://127.0.0.1:3000/a"));
+    EXPECT_EQ("b", getEntry(cache, "http://127.0.0.1:3000/b"));
+
+    // A later write to the same URL replaces the queued one.
+    putEntry(cache, "http://127.0.0.1:3000/a", "a2");
+    EXPECT_EQ("a2", getEntry(cache, "http://127.0.0.1:3000/a"));
+
+    // Reaching the batch size commits all queued entries.
+    putEntry(cache, "http://127.0.0.1:3000/c", "c");
+    EXPECT_EQ("a2", getEntry(cache, "http://127.0.0.1:3000/a"));
+    EXPECT_EQ("b", getEntry(cache, "http://127.0.0.1:3000/b"));
+    EXPECT_EQ("c", getEntry(cache, "http://127.0.0.1:3000/c"));
+}
+
+TEST_F(Storage, CacheBatchingInterval) {
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    SQLiteCache::Impl cache(":memory:", Milliseconds(50), 100);
+
+    putEntry(cache, "http://127.0.0.1:3000/a", "a");
+
+    util::Timer timer;
+    timer.start(Milliseconds(100), Duration::zero(), [&] {
+        // The batch was committed by now; a refresh of the committed entry must still apply.
+        cache.refresh({ Resource::Unknown, "http://127.0.0.1:3000/a" }, SystemClock::now() + Seconds(10));
+        cache.flush();
+        EXPECT_EQ("a", getEntry(cache, "http://127.0.0.1:3000/a"));
+        loop.stop();
+    });
+
+    loop.run();
+}
+
+TEST_F(Storage, CacheBatchingFlushOnDestruction) {
+    using namespace mbgl;
+
+    const std::string path = "test/fixtures/cache_batching.db";
+    try {
+        util::deleteFile(path);
+    } catch (util::IOException&) {
+    }
+
+    util::RunLoop loop;
+
+    {
+        SQLiteCache::Impl cache(path, Seconds(60), 100);
+        putEntry(cache, "http://127.0.0.1:3000/a", "a");
+        putEntry(cache, "http://127.0.0.1:3000/b", "b");
+    }
+
+    {
+        SQLiteCache::Impl cache(path);
+        EXPECT_EQ("a", getEntry(cache, "http://127.0.0.1:3000/a"));
+        EXPECT_EQ("b", getEntry(cache, "http://127.0.0.1:3000/b"));
+    }
+
+    util::deleteFile(path);
+}
@@ -0,0 +1,100 @@
+#include "storage.hpp"
+
+#include "sqlite_cache_impl.hpp"
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/string.hpp>
+
+#include <sqlite3.h>
+
+namespace {
+
+const char* const cachePath = "test/fixtures/cache_compression.db";
+
+std::string tileURL(int i) {
+    return "http://127.0.0.1:3000/" + mbgl::util::toString(i) + ".pbf";
+}
+
+std::string tileData(int i) {
+    std::string data;
+    for (int j = 0; j < 50; j++) {
+        data += "{\"layer\":\"water\",\"class\":\"river\",\"id\":" + mbgl::util::toString(i * 1000 + j) + "}";
+    }
+    return data;
+}
+
+void putTile(mbgl::SQLiteCache::Impl& cache, int i) {
+    using namespace mbgl;
+
+    Response response;
+    response.data = std::make_shared<std::string>(tileData(i));
+    cache.put({ Resource::Tile, tileURL(i) }, response);
+}
+
+std::string getTile(mbgl::SQLiteCache::Impl& cache, int i) {
+    using namespace mbgl;
+
+    std::string result;
+    cache.get({ Resource::Tile, tileURL(i) }, [&] (std::unique_ptr<Response> res) {
+        if (res && res->data) {
+            result = *res->data;
+        }
+    });
+    return result;
+}
+
+int queryInt(const char* sql) {
+    sqlite3* db;
+    sqlite3_open_v2(cachePath, &db, SQLITE_OPEN_READONLY, nullptr);
+    sqlite3_stmt* stmt;
+    sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+    const int result = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    sqlite3_close_v2(db);
+    return result;
+}
+
+} // namespace
+
+TEST_F(Storage, CacheDictionaryCompression) {
+    using namespace mbgl;
+
+    try {
+        util::deleteFile(cachePath);
+    } catch (util::IOException&) {
+    }
+
+    {
+        SQLiteCache::Impl cache(cachePath);
+        cache.setDictionaryCompression(true);
+
+        for (int i = 0; i < 60; i++) {
+            putTile(cache, i);
+        }
+
+        for (int i = 0; i < 60; i++) {
+            EXPECT_EQ(tileData(i), getTile(cache, i));
+        }
+    }
+
+    // The dictionary is built from the first 50 tiles and used from then on.
+    EXPECT_EQ(1, queryInt("SELECT COUNT(*) FROM `http_cache_dictionaries`"));
+    EXPECT_EQ(11, queryInt("SELECT COUNT(*) FROM `http_cache` WHERE `dictionary` != 0"));
+
+    // The dictionary is loaded from the database when reading, and reused when writing.
+    {
+        SQLiteCache::Impl cache(cachePath);
+        cache.setDictionaryCompression(true);
+
+        for (int i = 0; i < 60; i++) {
+            EXPECT_EQ(tileData(i), getTile(cache, i));
+        }
+
+        putTile(cache, 60);
+        EXPECT_EQ(tileData(60), getTile(cache, 60));
+    }
+
+    EXPECT_EQ(1, queryInt("SELECT COUNT(*) FROM `http_cache_dictionaries`"));
+    EXPECT_EQ(12, queryInt("SELECT COUNT(*) FROM `http_cache` WHERE `dictionary` != 0"));
+}
@@ -0,0 +1,142 @@
+#include "storage.hpp"
+
+#include <mbgl/storage/sqlite_cache.hpp>
+#include <mbgl/storage/memory_cache.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+TEST_F(Storage, CacheMemoryHit) {
+    SCOPED_TEST(CacheMemoryHit)
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    SQLiteCache cache(":memory:");
+    cache.setMaximumMemoryCacheSize(1024);
+
+    const Resource resource { Resource::Unknown, "http://127.0.0.1:3000/test" };
+    Response response;
+    response.data = std::make_shared<std::string>("Hello World!");
+    cache.put(resource, response);
+
+    auto req = cache.get(resource, [&](std::unique_ptr<Response> res) {
+        ASSERT_TRUE(res.get());
+        ASSERT_TRUE(res->data.get());
+        // The response data is shared with the memory cache rather than copied.
+        EXPECT_EQ(response.data.get(), res->data.get());
+
+        const auto stats = cache.getMemoryCacheStats();
+        EXPECT_EQ(1u, stats.hits);
+        EXPECT_EQ(0u, stats.misses);
+        EXPECT_EQ(1u, stats.entries);
+
+        CacheMemoryHit.finish();
+        loop.stop();
+    });
+
+    loop.run();
+}
+
+TEST_F(Storage, CacheMemoryMissPopulates) {
+    SCOPED_TEST(CacheMemoryMissPopulates)
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    SQLiteCache cache(":memory:");
+
+    // Store the response with the memory cache disabled, so that only the database has it.
+    const Resource resource { Resource::Unknown, "http://127.0.0.1:3000/test" };
+    Response response;
+    response.data = std::make_shared<std::string>("Hello World!");
+    cache.put(resource, response);
+    cache.setMaximumMemoryCacheSize(1024);
+
+    std::unique_ptr<WorkRequest> req1;
+    std::unique_ptr<WorkRequest> req2;
+
+    req1 = cache.get(resource, [&](std::unique_ptr<Response> res) {
+        req1.reset();
+        ASSERT_TRUE(res.get());
+        EXPECT_EQ(1u, cache.getMemoryCacheStats().misses);
+
+        req2 = cache.get(resource, [&](std::unique_ptr<Response> res2) {
+            req2.reset();
+            ASSERT_TRUE(res2.get());
+            ASSERT_TRUE(res2->data.get());
+            EXPECT_EQ("Hello World!", *res2->data);
+            EXPECT_EQ(1u, cache.getMemoryCacheStats().hits);
+
+            CacheMemoryMissPopulates.finish();
+            loop.stop();
+        });
+    });
+
+    loop.run();
+}
+
+TEST_F(Storage, CacheMemoryEviction) {
+    using namespace mbgl;
+
+    MemoryCache cache(100);
+
+    Response response;
+    response.data = std::make_shared<std::string>(40, 'x');
+
+    cache.put("a", response);
+    cache.put("b", response);
+    EXPECT_TRUE(cache.get("a").get());
+
+    // "b" is the least recently used entry and has to make room.
+    cache.put("c", response);
+    EXPECT_FALSE(cache.get("b").get());
+    EXPECT_TRUE(cache.get("a").get());
+    EXPECT_TRUE(cache.get("c").get());
+
+    // Entries larger than the cache are not kept.
+    response.data = std::make_shared<std::string>(200, 'x');
+    cache.put("d", response);
+    EXPECT_FALSE(cache.get("d").get());
+
+    auto stats = cache.getStats();
+    EXPECT_EQ(3u, stats.hits);
+    EXPECT_EQ(2u, stats.misses);
+    EXPECT_EQ(1u, stats.evictions);
+    EXPECT_EQ(2u, stats.entries);
+    EXPECT_EQ(82u, stats.size);
+
+    // Shrinking the cache evicts entries until it fits.
+    cache.setMaximumSize(50);
+    stats = cache.getStats();
+    EXPECT_EQ(1u, stats.entries);
+    EXPECT_EQ(2u, stats.evictions);
+    EXPECT_TRUE(cache.get("c").get());
+}
+
+TEST_F(Storage, CacheMemoryEntrySizeLimit) {
+    using namespace mbgl;
+
+    MemoryCache cache(1000);
+
+    Response response;
+    response.data = std::make_shared<std::string>(100, 'x');
+    cache.put("a", response);
+    response.data = std::make_shared<std::string>(50, 'x');
+    cache.put("b", response);
+
+    // Lowering the limit drops the entries that are too large now.
+    cache.setMaximumEntrySize(50);
+    EXPECT_FALSE(cache.get("a").get());
+    EXPECT_TRUE(cache.get("b").get());
+
+    // Responses with more data than the limit are not kept, and don't keep an older entry alive.
+    response.data = std::make_shared<std::string>(51, 'x');
+    cache.put("b", response);
+    cache.put("c", response);
+    EXPECT_FALSE(cache.get("b").get());
+    EXPECT_FALSE(cache.get("c").get());
+
+    const auto stats = cache.getStats();
+    EXPECT_EQ(1u, stats.evictions);
+    EXPECT_EQ(0u, stats.entries);
+    EXPECT_EQ(0u, stats.size);
+}
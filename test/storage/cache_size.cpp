@@ -1,5 +1,6 @@
 #include "storage.hpp"
 
+#include "sqlite_cache_impl.hpp"
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/response.hpp>
 #include <mbgl/storage/sqlite_cache.hpp>
@@ -7,10 +8,14 @@
 #include <mbgl/util/string.hpp>
 #include <mbgl/util/timer.hpp>
 #include <mbgl/util/chrono.hpp>
+#include <mbgl/util/io.hpp>
 
+#include <functional>
 #include <memory>
 #include <random>
 
+#include <sys/stat.h>
+
 bool tileIsCached(mbgl::SQLiteCache* cache, unsigned id) {
     using namespace mbgl;
 
@@ -48,7 +53,7 @@ void insertTile(mbgl::SQLiteCache* cache, unsigned id, uint64_t size) {
     // Fill data with garbage so SQLite won't try to
     // optimize allocation by reusing pages.
     static std::mt19937 generator;
-    std::generate_n(data->begin(), size, generator);
+    std::generate_n(data->begin(), size, std::ref(generator));
 
     response.data = data;
 
@@ -211,6 +216,49 @@ TEST_F(Storage, CacheSizePruneLeastAccessed) {
     EXPECT_TRUE(tileIsCached(&cache, 9));
 }
 
+TEST_F(Storage, CacheSizePruneLeastAccessedFromMemory) {
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    SQLiteCache cache(":memory:");
+
+    const unsigned entryCount = 400;
+    const uint64_t entrySize = 10 * 1024; // 10 KB
+
+    cache.setMaximumCacheEntrySize(entrySize + 1);
+    cache.setMaximumCacheSize(entrySize * 350);
+    cache.setMaximumMemoryCacheSize(entrySize * 250);
+
+    for (unsigned i = 0; i < entryCount; ++i) {
+        insertTile(&cache, i, entrySize);
+
+        if (i == entryCount / 2) {
+            bool done = false;
+
+            util::Timer timer;
+            timer.start(Milliseconds(1300),
+                        Duration::zero(),
+                        [&done] { done = true; });
+
+            while (!done) {
+                loop.runOnce();
+            }
+
+            // Served from memory, but the database entry is still marked as accessed.
+            EXPECT_TRUE(tileIsCached(&cache, 7));
+            EXPECT_EQ(1u, cache.getMemoryCacheStats().hits);
+        }
+    }
+
+    // Look at the database only.
+    cache.setMaximumMemoryCacheSize(0);
+
+    EXPECT_FALSE(tileIsCached(&cache, 6));
+    EXPECT_FALSE(tileIsCached(&cache, 8));
+
+    EXPECT_TRUE(tileIsCached(&cache, 7));
+}
+
 TEST_F(Storage, CacheSizeStress) {
     using namespace mbgl;
 
@@ -239,3 +287,136 @@ TEST_F(Storage, CacheSizeStress) {
 
     EXPECT_LT(cacheSize(&cache, entryCount, entrySize), entrySize * 300);
 }
+
+TEST_F(Storage, CacheSizePinnedEntries) {
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    SQLiteCache cache(":memory:");
+
+    const unsigned entryCount = 400;
+    const uint64_t entrySize = 10 * 1024; // 10 KB
+
+    cache.setMaximumCacheEntrySize(entrySize + 1);
+    cache.setMaximumCacheSize(entrySize * 200);
+
+    insertTile(&cache, 0, entrySize);
+    cache.pin({ Resource::Kind::Tile, "http://tile0" });
+
+    for (unsigned i = 1; i < entryCount; ++i) {
+        insertTile(&cache, i, entrySize);
+    }
+
+    // Pinned entries are never pruned, even though this one is the least recently used.
+    EXPECT_TRUE(tileIsCached(&cache, 0));
+    EXPECT_FALSE(tileIsCached(&cache, 1));
+}
+
+TEST_F(Storage, CacheSizeReplaceEntry) {
+    using namespace mbgl;
+
+    const uint64_t entrySize = 10 * 1024; // 10 KB
+
+    // Entries count with their URL, which is as long for all of these tiles.
+    const uint64_t storedSize = entrySize + std::string("http://tile0").size();
+
+    SQLiteCache::Impl cache;
+    cache.setMaximumCacheSize(storedSize * 10);
+
+    std::mt19937 generator;
+    auto put = [&] (unsigned id) {
+        auto data = std::make_shared<std::string>(entrySize, 0);
+        std::generate_n(data->begin(), entrySize, std::ref(generator));
+
+        Response response;
+        response.data = data;
+        cache.put({ Resource::Kind::Tile, std::string("http://tile") + util::toString(id) }, response);
+    };
+
+    auto cached = [&] (unsigned id) {
+        bool found = false;
+        cache.get({ Resource::Kind::Tile, std::string("http://tile") + util::toString(id) },
+                  [&] (std::unique_ptr<Response> res) { found = bool(res); });
+        return found;
+    };
+
+    for (unsigned i = 0; i < 10; ++i) {
+        put(i);
+    }
+
+    // Replacing an entry takes no additional room.
+    put(9);
+
+    for (unsigned i = 0; i < 10; ++i) {
+        EXPECT_TRUE(cached(i));
+    }
+}
+
+TEST_F(Storage, CacheSizeCompressedEntries) {
+    using namespace mbgl;
+
+    const uint64_t entrySize = 10 * 1024; // 10 KB
+
+    SQLiteCache::Impl cache;
+    cache.setMaximumCacheSize(entrySize);
+
+    // Entries count with the size of their compressed data.
+    for (unsigned i = 0; i < 4; ++i) {
+        Response response;
+        response.data = std::make_shared<std::string>(entrySize, 0);
+        cache.put({ Resource::Kind::Tile, std::string("http://tile") + util::toString(i) }, response);
+    }
+
+    for (unsigned i = 0; i < 4; ++i) {
+        bool found = false;
+        cache.get({ Resource::Kind::Tile, std::string("http://tile") + util::toString(i) },
+                  [&] (std::unique_ptr<Response> res) { found = bool(res); });
+        EXPECT_TRUE(found);
+    }
+}
+
+TEST_F(Storage, CacheSizeIncrementalVacuum) {
+    using namespace mbgl;
+
+    const char* path = "test/fixtures/cache_vacuum.db";
+    try {
+        util::deleteFile(path);
+    } catch (util::IOException&) {
+    }
+
+    auto fileSize = [&] {
+        struct stat buf;
+        return stat(path, &buf) == 0 ? uint64_t(buf.st_size) : 0;
+    };
+
+    const uint64_t entrySize = 10 * 1024; // 10 KB
+
+    SQLiteCache::Impl cache(path);
+
+    std::mt19937 generator;
+    auto put = [&] (unsigned id) {
+        // Garbage doesn't compress, so every entry takes up its full size.
+        auto data = std::make_shared<std::string>(entrySize, 0);
+        std::generate_n(data->begin(), entrySize, std::ref(generator));
+
+        Response response;
+        response.data = data;
+        cache.put({ Resource::Kind::Tile, std::string("http://tile") + util::toString(id) }, response);
+    };
+
+    for (unsigned i = 0; i < 200; ++i) {
+        put(i);
+    }
+
+    const uint64_t fullSize = fileSize();
+    EXPECT_GT(fullSize, 200 * entrySize);
+
+    // Pruning returns some of the freed pages to the file system right away...
+    cache.setMaximumCacheSize(20 * entrySize);
+    const uint64_t prunedSize = fileSize();
+    EXPECT_LT(prunedSize, fullSize);
+
+    // ...and later writes continue until all of them are returned.
+    put(200);
+    EXPECT_LT(fileSize(), prunedSize);
+}
@@ -0,0 +1,195 @@
+#include "storage.hpp"
+
+#include <mbgl/storage/online_file_source.hpp>
+#include <mbgl/util/chrono.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+TEST_F(Storage, HTTPCoalescing) {
+    SCOPED_TEST(HTTPCoalescing)
+
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    OnlineFileSource fs(nullptr);
+
+    // The /cache endpoint returns a different body for every request it receives, so identical
+    // bodies mean that both requests were served by a single transfer.
+    const Resource resource { Resource::Unknown, "http://127.0.0.1:3000/cache" };
+
+    std::unique_ptr<FileRequest> req1;
+    std::unique_ptr<FileRequest> req2;
+    std::string data1;
+    std::string data2;
+
+    auto done = [&] {
+        if (!req1 && !req2) {
+            EXPECT_EQ(data1, data2);
+            loop.stop();
+            HTTPCoalescing.finish();
+        }
+    };
+
+    req1 = fs.request(resource, [&](Response res) {
+        req1.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        data1 = *res.data;
+        done();
+    });
+
+    req2 = fs.request(resource, [&](Response res) {
+        req2.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        data2 = *res.data;
+        done();
+    });
+
+    loop.run();
+}
+
+TEST_F(Storage, HTTPCoalescingCancel) {
+    SCOPED_TEST(HTTPCoalescingCancel)
+
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    OnlineFileSource fs(nullptr);
+
+    const Resource resource { Resource::Unknown, "http://127.0.0.1:3000/test" };
+
+    // Canceling one subscriber must not cancel the shared transfer for the others.
+    std::unique_ptr<FileRequest> req1 = fs.request(resource, [&](Response) {
+        ADD_FAILURE() << "Callback should not be called";
+    });
+
+    std::unique_ptr<FileRequest> req2 = fs.request(resource, [&](Response res) {
+        req2.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        EXPECT_EQ("Hello World!", *res.data);
+        loop.stop();
+        HTTPCoalescingCancel.finish();
+    });
+
+    req1.reset();
+
+    loop.run();
+}
+
+TEST_F(Storage, HTTPCoalescingLateSubscriber) {
+    SCOPED_TEST(HTTPCoalescingLateSubscriber)
+
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    OnlineFileSource fs(nullptr);
+
+    const Resource resource { Resource::Unknown, "http://127.0.0.1:3000/cache" };
+
+    std::unique_ptr<FileRequest> req1;
+    std::unique_ptr<FileRequest> req2;
+
+    // The first request stays alive, so the second request joins the existing one and gets its
+    // last response instead of triggering a new transfer.
+    req1 = fs.request(resource, [&](Response res) {
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        const std::string data = *res.data;
+
+        req2 = fs.request(resource, [&, data](Response res2) {
+            req1.reset();
+            req2.reset();
+            EXPECT_EQ(nullptr, res2.error);
+            ASSERT_TRUE(res2.data.get());
+            EXPECT_EQ(data, *res2.data);
+            loop.stop();
+            HTTPCoalescingLateSubscriber.finish();
+        });
+    });
+
+    loop.run();
+}
+
+TEST_F(Storage, HTTPCoalescingLateSubscriberRevalidates) {
+    SCOPED_TEST(HTTPCoalescingLateSubscriberRevalidates)
+
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    OnlineFileSource fs(nullptr);
+
+    // The /test endpoint doesn't send an expiration time, so nothing refreshes the first response
+    // on its own. A late subscriber gets it replayed, and is then revalidated like a fresh request.
+    const Resource resource { Resource::Unknown, "http://127.0.0.1:3000/test" };
+
+    std::unique_ptr<FileRequest> req1;
+    std::unique_ptr<FileRequest> req2;
+    int responses = 0;
+
+    req1 = fs.request(resource, [&](Response res) {
+        EXPECT_EQ(nullptr, res.error);
+        if (req2) {
+            return;
+        }
+
+        req2 = fs.request(resource, [&](Response res2) {
+            EXPECT_EQ(nullptr, res2.error);
+            ASSERT_TRUE(res2.data.get());
+            EXPECT_EQ("Hello World!", *res2.data);
+
+            if (++responses == 2) {
+                req1.reset();
+                req2.reset();
+                loop.stop();
+                HTTPCoalescingLateSubscriberRevalidates.finish();
+            }
+        });
+    });
+
+    loop.run();
+}
+
+TEST_F(Storage, HTTPCoalescingAccessToken) {
+    SCOPED_TEST(HTTPCoalescingAccessToken)
+
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    OnlineFileSource fs(nullptr);
+
+    // Requests for the same resource with different access tokens must not share a transfer.
+    const Resource resource1 { Resource::Unknown, "http://127.0.0.1:3000/cache?access_token=a" };
+    const Resource resource2 { Resource::Unknown, "http://127.0.0.1:3000/cache?access_token=b" };
+
+    std::unique_ptr<FileRequest> req1;
+    std::unique_ptr<FileRequest> req2;
+    std::string data1;
+    std::string data2;
+
+    auto done = [&] {
+        if (!req1 && !req2) {
+            EXPECT_NE(data1, data2);
+            loop.stop();
+            HTTPCoalescingAccessToken.finish();
+        }
+    };
+
+    req1 = fs.request(resource1, [&](Response res) {
+        req1.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        data1 = *res.data;
+        done();
+    });
+
+    req2 = fs.request(resource2, [&](Response res) {
+        req2.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        data2 = *res.data;
+        done();
+    });
+
+    loop.run();
+}
@@ -0,0 +1,128 @@
+#include "storage.hpp"
+
+#include <mbgl/storage/online_file_source.hpp>
+#include <mbgl/util/chrono.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <vector>
+
+TEST_F(Storage, HTTPSchedulingKindPriority) {
+    SCOPED_TEST(HTTPSchedulingKindPriority)
+
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    OnlineFileSource fs(nullptr);
+    fs.setMaximumConcurrentRequests(1);
+
+    std::vector<std::string> order;
+
+    // Occupies the only transfer slot for a while, so that the following requests get queued.
+    std::unique_ptr<FileRequest> blocker = fs.request({ Resource::Unknown, "http://127.0.0.1:3000/delayed" },
+                                                      [&](Response) {
+        blocker.reset();
+        order.push_back("delayed");
+    });
+
+    std::unique_ptr<FileRequest> tile = fs.request({ Resource::Tile, "http://127.0.0.1:3000/load/1" },
+                                                   [&](Response res) {
+        tile.reset();
+        EXPECT_EQ(nullptr, res.error);
+        order.push_back("tile");
+
+        // The style was requested last, but must have been started before the tile.
+        ASSERT_EQ(3u, order.size());
+        EXPECT_EQ("delayed", order[0]);
+        EXPECT_EQ("style", order[1]);
+        EXPECT_EQ("tile", order[2]);
+
+        loop.stop();
+        HTTPSchedulingKindPriority.finish();
+    });
+
+    std::unique_ptr<FileRequest> style = fs.request({ Resource::Style, "http://127.0.0.1:3000/load/2" },
+                                                    [&](Response res) {
+        style.reset();
+        EXPECT_EQ(nullptr, res.error);
+        order.push_back("style");
+    });
+
+    loop.run();
+}
+
+TEST_F(Storage, HTTPSchedulingReprioritize) {
+    SCOPED_TEST(HTTPSchedulingReprioritize)
+
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    OnlineFileSource fs(nullptr);
+    fs.setMaximumConcurrentRequests(1);
+
+    std::vector<std::string> order;
+
+    std::unique_ptr<FileRequest> blocker = fs.request({ Resource::Unknown, "http://127.0.0.1:3000/delayed" },
+                                                      [&](Response) {
+        blocker.reset();
+    });
+
+    std::unique_ptr<FileRequest> far = fs.request({ Resource::Tile, "http://127.0.0.1:3000/load/3" },
+                                                  [&](Response) {
+        far.reset();
+        order.push_back("far");
+
+        ASSERT_EQ(2u, order.size());
+        EXPECT_EQ("near", order[0]);
+        EXPECT_EQ("far", order[1]);
+
+        loop.stop();
+        HTTPSchedulingReprioritize.finish();
+    });
+
+    std::unique_ptr<FileRequest> near = fs.request({ Resource::Tile, "http://127.0.0.1:3000/load/4" },
+                                                   [&](Response) {
+        near.reset();
+        order.push_back("near");
+    });
+
+    // Both tiles are still waiting for a slot; the one that moved closer to the center goes first.
+    far->setPriority(2);
+    near->setPriority(1);
+
+    loop.run();
+}
+
+TEST_F(Storage, HTTPSchedulingDropQueued) {
+    SCOPED_TEST(HTTPSchedulingDropQueued)
+
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    OnlineFileSource fs(nullptr);
+    fs.setMaximumConcurrentRequests(1);
+
+    std::unique_ptr<FileRequest> blocker = fs.request({ Resource::Unknown, "http://127.0.0.1:3000/delayed" },
+                                                      [&](Response) {
+        blocker.reset();
+    });
+
+    std::unique_ptr<FileRequest> dropped = fs.request({ Resource::Tile, "http://127.0.0.1:3000/load/5" },
+                                                      [&](Response) {
+        ADD_FAILURE() << "Callback should not be called";
+    });
+
+    std::unique_ptr<FileRequest> kept = fs.request({ Resource::Tile, "http://127.0.0.1:3000/load/6" },
+                                                   [&](Response res) {
+        kept.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        EXPECT_EQ("Request 6", *res.data);
+        loop.stop();
+        HTTPSchedulingDropQueued.finish();
+    });
+
+    // Dropping a queued request frees its place in the queue without starting a transfer.
+    dropped.reset();
+
+    loop.run();
+}
@@ -0,0 +1,110 @@
+#include "storage.hpp"
+
+#include <mbgl/storage/mbtiles_file_source.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <sqlite3.h>
+
+namespace {
+
+const char* const mbtilesPath = "test/fixtures/storage/mbtiles_file_source.mbtiles";
+
+void createMBTiles() {
+    try {
+        mbgl::util::deleteFile(mbtilesPath);
+    } catch (mbgl::util::IOException&) {
+    }
+
+    sqlite3* db;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(mbtilesPath, &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db,
+        "CREATE TABLE metadata (name TEXT, value TEXT);"
+        "CREATE TABLE tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB);"
+        "INSERT INTO metadata VALUES ('minzoom', '0'), ('maxzoom', '2'), ('format', 'pbf'),"
+        "    ('bounds', '-180,-85,180,85'), ('attribution', 'Attribution \"quoted\"');"
+        // Tile 1/0/0 is stored in row 1, since MBTiles counts rows from the bottom.
+        "INSERT INTO tiles VALUES (1, 0, 1, 'tile 1/0/0');",
+        nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+}
+
+} // namespace
+
+TEST_F(Storage, MBTilesTileJSON) {
+    SCOPED_TEST(MBTilesTileJSON)
+
+    using namespace mbgl;
+
+    createMBTiles();
+
+    util::RunLoop loop;
+    MBTilesFileSource fs;
+
+    const std::string url = std::string("mbtiles://") + mbtilesPath;
+    std::unique_ptr<FileRequest> req = fs.request(Resource::source(url), [&](Response res) {
+        req.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        EXPECT_EQ("{\"tilejson\":\"2.0.0\",\"tiles\":[\"" + url + "/{z}/{x}/{y}\"],"
+                  "\"minzoom\":0,\"maxzoom\":2,\"bounds\":[-180,-85,180,85],"
+                  "\"attribution\":\"Attribution \\\"quoted\\\"\",\"format\":\"pbf\"}", *res.data);
+        loop.stop();
+        MBTilesTileJSON.finish();
+    });
+
+    loop.run();
+}
+
+TEST_F(Storage, MBTilesTile) {
+    SCOPED_TEST(MBTilesTile)
+
+    using namespace mbgl;
+
+    createMBTiles();
+
+    util::RunLoop loop;
+    MBTilesFileSource fs;
+
+    const std::string urlTemplate = std::string("mbtiles://") + mbtilesPath + "/{z}/{x}/{y}";
+    std::unique_ptr<FileRequest> req1;
+    std::unique_ptr<FileRequest> req2;
+
+    req1 = fs.request(Resource::tile(urlTemplate, 1, 0, 0, 1), [&](Response res) {
+        req1.reset();
+        EXPECT_EQ(nullptr, res.error);
+        ASSERT_TRUE(res.data.get());
+        EXPECT_EQ("tile 1/0/0", *res.data);
+
+        // Missing tiles are reported as not found, just like a 404 from a server.
+        req2 = fs.request(Resource::tile(urlTemplate, 1, 1, 1, 1), [&](Response res2) {
+            req2.reset();
+            ASSERT_NE(nullptr, res2.error);
+            EXPECT_EQ(Response::Error::Reason::NotFound, res2.error->reason);
+            EXPECT_FALSE(res2.data.get());
+            loop.stop();
+            MBTilesTile.finish();
+        });
+    });
+
+    loop.run();
+}
+
+TEST_F(Storage, MBTilesNotFound) {
+    SCOPED_TEST(MBTilesNotFound)
+
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    MBTilesFileSource fs;
+
+    std::unique_ptr<FileRequest> req = fs.request(Resource::source("mbtiles://test/fixtures/storage/nonexistent.mbtiles"), [&](Response res) {
+        req.reset();
+        ASSERT_NE(nullptr, res.error);
+        EXPECT_EQ(Response::Error::Reason::NotFound, res.error->reason);
+        loop.stop();
+        MBTilesNotFound.finish();
+    });
+
+    loop.run();
+}
@@ -0,0 +1,227 @@
+#include "storage.hpp"
+#include "../fixtures/stub_file_source.hpp"
+
+#include <mbgl/storage/offline.hpp>
+#include <mbgl/storage/sqlite_cache.hpp>
+#include <mbgl/util/mapbox.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <map>
+
+using namespace mbgl;
+
+namespace {
+
+Response responseWithData(const std::string& data) {
+    Response response;
+    response.data = std::make_shared<std::string>(data);
+    return response;
+}
+
+class TestObserver : public OfflineRegionObserver {
+public:
+    std::function<void (OfflineRegionStatus)> statusChangedFn;
+
+    void statusChanged(OfflineRegionStatus status) override {
+        if (statusChangedFn) {
+            statusChangedFn(status);
+        }
+    }
+};
+
+bool isCached(SQLiteCache& cache, const Resource& resource) {
+    bool replied = false;
+    bool cached = false;
+    auto req = cache.get(resource, [&] (std::unique_ptr<Response> res) {
+        replied = true;
+        cached = bool(res);
+    });
+
+    while (!replied) {
+        util::RunLoop::Get()->runOnce();
+    }
+    return cached;
+}
+
+} // namespace
+
+TEST_F(Storage, OfflineRegionDownload) {
+    SCOPED_TEST(OfflineRegionDownload)
+
+    util::RunLoop loop;
+    StubFileSource fileSource;
+
+    std::map<Resource::Kind, unsigned> requested;
+    fileSource.response = [&] (const Resource& resource) {
+        requested[resource.kind]++;
+
+        switch (resource.kind) {
+        case Resource::Kind::Style:
+            return responseWithData(R"JSON({
+                "version": 8,
+                "sources": { "vector": { "type": "vector", "url": "http://127.0.0.1:3000/vector.json" } },
+                "sprite": "http://127.0.0.1:3000/sprite",
+                "glyphs": "http://127.0.0.1:3000/{fontstack}/{range}.pbf",
+                "layers": [{
+                    "id": "labels",
+                    "type": "symbol",
+                    "source": "vector",
+                    "source-layer": "labels",
+                    "layout": { "text-field": "{name}" }
+                }]
+            })JSON");
+        case Resource::Kind::Source:
+            EXPECT_EQ("http://127.0.0.1:3000/vector.json", resource.url);
+            return responseWithData(R"JSON({
+                "tiles": [ "http://127.0.0.1:3000/{z}-{x}-{y}.vector.pbf" ],
+                "minzoom": 0,
+                "maxzoom": 1
+            })JSON");
+        case Resource::Kind::Tile:
+            return responseWithData("tile");
+        default:
+            return responseWithData("data");
+        }
+    };
+
+    auto observer = std::make_unique<TestObserver>();
+    observer->statusChangedFn = [&] (OfflineRegionStatus status) {
+        if (!status.complete()) {
+            return;
+        }
+
+        // The style, the TileJSON, the tiles 0/0/0 and 1/1/0 that cover the region, the sprite
+        // image and JSON, and all glyph ranges of the default font.
+        EXPECT_EQ(1u, requested[Resource::Kind::Style]);
+        EXPECT_EQ(1u, requested[Resource::Kind::Source]);
+        EXPECT_EQ(2u, requested[Resource::Kind::Tile]);
+        EXPECT_EQ(1u, requested[Resource::Kind::SpriteImage]);
+        EXPECT_EQ(1u, requested[Resource::Kind::SpriteJSON]);
+        EXPECT_EQ(256u, requested[Resource::Kind::Glyphs]);
+        EXPECT_EQ(262u, status.completedResourceCount);
+        EXPECT_EQ(262u, status.requiredResourceCount);
+
+        loop.stop();
+        OfflineRegionDownload.finish();
+    };
+
+    OfflineDownload download(
+        OfflineRegionDefinition("http://127.0.0.1:3000/style.json",
+                                LatLngBounds::hull({ 0, 0 }, { 1, 1 }), 0, 1, 1.0),
+        fileSource, nullptr, "", std::move(observer));
+
+    loop.run();
+}
+
+TEST_F(Storage, OfflineRegionDownloadPermanentError) {
+    SCOPED_TEST(OfflineRegionDownloadPermanentError)
+
+    util::RunLoop loop;
+    StubFileSource fileSource;
+
+    // Errors like a 403 are not retried by the file source, so they must not hold up the download.
+    fileSource.response = [&] (const Resource& resource) {
+        if (resource.kind != Resource::Kind::Style) {
+            ADD_FAILURE() << "unexpected request";
+        }
+        Response response;
+        response.error = std::make_unique<Response::Error>(Response::Error::Reason::Other, "Forbidden");
+        return response;
+    };
+
+    auto observer = std::make_unique<TestObserver>();
+    observer->statusChangedFn = [&] (OfflineRegionStatus status) {
+        EXPECT_TRUE(status.complete());
+        EXPECT_EQ(0u, status.completedResourceCount);
+        EXPECT_EQ(1u, status.failedResourceCount);
+        EXPECT_EQ(1u, status.requiredResourceCount);
+
+        loop.stop();
+        OfflineRegionDownloadPermanentError.finish();
+    };
+
+    OfflineDownload download(
+        OfflineRegionDefinition("http://127.0.0.1:3000/style.json",
+                                LatLngBounds::hull({ 0, 0 }, { 1, 1 }), 0, 1, 1.0),
+        fileSource, nullptr, "", std::move(observer));
+
+    loop.run();
+}
+
+TEST_F(Storage, OfflineRegionDownloadPinsResources) {
+    SCOPED_TEST(OfflineRegionDownloadPinsResources)
+
+    util::RunLoop loop;
+    StubFileSource fileSource;
+    SQLiteCache cache(":memory:");
+
+    // Like the online file source, store responses under the URL that would have been requested.
+    auto requested = [] (const Resource& resource) {
+        return Resource { resource.kind, util::mapbox::normalizeURL(resource.kind, resource.url, "token") };
+    };
+
+    fileSource.response = [&] (const Resource& resource) {
+        Response response;
+        switch (resource.kind) {
+        case Resource::Kind::Style:
+            response = responseWithData(R"JSON({
+                "version": 8,
+                "sources": { "vector": { "type": "vector", "url": "mapbox://user.vector" } },
+                "sprite": "mapbox://sprites/user/style",
+                "glyphs": "mapbox://fonts/user/{fontstack}/{range}.pbf",
+                "layers": [{
+                    "id": "labels",
+                    "type": "symbol",
+                    "source": "vector",
+                    "source-layer": "labels",
+                    "layout": { "text-field": "{name}" }
+                }]
+            })JSON");
+            break;
+        case Resource::Kind::Source:
+            response = responseWithData(R"JSON({
+                "tiles": [ "http://127.0.0.1:3000/{z}-{x}-{y}.vector.pbf" ],
+                "minzoom": 0,
+                "maxzoom": 0
+            })JSON");
+            break;
+        default:
+            response = responseWithData("data");
+            break;
+        }
+        cache.put(requested(resource), response);
+        return response;
+    };
+
+    auto observer = std::make_unique<TestObserver>();
+    observer->statusChangedFn = [&] (OfflineRegionStatus status) {
+        if (status.complete()) {
+            loop.stop();
+        }
+    };
+
+    OfflineDownload download(
+        OfflineRegionDefinition("mapbox://styles/user/style",
+                                LatLngBounds::hull({ 0, 0 }, { 1, 1 }), 0, 0, 1.0),
+        fileSource, &cache, "token", std::move(observer));
+
+    loop.run();
+
+    const Resource unpinned { Resource::Kind::Unknown, "http://127.0.0.1:3000/unpinned" };
+    cache.put(unpinned, responseWithData("data"));
+
+    // Only the resources of the region survive pruning.
+    cache.setMaximumCacheSize(1);
+    EXPECT_FALSE(isCached(cache, unpinned));
+
+    EXPECT_TRUE(isCached(cache, requested(Resource::style("mapbox://styles/user/style"))));
+    EXPECT_TRUE(isCached(cache, requested(Resource::source("mapbox://user.vector"))));
+    EXPECT_TRUE(isCached(cache, requested(Resource::spriteImage("mapbox://sprites/user/style", 1.0))));
+    EXPECT_TRUE(isCached(cache, requested(Resource::spriteJSON("mapbox://sprites/user/style", 1.0))));
+    EXPECT_TRUE(isCached(cache, requested(Resource::glyphs("mapbox://fonts/user/{fontstack}/{range}.pbf",
+                                                           "Open Sans Regular, Arial Unicode MS Regular",
+                                                           { 0, 255 }))));
+    EXPECT_TRUE(isCached(cache, Resource::tile("http://127.0.0.1:3000/{z}-{x}-{y}.vector.pbf", 1.0, 0, 0, 0)));
+
+    OfflineRegionDownloadPinsResources.finish();
+}
@@ -0,0 +1,240 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/text/collision_tile.hpp>
+#include <mbgl/util/constants.hpp>
+#include <mbgl/util/get_geometries.hpp>
+#include <mbgl/util/io.hpp>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#pragma GCC diagnostic ignored "-Wshadow"
+#ifdef __clang__
+#pragma GCC diagnostic ignored "-Wunknown-pragmas"
+#endif
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wdeprecated-register"
+#pragma GCC diagnostic ignored "-Wshorten-64-to-32"
+#pragma GCC diagnostic ignored "-Wunused-local-typedefs"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <boost/geometry.hpp>
+#include <boost/geometry/geometries/point.hpp>
+#include <boost/geometry/geometries/box.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#pragma GCC diagnostic pop
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+using namespace mbgl;
+
+namespace {
+
+namespace bg = boost::geometry;
+namespace bgi = bg::index;
+using CollisionPoint = bg::model::point<float, 2, bg::cs::cartesian>;
+using Box = bg::model::box<CollisionPoint>;
+using CollisionTreeBox = std::pair<Box, CollisionBox>;
+
+// Places features with an R-tree, as CollisionTile did before it used a grid. Only handles
+// features that may not overlap and ignore the tile edges.
+class RTreeCollisionTile {
+public:
+    explicit RTreeCollisionTile(PlacementConfig config)
+        : tile(config) {
+        const float angle_sin = std::sin(config.angle);
+        const float angle_cos = std::cos(config.angle);
+        rotationMatrix = { { angle_cos, -angle_sin, angle_sin, angle_cos } };
+    }
+
+    float placeFeature(const CollisionFeature& feature) {
+        float minPlacementScale = tile.minScale;
+        for (auto& box : feature.boxes) {
+            const auto anchor = box.anchor.matMul(rotationMatrix);
+            std::vector<CollisionTreeBox> blockingBoxes;
+            tree.query(bgi::intersects(getTreeBox(anchor, box)), std::back_inserter(blockingBoxes));
+
+            for (auto& blockingTreeBox : blockingBoxes) {
+                const auto& blocking = std::get<1>(blockingTreeBox);
+                const auto blockingAnchor = blocking.anchor.matMul(rotationMatrix);
+                minPlacementScale = findPlacementScale(minPlacementScale, anchor, box, blockingAnchor, blocking);
+                if (minPlacementScale >= tile.maxScale) return minPlacementScale;
+            }
+        }
+        return minPlacementScale;
+    }
+
+    void insertFeature(CollisionFeature& feature, const float minPlacementScale) {
+        for (auto& box : feature.boxes) {
+            box.placementScale = minPlacementScale;
+        }
+        if (minPlacementScale < tile.maxScale) {
+            std::vector<CollisionTreeBox> treeBoxes;
+            for (auto& box : feature.boxes) {
+                treeBoxes.emplace_back(getTreeBox(box.anchor.matMul(rotationMatrix), box), box);
+            }
+            tree.insert(treeBoxes.begin(), treeBoxes.end());
+        }
+    }
+
+private:
+    float findPlacementScale(float minPlacementScale, const vec2<float>& anchor, const CollisionBox& box,
+                             const vec2<float>& blockingAnchor, const CollisionBox& blocking) {
+        float s1 = (blocking.x1 - box.x2) / (anchor.x - blockingAnchor.x);
+        float s2 = (blocking.x2 - box.x1) / (anchor.x - blockingAnchor.x);
+        float s3 = (blocking.y1 - box.y2) * tile.yStretch / (anchor.y - blockingAnchor.y);
+        float s4 = (blocking.y2 - box.y1) * tile.yStretch / (anchor.y - blockingAnchor.y);
+
+        if (std::isnan(s1) || std::isnan(s2)) s1 = s2 = 1;
+        if (std::isnan(s3) || std::isnan(s4)) s3 = s4 = 1;
+
+        float collisionFreeScale = ::fmin(::fmax(s1, s2), ::fmax(s3, s4));
+        if (collisionFreeScale > blocking.maxScale) collisionFreeScale = blocking.maxScale;
+        if (collisionFreeScale > box.maxScale) collisionFreeScale = box.maxScale;
+        if (collisionFreeScale > minPlacementScale && collisionFreeScale >= blocking.placementScale) {
+            minPlacementScale = collisionFreeScale;
+        }
+        return minPlacementScale;
+    }
+
+    Box getTreeBox(const vec2<float>& anchor, const CollisionBox& box) {
+        return Box{ CollisionPoint{ anchor.x + box.x1, anchor.y + box.y1 * tile.yStretch },
+                    CollisionPoint{ anchor.x + box.x2, anchor.y + box.y2 * tile.yStretch } };
+    }
+
+    // Only for its scales and stretch.
+    CollisionTile tile;
+    std::array<float, 4> rotationMatrix;
+    bgi::rtree<CollisionTreeBox, bgi::linear<16, 4>> tree;
+};
+
+// Collision features for the labels of the fixture tile: points get boxes around them, and
+// roads get boxes along them. The sizes of the boxes follow the lengths of the names.
+std::vector<CollisionFeature> labels() {
+    VectorTile tile(std::make_shared<std::string>(util::read_file("test/fixtures/resources/vector.pbf")));
+    const float boxScale = float(util::EXTENT) / util::tileSize;
+
+    std::vector<CollisionFeature> features;
+    for (const auto name : { "poi_label", "place_label", "road_label", "housenum_label", "water_label" }) {
+        auto layer = tile.getLayer(name);
+        if (!layer) {
+            continue;
+        }
+        layer->eachFeature([&](const GeometryTileFeature& feature) {
+            auto text = feature.getValue("name");
+            if (!text) {
+                text = feature.getValue("house_num");
+            }
+            const float width = 6.0f * (text && text->is<std::string>() ? text->get<std::string>().size() : 4);
+
+            for (const auto& line : getGeometries(feature)) {
+                if (line.empty()) {
+                    continue;
+                }
+                if (feature.getType() == FeatureType::LineString && line.size() > 1) {
+                    const std::size_t segment = (line.size() - 1) / 2;
+                    const Anchor anchor(line[segment].x, line[segment].y, 0, 0.5, segment);
+                    features.emplace_back(line, anchor, -8, 8, -width, width, boxScale, 0, true, false);
+                } else {
+                    const Anchor anchor(line[0].x, line[0].y, 0, 0.5);
+                    features.emplace_back(line, anchor, -8, 8, -width, width, boxScale, 0, false, false);
+                }
+            }
+            return true;
+        });
+    }
+    return features;
+}
+
+const PlacementConfig configs[] = {
+    PlacementConfig(0, 0),
+    PlacementConfig(M_PI / 6, 0),
+    PlacementConfig(-M_PI * 3 / 4, M_PI / 4),
+    PlacementConfig(M_PI, M_PI / 3),
+};
+
+} // namespace
+
+TEST(CollisionTile, MatchesRTree) {
+    auto features = labels();
+    ASSERT_GT(features.size(), 50u);
+
+    CollisionTile tile(configs[0]);
+    for (const auto& config : configs) {
+        tile.reset(config);
+        RTreeCollisionTile reference(config);
+
+        std::size_t placed = 0;
+        for (auto& feature : features) {
+            // Past the maximum scale, the result depends on the order in which collisions are found.
+            const float expected = std::min(reference.placeFeature(feature), tile.maxScale);
+            const float actual = tile.placeFeature(feature, false, false);
+            EXPECT_EQ(expected, std::min(actual, tile.maxScale));
+
+            reference.insertFeature(feature, expected);
+            tile.insertFeature(feature, expected);
+            placed += expected < tile.maxScale;
+        }
+
+        // Some labels collide and some don't.
+        EXPECT_GT(placed, 0u);
+        EXPECT_LT(placed, features.size());
+    }
+}
+
+// Compares placing the labels of a tile with the grid and with an R-tree, like redoPlacement does
+// when the map rotates. Run with --gtest_also_run_disabled_tests.
+TEST(CollisionTile, DISABLED_Benchmark) {
+    auto features = labels();
+    const std::size_t iterations = 200;
+    using Clock = std::chrono::steady_clock;
+
+    auto start = Clock::now();
+    for (std::size_t n = 0; n < iterations; n++) {
+        RTreeCollisionTile reference(PlacementConfig(n * 0.01f, 0));
+        for (auto& feature : features) {
+            reference.insertFeature(feature, reference.placeFeature(feature));
+        }
+    }
+    const auto rtreeTime = Clock::now() - start;
+
+    CollisionTile tile { PlacementConfig() };
+    start = Clock::now();
+    for (std::size_t n = 0; n < iterations; n++) {
+        tile.reset(PlacementConfig(n * 0.01f, 0));
+        for (auto& feature : features) {
+            tile.insertFeature(feature, tile.placeFeature(feature, false, false));
+        }
+    }
+    const auto gridTime = Clock::now() - start;
+
+    std::size_t boxes = 0;
+    for (const auto& feature : features) {
+        boxes += feature.boxes.size();
+    }
+
+    using std::chrono::microseconds;
+    std::cout << features.size() << " labels with " << boxes << " boxes" << std::endl
+              << "rtree: " << std::chrono::duration_cast<microseconds>(rtreeTime).count() / iterations
+              << "us per placement" << std::endl
+              << "grid: " << std::chrono::duration_cast<microseconds>(gridTime).count() / iterations
+              << "us per placement" << std::endl;
+}
+
+TEST(PlacementConfig, Quantized) {
+    const float step = M_PI / 90;
+    const float angle = 10.1f * step;
+    const float pitch = 5 * step;
+
+    // Configurations within half a step of each other share a placement.
+    const PlacementConfig config = PlacementConfig(angle, pitch, true).quantized(step);
+    EXPECT_EQ(config, PlacementConfig(angle + step * 0.3f, pitch - step * 0.4f, true).quantized(step));
+    EXPECT_NE(config, PlacementConfig(angle + step, pitch, true).quantized(step));
+    EXPECT_NE(config, PlacementConfig(angle, pitch, false).quantized(step));
+
+    EXPECT_NEAR(angle, config.angle, step / 2);
+    EXPECT_NEAR(pitch, config.pitch, step / 2);
+    EXPECT_EQ(config, config.quantized(step));
+}
@@ -0,0 +1,55 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/text/font_stack.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+SDFGlyph glyph(uint32_t id) {
+    SDFGlyph result;
+    result.id = id;
+    result.metrics.width = 8;
+    result.metrics.height = 12;
+    result.metrics.advance = 10;
+    return result;
+}
+
+std::vector<float> positions(const Shaping& shaping) {
+    std::vector<float> result;
+    for (const auto& positioned : shaping.positionedGlyphs) {
+        result.push_back(positioned.x);
+    }
+    return result;
+}
+
+Shaping shape(const FontStack& stack, const std::u32string& text, float spacing = 0) {
+    return stack.getShaping(text, 0, 24, 0.5, 0.5, 0.5, spacing, vec2<float>(0, 0));
+}
+
+} // namespace
+
+TEST(FontStack, Shaping) {
+    FontStack stack;
+    stack.insert('a', glyph('a'));
+    stack.insert('b', glyph('b'));
+
+    const Shaping first = shape(stack, U"abba");
+    EXPECT_EQ((std::vector<float> { -20, -10, 0, 10 }), positions(first));
+    EXPECT_EQ(-20, first.left);
+    EXPECT_EQ(20, first.right);
+
+    // Repeated labels get the same shaping, unless the layout differs.
+    EXPECT_EQ(positions(first), positions(shape(stack, U"abba")));
+    EXPECT_EQ((std::vector<float> { -23, -11, 1, 13 }), positions(shape(stack, U"abba", 2)));
+}
+
+TEST(FontStack, ShapingWithNewGlyphs) {
+    FontStack stack;
+    stack.insert('a', glyph('a'));
+
+    // Missing glyphs are left out until they arrive.
+    EXPECT_EQ(1u, shape(stack, U"ab").positionedGlyphs.size());
+    stack.insert('b', glyph('b'));
+    EXPECT_EQ(2u, shape(stack, U"ab").positionedGlyphs.size());
+}
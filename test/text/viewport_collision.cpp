@@ -0,0 +1,112 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/text/viewport_collision.hpp>
+#include <mbgl/util/constants.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+// A symbol at (x, y) pixels within its tile, at the zoom level of the tile.
+struct Symbol {
+    float x;
+    float y;
+    float placementScale = 1;
+    bool allowOverlap = false;
+    bool ignorePlacement = false;
+};
+
+// Symbols with a single box that is 20 by 10 pixels. Overscaled tiles are that much larger in
+// pixels at their zoom level.
+PlacedSymbols placed(std::initializer_list<Symbol> symbols, float overscaling) {
+    const float unit = util::EXTENT / (util::tileSize * overscaling);
+    PlacedSymbols result;
+    for (const auto& symbol : symbols) {
+        CollisionBox box({ symbol.x * unit, symbol.y * unit }, -10 * unit, -5 * unit, 10 * unit, 5 * unit, 16);
+        box.placementScale = symbol.placementScale;
+        result.boxes.push_back({ box, symbol.allowOverlap, symbol.ignorePlacement });
+        result.ends.push_back(result.boxes.size());
+    }
+    return result;
+}
+
+std::vector<bool> place(ViewportCollision& collision, const TileID& id, std::initializer_list<Symbol> symbols) {
+    std::vector<bool> hidden;
+    collision.place(id, placed(symbols, id.overscaling), hidden);
+    return hidden;
+}
+
+const TileID left { 1, 0, 0, 1 };
+const TileID right { 1, 1, 0, 1 };
+
+} // namespace
+
+TEST(ViewportCollision, TileBorders) {
+    ViewportCollision collision;
+    collision.reset(PlacementConfig(), 1, 512, 256, 600);
+
+    // Symbols of the same tile were placed against each other already.
+    EXPECT_EQ((std::vector<bool> { false, false }), place(collision, left, { { 511, 256 }, { 511, 258 } }));
+
+    // Symbols across the border collide; the symbols that were placed first stay.
+    EXPECT_EQ((std::vector<bool> { true, false }), place(collision, right, { { 1, 256 }, { 1, 375 } }));
+}
+
+TEST(ViewportCollision, Flags) {
+    ViewportCollision collision;
+    collision.reset(PlacementConfig(), 1, 512, 256, 600);
+
+    Symbol ignored { 511, 256 };
+    ignored.ignorePlacement = true;
+    Symbol hiddenAtThisZoom { 511, 125 };
+    hiddenAtThisZoom.placementScale = 2;
+    EXPECT_EQ((std::vector<bool> { false, false }), place(collision, left, { ignored, hiddenAtThisZoom }));
+
+    Symbol overlapping { 1, 125 };
+    overlapping.allowOverlap = true;
+    EXPECT_EQ((std::vector<bool> { false, false }), place(collision, right, { { 1, 256 }, overlapping }));
+
+    // Symbols that allow overlap still block others, unless they ignore placement.
+    EXPECT_EQ((std::vector<bool> { true }), place(collision, left, { { 511, 125 } }));
+}
+
+TEST(ViewportCollision, Zoom) {
+    // At twice the scale, the symbols are twice as far apart in pixels but just as large.
+    ViewportCollision collision;
+    collision.reset(PlacementConfig(), 2, 1024, 512, 600);
+    EXPECT_EQ((std::vector<bool> { false }), place(collision, left, { { 500, 256 } }));
+    EXPECT_EQ((std::vector<bool> { false }), place(collision, right, { { 7.5f, 256 } }));
+
+    collision.reset(PlacementConfig(), 1, 512, 256, 600);
+    EXPECT_EQ((std::vector<bool> { false }), place(collision, left, { { 500, 256 } }));
+    EXPECT_EQ((std::vector<bool> { true }), place(collision, right, { { 7.5f, 256 } }));
+}
+
+TEST(ViewportCollision, Rotation) {
+    // Rotated by a quarter turn, symbols next to each other are above each other, where their
+    // boxes are only half as large.
+    ViewportCollision collision;
+    collision.reset(PlacementConfig(M_PI / 2), 1, 512, 256, 600);
+    EXPECT_EQ((std::vector<bool> { false }), place(collision, left, { { 500, 256 } }));
+    EXPECT_EQ((std::vector<bool> { false }), place(collision, right, { { 7.5f, 256 } }));
+
+    collision.reset(PlacementConfig(), 1, 512, 256, 600);
+    EXPECT_EQ((std::vector<bool> { false }), place(collision, left, { { 500, 256 } }));
+    EXPECT_EQ((std::vector<bool> { true }), place(collision, right, { { 7.5f, 256 } }));
+}
+
+TEST(ViewportCollision, Overscaled) {
+    // Tiles at zoom level 2 that show the data of a zoom level 1 tile cover twice the area.
+    const TileID overscaled { 2, 0, 0, 1 };
+    const TileID bottomRight { 2, 1, 1, 2 };
+
+    ViewportCollision collision;
+    collision.reset(PlacementConfig(), 2, 1024, 512, 600);
+    EXPECT_EQ((std::vector<bool> { false, false }), place(collision, overscaled, { { 1015, 512 }, { 1015, 700 } }));
+
+    // 3 pixels apart on the map, while their boxes are 20 pixels wide.
+    EXPECT_EQ((std::vector<bool> { true }), place(collision, bottomRight, { { 500, 0 } }));
+
+    // 25 pixels apart.
+    EXPECT_EQ((std::vector<bool> { false }), place(collision, bottomRight, { { 478, 188 } }));
+}
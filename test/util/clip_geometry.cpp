@@ -0,0 +1,63 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/util/clip_geometry.hpp>
+
+using namespace mbgl;
+
+TEST(ClipGeometry, ExceedsBox) {
+    EXPECT_FALSE(util::exceedsBox({ { { 0, 0 }, { 10, 10 } } }, 0, 0, 10, 10));
+    EXPECT_TRUE(util::exceedsBox({ { { 0, 0 } }, { { 11, 5 } } }, 0, 0, 10, 10));
+    EXPECT_TRUE(util::exceedsBox({ { { -1, 5 } } }, 0, 0, 10, 10));
+}
+
+TEST(ClipGeometry, Polygons) {
+    // Inside of the box, and on its edges.
+    const GeometryCollection inside = { { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 }, { 0, 0 } } };
+    EXPECT_EQ(inside, util::clipPolygons(inside, 0, 0, 10, 10));
+
+    // Crossing the right edge; the ring stays closed.
+    EXPECT_EQ((GeometryCollection { { { 5, 0 }, { 10, 0 }, { 10, 10 }, { 5, 10 }, { 5, 0 } } }),
+              util::clipPolygons({ { { 5, 0 }, { 20, 0 }, { 20, 10 }, { 5, 10 }, { 5, 0 } } }, 0, 0, 10, 10));
+
+    // Covering the whole box.
+    EXPECT_EQ((GeometryCollection { { { 0, 10 }, { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } } }),
+              util::clipPolygons({ { { -5, -5 }, { 15, -5 }, { 15, 15 }, { -5, 15 }, { -5, -5 } } }, 0, 0, 10, 10));
+
+    // Rings outside of the box are dropped.
+    EXPECT_EQ((GeometryCollection { { { 2, 2 }, { 4, 2 }, { 4, 4 }, { 2, 2 } } }),
+              util::clipPolygons({ { { 20, 20 }, { 30, 20 }, { 30, 30 }, { 20, 20 } },
+                                   { { 2, 2 }, { 4, 2 }, { 4, 4 }, { 2, 2 } } }, 0, 0, 10, 10));
+}
+
+TEST(ClipGeometry, LineStrings) {
+    const GeometryCollection inside = { { { 0, 0 }, { 10, 10 } }, { { 5, 5 }, { 6, 6 } } };
+    EXPECT_EQ(inside, util::clipLineStrings(inside, 0, 0, 10, 10));
+
+    // Leaving and reentering the box splits the line.
+    EXPECT_EQ((GeometryCollection { { { 0, 5 }, { 10, 5 } }, { { 10, 8 }, { 5, 8 } } }),
+              util::clipLineStrings({ { { 0, 5 }, { 20, 5 }, { 20, 8 }, { 5, 8 } } }, 0, 0, 10, 10));
+
+    // Segments that only cross the box.
+    EXPECT_EQ((GeometryCollection { { { 0, 5 }, { 10, 5 } } }),
+              util::clipLineStrings({ { { -10, 5 }, { 20, 5 } } }, 0, 0, 10, 10));
+
+    // Lines outside of the box are dropped.
+    EXPECT_EQ(GeometryCollection(), util::clipLineStrings({ { { 20, 0 }, { 20, 20 } } }, 0, 0, 10, 10));
+
+    // A closed ring that is cut open at its first point continues across it.
+    EXPECT_EQ((GeometryCollection { { { 10, 10 }, { 0, 10 }, { 0, 0 }, { 10, 0 } } }),
+              util::clipLineStrings({ { { 0, 0 }, { 20, 0 }, { 20, 10 }, { 0, 10 }, { 0, 0 } } }, 0, 0, 10, 10));
+}
+
+TEST(ClipGeometry, ReusesResult) {
+    // Rings from an earlier result are overwritten or dropped.
+    GeometryCollection result = { { { 1, 1 } }, { { 2, 2 } }, { { 3, 3 } } };
+    util::clipPolygons({ { { 5, 0 }, { 20, 0 }, { 20, 10 }, { 5, 10 }, { 5, 0 } } }, result, 0, 0, 10, 10);
+    EXPECT_EQ((GeometryCollection { { { 5, 0 }, { 10, 0 }, { 10, 10 }, { 5, 10 }, { 5, 0 } } }), result);
+
+    util::clipLineStrings({ { { 0, 0 }, { 20, 0 }, { 20, 10 }, { 0, 10 }, { 0, 0 } } }, result, 0, 0, 10, 10);
+    EXPECT_EQ((GeometryCollection { { { 10, 10 }, { 0, 10 }, { 0, 0 }, { 10, 0 } } }), result);
+
+    util::clipLineStrings({ { { 20, 0 }, { 20, 20 } } }, result, 0, 0, 10, 10);
+    EXPECT_EQ(GeometryCollection(), result);
+}
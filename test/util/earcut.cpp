@@ -0,0 +1,241 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/util/earcut.hpp>
+#include <mbgl/util/get_geometries.hpp>
+#include <mbgl/util/io.hpp>
+
+#include <clipper/clipper.hpp>
+#include <libtess2/tesselator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+using namespace mbgl;
+
+namespace {
+
+std::vector<uint32_t> triangulate(const GeometryCollection& rings) {
+    std::vector<uint32_t> indices;
+    util::earcut(rings, indices);
+    return indices;
+}
+
+std::vector<GeometryCollection> classifyRings(const GeometryCollection& rings) {
+    std::vector<GeometryCollection> polygons;
+    EXPECT_TRUE(util::classifyRings(rings, polygons));
+    return polygons;
+}
+
+} // namespace
+
+TEST(Earcut, Square) {
+    const GeometryCollection square = { { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } } };
+    const auto indices = triangulate(square);
+    EXPECT_EQ(6u, indices.size());
+    EXPECT_EQ(0, util::earcutDeviation(square, indices));
+}
+
+TEST(Earcut, Hole) {
+    const GeometryCollection polygon = {
+        { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } },
+        { { 3, 3 }, { 3, 7 }, { 7, 7 }, { 7, 3 } }
+    };
+    const auto indices = triangulate(polygon);
+    EXPECT_EQ(8u * 3, indices.size());
+    EXPECT_EQ(0, util::earcutDeviation(polygon, indices));
+
+    // Indices count the points of the holes after the outer ring.
+    for (const auto index : indices) {
+        EXPECT_LT(index, 8u);
+    }
+}
+
+TEST(Earcut, Concave) {
+    // Both winding orders.
+    GeometryCollection polygon = { { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 5, 2 }, { 0, 10 } } };
+    EXPECT_EQ(0, util::earcutDeviation(polygon, triangulate(polygon)));
+
+    std::reverse(polygon[0].begin(), polygon[0].end());
+    EXPECT_EQ(3u * 3, triangulate(polygon).size());
+    EXPECT_EQ(0, util::earcutDeviation(polygon, triangulate(polygon)));
+}
+
+TEST(Earcut, Hashed) {
+    // Enough points to index them along a z-order curve.
+    GeometryCollection circle(1);
+    for (int i = 0; i < 200; i++) {
+        const double angle = i * M_PI / 100;
+        const double radius = i % 2 ? 1000 : 800;
+        circle[0].emplace_back(std::round(std::cos(angle) * radius), std::round(std::sin(angle) * radius));
+    }
+
+    const auto indices = triangulate(circle);
+    EXPECT_EQ(198u * 3, indices.size());
+    EXPECT_EQ(0, util::earcutDeviation(circle, indices));
+}
+
+TEST(Earcut, SelfIntersecting) {
+    const GeometryCollection bowtie = { { { 0, 0 }, { 10, 10 }, { 10, 0 }, { 0, 10 } } };
+    EXPECT_GT(util::earcutDeviation(bowtie, triangulate(bowtie)), 0);
+}
+
+TEST(Earcut, ClassifyRings) {
+    const std::vector<Coordinate> outer = { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 }, { 0, 0 } };
+    const std::vector<Coordinate> hole = { { 3, 3 }, { 3, 7 }, { 7, 7 }, { 7, 3 }, { 3, 3 } };
+    const std::vector<Coordinate> island = { { 4, 4 }, { 6, 4 }, { 6, 6 }, { 4, 6 }, { 4, 4 } };
+    const std::vector<Coordinate> beside = { { 20, 0 }, { 30, 0 }, { 30, 10 }, { 20, 10 }, { 20, 0 } };
+
+    std::vector<GeometryCollection> polygons;
+    ASSERT_TRUE(util::classifyRings({ outer, hole, beside }, polygons));
+    ASSERT_EQ(2u, polygons.size());
+    EXPECT_EQ(2u, polygons[0].size());
+    EXPECT_EQ(4u, polygons[0][1].size());
+    EXPECT_EQ(1u, polygons[1].size());
+
+    // An island within a hole is a polygon of its own.
+    ASSERT_TRUE(util::classifyRings({ outer, hole, island }, polygons));
+    EXPECT_EQ(2u, polygons.size());
+
+    // A hole that is wound like its outer ring would be filled as a polygon of its own, so the
+    // winding order can't be trusted, in either order of the rings.
+    std::vector<Coordinate> sameWindingHole = hole;
+    std::reverse(sameWindingHole.begin(), sameWindingHole.end());
+    EXPECT_FALSE(util::classifyRings({ outer, sameWindingHole }, polygons));
+    EXPECT_FALSE(util::classifyRings({ sameWindingHole, outer }, polygons));
+}
+
+TEST(Earcut, FixturePolygons) {
+    VectorTile tile(std::make_shared<std::string>(util::read_file("test/fixtures/resources/vector.pbf")));
+
+    std::size_t count = 0;
+    for (const auto name : { "landuse", "water", "building", "landuse_overlay", "aeroway" }) {
+        auto layer = tile.getLayer(name);
+        if (!layer) {
+            continue;
+        }
+
+        layer->eachFeature([&](const GeometryTileFeature& feature) {
+            if (feature.getType() != FeatureType::Polygon) {
+                return true;
+            }
+            for (const auto& polygon : classifyRings(getGeometries(feature))) {
+                EXPECT_LT(util::earcutDeviation(polygon, triangulate(polygon)), 1e-9);
+                count++;
+            }
+            return true;
+        });
+    }
+
+    EXPECT_GT(count, 0u);
+}
+
+// Compares ear clipping against the general Clipper and libtess2 path that FillBucket falls back
+// to, by triangles per second and by the area they cover. Run with
+// --gtest_also_run_disabled_tests.
+TEST(Earcut, DISABLED_Benchmark) {
+    VectorTile tile(std::make_shared<std::string>(util::read_file("test/fixtures/resources/vector.pbf")));
+
+    std::vector<GeometryCollection> features;
+    for (const auto name : { "landuse", "water", "building", "landuse_overlay", "aeroway" }) {
+        if (auto layer = tile.getLayer(name)) {
+            layer->eachFeature([&](const GeometryTileFeature& feature) {
+                if (feature.getType() == FeatureType::Polygon) {
+                    features.push_back(getGeometries(feature));
+                }
+                return true;
+            });
+        }
+    }
+
+    const std::size_t iterations = 50;
+    using Clock = std::chrono::steady_clock;
+
+    std::size_t earcutTriangles = 0;
+    double earcutArea = 0;
+    auto start = Clock::now();
+    for (std::size_t n = 0; n < iterations; n++) {
+        std::vector<uint32_t> indices;
+        for (const auto& feature : features) {
+            for (const auto& polygon : classifyRings(feature)) {
+                indices.clear();
+                util::earcut(polygon, indices);
+                earcutTriangles += indices.size() / 3;
+
+                if (n == 0) {
+                    std::vector<Coordinate> points;
+                    for (const auto& ring : polygon) {
+                        points.insert(points.end(), ring.begin(), ring.end());
+                    }
+                    for (std::size_t i = 0; i < indices.size(); i += 3) {
+                        const auto& a = points[indices[i]];
+                        const auto& b = points[indices[i + 1]];
+                        const auto& c = points[indices[i + 2]];
+                        earcutArea += std::abs(double(a.x - c.x) * (b.y - a.y) - double(a.x - b.x) * (c.y - a.y));
+                    }
+                }
+            }
+        }
+    }
+    const auto earcutTime = Clock::now() - start;
+
+    std::size_t tessTriangles = 0;
+    double tessArea = 0;
+    TESStesselator* tesselator = tessNewTess(nullptr);
+    ClipperLib::Clipper clipper;
+    start = Clock::now();
+    for (std::size_t n = 0; n < iterations; n++) {
+        for (const auto& feature : features) {
+            for (const auto& ring : feature) {
+                std::vector<ClipperLib::IntPoint> path;
+                for (const auto& point : ring) {
+                    path.emplace_back(point.x, point.y);
+                }
+                clipper.AddPath(path, ClipperLib::ptSubject, true);
+            }
+
+            std::vector<std::vector<ClipperLib::IntPoint>> polygons;
+            clipper.Execute(ClipperLib::ctUnion, polygons, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd);
+            clipper.Clear();
+
+            for (const auto& polygon : polygons) {
+                std::vector<TESSreal> contour;
+                for (const auto& point : polygon) {
+                    contour.push_back(point.X);
+                    contour.push_back(point.Y);
+                }
+                tessAddContour(tesselator, 2, contour.data(), sizeof(TESSreal) * 2, contour.size() / 2);
+            }
+
+            if (tessTesselate(tesselator, TESS_WINDING_ODD, TESS_POLYGONS, 3, 2, 0)) {
+                const int count = tessGetElementCount(tesselator);
+                tessTriangles += count;
+
+                if (n == 0) {
+                    const TESSreal* vertices = tessGetVertices(tesselator);
+                    const TESSindex* elements = tessGetElements(tesselator);
+                    for (int i = 0; i < count; i++) {
+                        const TESSreal* a = &vertices[elements[i * 3] * 2];
+                        const TESSreal* b = &vertices[elements[i * 3 + 1] * 2];
+                        const TESSreal* c = &vertices[elements[i * 3 + 2] * 2];
+                        tessArea += std::abs(double(a[0] - c[0]) * (b[1] - a[1]) - double(a[0] - b[0]) * (c[1] - a[1]));
+                    }
+                }
+            }
+        }
+    }
+    const auto tessTime = Clock::now() - start;
+    tessDeleteTess(tesselator);
+
+    // Both cover the same area, up to libtess2 rounding its vertices to floats.
+    EXPECT_NEAR(1, earcutArea / tessArea, 1e-3);
+
+    using std::chrono::duration;
+    std::cout << features.size() << " features" << std::endl
+              << "earcut: " << earcutTriangles / iterations << " triangles, "
+              << earcutTriangles / duration<double>(earcutTime).count() / 1e6 << "M triangles/s" << std::endl
+              << "clipper + libtess2: " << tessTriangles / iterations << " triangles, "
+              << tessTriangles / duration<double>(tessTime).count() / 1e6 << "M triangles/s" << std::endl;
+}
@@ -0,0 +1,74 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/util/grid_index.hpp>
+
+#include <algorithm>
+
+using namespace mbgl;
+
+namespace {
+
+using Grid = util::GridIndex<int>;
+
+std::vector<int> query(const Grid& grid, const Grid::BBox& box) {
+    std::vector<int> result;
+    grid.query(box, [&] (int value) {
+        result.push_back(value);
+        return true;
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+TEST(GridIndex, Query) {
+    Grid grid(10);
+    grid.reset(0, 0, 100, 100);
+
+    grid.insert(1, { 5, 5, 8, 8 });
+    grid.insert(2, { 5, 5, 55, 55 });   // Spans many cells.
+    grid.insert(3, { 40, 40, 45, 45 });
+    grid.insert(4, { -50, -50, -40, -40 }); // Outside of the grid.
+    grid.insert(5, { 90, 90, 500, 500 });
+    EXPECT_EQ(5u, grid.size());
+
+    EXPECT_EQ((std::vector<int> { 1, 2 }), query(grid, { 0, 0, 10, 10 }));
+    EXPECT_EQ((std::vector<int> { 2, 3 }), query(grid, { 30, 30, 50, 50 }));
+    EXPECT_EQ((std::vector<int> { 1, 2, 3 }), query(grid, { 0, 0, 45, 45 }));
+    EXPECT_EQ((std::vector<int> { 4 }), query(grid, { -45, -45, -45, -45 }));
+    EXPECT_EQ((std::vector<int> { 5 }), query(grid, { 200, 200, 300, 300 }));
+
+    // Boxes that only touch intersect.
+    EXPECT_EQ((std::vector<int> { 1, 2 }), query(grid, { 8, 0, 9, 5 }));
+
+    // Boxes near each other that don't intersect aren't found.
+    EXPECT_EQ(std::vector<int>(), query(grid, { 9, 0, 10, 4 }));
+}
+
+TEST(GridIndex, StopsQuery) {
+    Grid grid(10);
+    grid.reset(0, 0, 100, 100);
+    for (int i = 0; i < 10; i++) {
+        grid.insert(i, { 0, 0, 100, 100 });
+    }
+
+    int count = 0;
+    grid.query({ 50, 50, 60, 60 }, [&] (int) {
+        return ++count < 3;
+    });
+    EXPECT_EQ(3, count);
+}
+
+TEST(GridIndex, Reset) {
+    Grid grid(10);
+    grid.reset(0, 0, 100, 100);
+    grid.insert(1, { 5, 5, 8, 8 });
+
+    grid.reset(-100, -100, 0, 0);
+    EXPECT_EQ(0u, grid.size());
+    EXPECT_EQ(std::vector<int>(), query(grid, { 5, 5, 8, 8 }));
+
+    grid.insert(2, { -20, -20, -10, -10 });
+    EXPECT_EQ((std::vector<int> { 2 }), query(grid, { -15, -15, 15, 15 }));
+}
@@ -35,6 +35,15 @@ TEST(Mapbox, SpriteURL) {
     EXPECT_EQ(mbgl::util::mapbox::normalizeSpriteURL("mapbox://sprites/mapbox/streets-v8/draft@2x.png", "key"), "https://api.mapbox.com/styles/v1/mapbox/streets-v8/draft/sprite@2x.png?access_token=key");
 }
 
+TEST(Mapbox, ResourceURL) {
+    EXPECT_EQ(mbgl::util::mapbox::normalizeURL(Resource::Kind::Style, "mapbox://styles/user/style", "key"), "https://api.mapbox.com/styles/v1/user/style?access_token=key");
+    EXPECT_EQ(mbgl::util::mapbox::normalizeURL(Resource::Kind::Source, "mapbox://user.map", "key"), "https://api.mapbox.com/v4/user.map.json?access_token=key&secure");
+    EXPECT_EQ(mbgl::util::mapbox::normalizeURL(Resource::Kind::Glyphs, "mapbox://fonts/boxmap/Comic%20Sans/0-255.pbf", "key"), "https://api.mapbox.com/fonts/v1/boxmap/Comic%20Sans/0-255.pbf?access_token=key");
+    EXPECT_EQ(mbgl::util::mapbox::normalizeURL(Resource::Kind::SpriteImage, "mapbox://sprites/mapbox/streets-v8@2x.png", "key"), "https://api.mapbox.com/styles/v1/mapbox/streets-v8/sprite@2x.png?access_token=key");
+    EXPECT_EQ(mbgl::util::mapbox::normalizeURL(Resource::Kind::SpriteJSON, "mapbox://sprites/mapbox/streets-v8.json", "key"), "https://api.mapbox.com/styles/v1/mapbox/streets-v8/sprite.json?access_token=key");
+    EXPECT_EQ(mbgl::util::mapbox::normalizeURL(Resource::Kind::Tile, "mapbox://path", "key"), "mapbox://path");
+}
+
 TEST(Mapbox, TileURL) {
     try {
 #if defined(__ANDROID__) || defined(__APPLE__)
@@ -0,0 +1,238 @@
+#include <mbgl/util/thread_pool.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include "../fixtures/util.hpp"
+
+#include <future>
+
+using namespace mbgl::util;
+
+namespace {
+
+void send(std::function<void ()> fn, std::function<void ()> cb) {
+    fn();
+    cb();
+}
+
+const ThreadContext context = { "Test", ThreadType::Worker, ThreadPriority::Regular };
+
+} // namespace
+
+TEST(ThreadPool, ExecutesAfter) {
+    RunLoop loop;
+    ThreadPool pool(context, 2);
+
+    bool didWork = false;
+    bool didAfter = false;
+
+    auto request = pool.invokeWithCallback(0, &send, [&] {
+        didAfter = true;
+        loop.stop();
+    }, [&] {
+        didWork = true;
+    });
+
+    loop.run();
+
+    EXPECT_TRUE(didWork);
+    EXPECT_TRUE(didAfter);
+}
+
+TEST(ThreadPool, RunsByPriority) {
+    RunLoop loop;
+    ThreadPool pool(context, 1);
+
+    std::promise<void> started;
+    std::promise<void> blocked;
+    auto unblock = blocked.get_future();
+    auto request = pool.invokeWithCallback(0, &send, [] {}, [&] {
+        started.set_value();
+        unblock.wait();
+    });
+    started.get_future().get();
+
+    // The only thread is busy, so all of these are queued when it picks the next one.
+    std::mutex mutex;
+    std::vector<int> order;
+    std::promise<void> done;
+    std::vector<std::unique_ptr<mbgl::WorkRequest>> requests;
+    for (int priority : { 3, 1, 4, 2, 1 }) {
+        requests.push_back(pool.invokeWithCallback(priority, &send, [] {}, [&, priority] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(priority);
+            if (order.size() == 5) {
+                done.set_value();
+            }
+        }));
+    }
+
+    blocked.set_value();
+    done.get_future().get();
+
+    EXPECT_EQ((std::vector<int> { 1, 1, 2, 3, 4 }), order);
+}
+
+TEST(ThreadPool, WorkRequestDeletionCancelsQueuedWork) {
+    RunLoop loop;
+    ThreadPool pool(context, 1);
+
+    std::promise<void> started;
+    std::promise<void> blocked;
+    auto unblock = blocked.get_future();
+    auto request1 = pool.invokeWithCallback(0, &send, [] {}, [&] {
+        started.set_value();
+        unblock.wait();
+    });
+    started.get_future().get();
+
+    auto request2 = pool.invokeWithCallback(0, &send, [] {}, [&] {
+        ADD_FAILURE() << "Canceled work item should not be invoked";
+    });
+    request2.reset();
+
+    std::promise<void> finished;
+    auto request3 = pool.invokeWithCallback(1, &send, [] {}, [&] {
+        finished.set_value();
+    });
+
+    blocked.set_value();
+    finished.get_future().get();
+}
+
+TEST(ThreadPool, IdleThreadsTakeQueuedWork) {
+    RunLoop loop;
+    ThreadPool pool(context, 2);
+    ASSERT_EQ(2u, pool.size());
+
+    std::promise<void> started;
+    std::promise<void> blocked;
+    auto unblock = blocked.get_future();
+    auto request = pool.invokeWithCallback(0, &send, [] {}, [&] {
+        started.set_value();
+        unblock.wait();
+    });
+    started.get_future().get();
+
+    // One thread is blocked, so the other one has to run all of these.
+    std::atomic<int> count { 0 };
+    std::promise<void> done;
+    std::vector<std::unique_ptr<mbgl::WorkRequest>> requests;
+    for (int i = 0; i < 8; i++) {
+        requests.push_back(pool.invokeWithCallback(0, &send, [] {}, [&] {
+            if (++count == 8) {
+                done.set_value();
+            }
+        }));
+    }
+
+    done.get_future().get();
+    EXPECT_EQ(8, count);
+
+    blocked.set_value();
+}
+
+TEST(ThreadPool, RunsByPriorityAcrossThreads) {
+    RunLoop loop;
+    ThreadPool pool(context, 2);
+
+    // Block both threads.
+    std::promise<void> started1;
+    std::promise<void> started2;
+    std::promise<void> blocked1;
+    std::promise<void> blocked2;
+    auto unblock1 = blocked1.get_future();
+    auto unblock2 = blocked2.get_future();
+    auto request1 = pool.invokeWithCallback(0, &send, [] {}, [&] {
+        started1.set_value();
+        unblock1.wait();
+    });
+    auto request2 = pool.invokeWithCallback(0, &send, [] {}, [&] {
+        started2.set_value();
+        unblock2.wait();
+    });
+    started1.get_future().get();
+    started2.get_future().get();
+
+    // Only one thread is unblocked, and it has to pick the jobs in order, no matter which thread
+    // they were queued for.
+    std::mutex mutex;
+    std::vector<int> order;
+    std::promise<void> done;
+    std::vector<std::unique_ptr<mbgl::WorkRequest>> requests;
+    for (int priority : { 3, 1, 4, 2, 5, 0 }) {
+        requests.push_back(pool.invokeWithCallback(priority, &send, [] {}, [&, priority] {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(priority);
+            if (order.size() == 6) {
+                done.set_value();
+            }
+        }));
+    }
+
+    blocked1.set_value();
+    done.get_future().get();
+
+    EXPECT_EQ((std::vector<int> { 0, 1, 2, 3, 4, 5 }), order);
+
+    blocked2.set_value();
+}
+
+TEST(ThreadPool, ParallelOutsideOfPool) {
+    std::vector<std::size_t> calls;
+    ThreadPool::parallel(4, [&] (std::size_t i) {
+        calls.push_back(i);
+    });
+
+    EXPECT_EQ((std::vector<std::size_t> { 0, 1, 2, 3 }), calls);
+}
+
+TEST(ThreadPool, Parallel) {
+    RunLoop loop;
+    ThreadPool pool(context, 4);
+
+    // Every job fans out while the others do the same, so that jobs wait on each other.
+    std::atomic<int> count { 0 };
+    std::vector<std::unique_ptr<mbgl::WorkRequest>> requests;
+    for (int i = 0; i < 8; i++) {
+        requests.push_back(pool.invokeWithCallback(0, &send, [&] {
+            if (++count == 8) {
+                loop.stop();
+            }
+        }, [&] {
+            std::vector<std::atomic<int>> calls(32);
+            ThreadPool::parallel(calls.size(), [&] (std::size_t j) {
+                ThreadPool::parallel(2, [&] (std::size_t) {
+                    calls[j]++;
+                });
+            });
+            for (const auto& call : calls) {
+                EXPECT_EQ(2, call);
+            }
+        }));
+    }
+
+    loop.run();
+}
+
+TEST(ThreadPool, ParallelRethrows) {
+    RunLoop loop;
+    ThreadPool pool(context, 2);
+
+    bool threw = false;
+    auto request = pool.invokeWithCallback(0, &send, [&] {
+        loop.stop();
+    }, [&] {
+        try {
+            ThreadPool::parallel(16, [&] (std::size_t i) {
+                if (i == 5) {
+                    throw std::runtime_error("failed");
+                }
+            });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+    });
+
+    loop.run();
+    EXPECT_TRUE(threw);
+}
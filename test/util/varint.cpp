@@ -0,0 +1,271 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/pbf.hpp>
+#include <mbgl/util/varint.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace mbgl;
+
+namespace {
+
+std::string encode(const std::vector<uint64_t>& values) {
+    std::string result;
+    for (auto value : values) {
+        while (value >= 0x80) {
+            result += char((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        result += char(value);
+    }
+    return result;
+}
+
+std::vector<uint32_t> decode(const std::string& data, std::size_t count, bool scalar = false) {
+    std::vector<uint32_t> values(count);
+    auto begin = reinterpret_cast<const uint8_t*>(data.data());
+    const auto end = begin + data.size();
+    values.resize(scalar ? util::decodeVarintsScalar(begin, end, values.data(), count)
+                         : util::decodeVarints(begin, end, values.data(), count));
+    return values;
+}
+
+// The geometry fields of all features in a vector tile.
+std::vector<std::string> geometries(const std::string& tile) {
+    std::vector<std::string> result;
+    pbf tile_pbf(reinterpret_cast<const unsigned char*>(tile.data()), tile.size());
+    while (tile_pbf.next(3)) {
+        pbf layer_pbf = tile_pbf.message();
+        while (layer_pbf.next()) {
+            if (layer_pbf.tag != 2) {
+                layer_pbf.skip();
+                continue;
+            }
+            pbf feature_pbf = layer_pbf.message();
+            while (feature_pbf.next(4)) {
+                pbf geometry_pbf = feature_pbf.message();
+                result.emplace_back(reinterpret_cast<const char*>(geometry_pbf.data),
+                                    geometry_pbf.end - geometry_pbf.data);
+            }
+        }
+    }
+    return result;
+}
+
+// The names of the layers in a vector tile.
+std::vector<std::string> layerNames(const std::string& tile) {
+    std::vector<std::string> result;
+    pbf tile_pbf(reinterpret_cast<const unsigned char*>(tile.data()), tile.size());
+    while (tile_pbf.next(3)) {
+        pbf layer_pbf = tile_pbf.message();
+        if (layer_pbf.next(1)) {
+            result.push_back(layer_pbf.string());
+        }
+    }
+    return result;
+}
+
+// Decodes a geometry one varint at a time, like vector tiles did before batched decoding.
+void readGeometries(const std::string& field, GeometryCollection& lines) {
+    pbf data(reinterpret_cast<const unsigned char*>(field.data()), field.size());
+    uint8_t cmd = 1;
+    uint32_t length = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+
+    // Reuse the rings, like VectorTileFeature does.
+    std::size_t count = 0;
+    auto nextLine = [&] {
+        if (count == lines.size()) {
+            lines.emplace_back();
+        }
+        lines[count].clear();
+        return &lines[count++];
+    };
+    std::vector<Coordinate>* line = nextLine();
+
+    while (data.data < data.end) {
+        if (length == 0) {
+            uint32_t cmd_length = data.varint();
+            cmd = cmd_length & 0x7;
+            length = cmd_length >> 3;
+        }
+
+        --length;
+
+        if (cmd == 1 || cmd == 2) {
+            x += data.svarint();
+            y += data.svarint();
+
+            if (cmd == 1 && !line->empty()) {
+                line = nextLine();
+            }
+
+            line->emplace_back(x, y);
+
+        } else if (cmd == 7) {
+            if (!line->empty()) {
+                line->push_back((*line)[0]);
+            }
+        }
+    }
+
+    lines.resize(count);
+}
+
+} // namespace
+
+TEST(Varint, Decode) {
+    // Runs of single byte varints, mixed with longer ones, so that every path is taken.
+    std::mt19937 generator(42);
+    std::vector<uint64_t> values;
+    for (int run = 0; run < 100; run++) {
+        const int length = generator() % 48;
+        const int bits = 1 + generator() % 32;
+        for (int i = 0; i < length; i++) {
+            values.push_back(i % 7 ? generator() % 0x80 : generator() & ((uint64_t(1) << bits) - 1));
+        }
+    }
+    values.push_back(0xFFFFFFFF);
+
+    const std::string data = encode(values);
+    const std::vector<uint32_t> expected(values.begin(), values.end());
+    EXPECT_EQ(expected, decode(data, values.size() + 10));
+    EXPECT_EQ(expected, decode(data, values.size(), true));
+
+    // Decoding stops after `count` values.
+    EXPECT_EQ(std::vector<uint32_t>(expected.begin(), expected.begin() + 33), decode(data, 33));
+    EXPECT_EQ(std::vector<uint32_t>(), decode(data, 0));
+}
+
+TEST(Varint, Truncates) {
+    // Negative 64 bit values take ten bytes; only their lower 32 bits are kept.
+    const std::vector<uint64_t> values(20, uint64_t(-2));
+    EXPECT_EQ(std::vector<uint32_t>(20, 0xFFFFFFFE), decode(encode(values), 20));
+}
+
+TEST(Varint, Malformed) {
+    std::string unterminated = encode(std::vector<uint64_t>(20, 1)) + "\x80\x80";
+    EXPECT_THROW(decode(unterminated, 100), pbf::unterminated_varint_exception);
+
+    std::string tooLong = encode(std::vector<uint64_t>(20, 1)) + std::string(11, '\x80') + '\x01';
+    tooLong += std::string(20, '\x01');
+    EXPECT_THROW(decode(tooLong, 100), pbf::varint_too_long_exception);
+    EXPECT_THROW(decode(tooLong, 100, true), pbf::varint_too_long_exception);
+}
+
+TEST(Varint, Geometries) {
+    for (const auto& geometry : geometries(util::read_file("test/fixtures/resources/vector.pbf"))) {
+        pbf data(reinterpret_cast<const unsigned char*>(geometry.data()), geometry.size());
+        std::vector<uint32_t> expected;
+        while (data) {
+            expected.push_back(data.varint());
+        }
+        EXPECT_EQ(expected, decode(geometry, geometry.size()));
+    }
+}
+
+// Compares decoding the geometries of a real tile with pbf::varint() to batched decoding. Run
+// with --gtest_also_run_disabled_tests.
+TEST(Varint, DISABLED_Benchmark) {
+    const auto fields = geometries(util::read_file("test/fixtures/resources/vector.pbf"));
+    const std::size_t iterations = 2000;
+    using Clock = std::chrono::steady_clock;
+
+    std::size_t count = 0;
+    uint32_t checksum = 0;
+    auto start = Clock::now();
+    for (std::size_t n = 0; n < iterations; n++) {
+        for (const auto& field : fields) {
+            pbf data(reinterpret_cast<const unsigned char*>(field.data()), field.size());
+            while (data) {
+                checksum += data.varint();
+                count++;
+            }
+        }
+    }
+    const auto pbfTime = Clock::now() - start;
+
+    auto batched = [&] (bool scalar) {
+        uint32_t sum = 0;
+        uint32_t values[128];
+        for (std::size_t n = 0; n < iterations; n++) {
+            for (const auto& field : fields) {
+                auto data = reinterpret_cast<const uint8_t*>(field.data());
+                const auto end = data + field.size();
+                while (data < end) {
+                    const std::size_t decoded = scalar ? util::decodeVarintsScalar(data, end, values, 128)
+                                                       : util::decodeVarints(data, end, values, 128);
+                    for (std::size_t i = 0; i < decoded; i++) {
+                        sum += values[i];
+                    }
+                }
+            }
+        }
+        return sum;
+    };
+
+    start = Clock::now();
+    EXPECT_EQ(checksum, batched(true));
+    const auto scalarTime = Clock::now() - start;
+
+    start = Clock::now();
+    EXPECT_EQ(checksum, batched(false));
+    const auto simdTime = Clock::now() - start;
+
+    // Every vertex takes two varints.
+    auto rate = [&] (Clock::duration time) {
+        return count / 2 / std::chrono::duration<double>(time).count() / 1e6;
+    };
+    std::cout << count / iterations << " varints in " << fields.size() << " geometries" << std::endl
+              << "pbf::varint: " << rate(pbfTime) << "M vertices/s" << std::endl
+              << "decodeVarintsScalar: " << rate(scalarTime) << "M vertices/s" << std::endl
+              << "decodeVarints: " << rate(simdTime) << "M vertices/s" << std::endl;
+
+    // Decoding whole geometries, with the command interpreter and the coordinate vectors.
+    const std::string data = util::read_file("test/fixtures/resources/vector.pbf");
+    VectorTile tile(std::make_shared<std::string>(data));
+    std::vector<util::ptr<const GeometryTileFeature>> features;
+    for (const auto& name : layerNames(data)) {
+        auto layer = tile.getLayer(name);
+        for (std::size_t i = 0; i < layer->featureCount(); i++) {
+            features.push_back(layer->getFeature(i));
+        }
+    }
+
+    GeometryCollection lines;
+    std::size_t vertices = 0;
+    start = Clock::now();
+    for (std::size_t n = 0; n < iterations; n++) {
+        for (const auto& field : fields) {
+            readGeometries(field, lines);
+            for (const auto& line : lines) {
+                vertices += line.size();
+            }
+        }
+    }
+    const auto oldTime = Clock::now() - start;
+
+    std::size_t batchedVertices = 0;
+    start = Clock::now();
+    for (std::size_t n = 0; n < iterations; n++) {
+        for (const auto& feature : features) {
+            feature->readGeometries(lines);
+            for (const auto& line : lines) {
+                batchedVertices += line.size();
+            }
+        }
+    }
+    const auto newTime = Clock::now() - start;
+    EXPECT_EQ(vertices, batchedVertices);
+
+    auto geometryRate = [&] (Clock::duration time) {
+        return vertices / std::chrono::duration<double>(time).count() / 1e6;
+    };
+    std::cout << "geometries with pbf::varint: " << geometryRate(oldTime) << "M vertices/s" << std::endl
+              << "geometries with decodeVarints: " << geometryRate(newTime) << "M vertices/s" << std::endl;
+}